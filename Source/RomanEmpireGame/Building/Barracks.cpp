@@ -2,12 +2,12 @@
 
 #include "Barracks.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Building/ProductionService.h"
 #include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
 
 ABarracks::ABarracks()
 {
-	PrimaryActorTick.bCanEverTick = true;
-
 	// Setup barracks data
 	BuildingData.BuildingType = EBuildingType::Barracks;
 	BuildingData.Category = EBuildingCategory::Military;
@@ -26,116 +26,67 @@ ABarracks::ABarracks()
 	BuildingData.TrainableUnits.Add(TEXT("Velites"));
 	BuildingData.TrainableUnits.Add(TEXT("Triarii"));
 
-	// Initialize training
-	bIsTraining = false;
-	TrainingProgress = 0.0f;
-	TrainingTime = 10.0f;
-	CurrentlyTraining = nullptr;
+	// Training itself runs in AProductionService
 	SpawnOffset = FVector(300.0f, 0.0f, 0.0f);
 	MaxQueueSize = 5;
 }
 
-void ABarracks::Tick(float DeltaSeconds)
+void ABarracks::TrainUnit(TSubclassOf<AUnitBase> UnitClass)
 {
-	Super::Tick(DeltaSeconds);
+	TrainUnits(UnitClass, 1);
+}
 
-	if (!IsComplete() || !bIsTraining)
+bool ABarracks::TrainUnits(TSubclassOf<AUnitBase> UnitClass, int32 Count)
+{
+	AProductionService* Production = AProductionService::GetProductionService(this);
+	if (!Production)
 	{
-		return;
+		return false;
 	}
 
-	// Progress training
-	TrainingProgress += DeltaSeconds / TrainingTime;
-
-	if (TrainingProgress >= 1.0f)
-	{
-		SpawnTrainedUnit();
-		TrainingProgress = 0.0f;
-		bIsTraining = false;
-		CurrentlyTraining = nullptr;
-
-		// Start next in queue
-		StartNextInQueue();
-	}
+	const FTransform SpawnTransform(GetActorRotation(), GetActorLocation() + GetActorRotation().RotateVector(SpawnOffset));
+	return Production->EnqueueTraining(this, UnitClass, Count, SpawnTransform, MaxQueueSize);
 }
 
-void ABarracks::TrainUnit(TSubclassOf<AUnitBase> UnitClass)
+float ABarracks::GetTrainingProgress() const
 {
-	if (!UnitClass || !IsComplete())
-	{
-		return;
-	}
-
-	if (TrainingQueue.Num() >= MaxQueueSize)
-	{
-		UE_LOG(LogRomanEmpire, Warning, TEXT("Training queue is full"));
-		return;
-	}
+	AProductionService* Production = FindProductionService();
+	return Production ? Production->GetTrainingProgress(this) : 0.0f;
+}
 
-	// TODO: Check resource cost
+bool ABarracks::IsTraining() const
+{
+	AProductionService* Production = FindProductionService();
+	return Production && Production->IsTraining(this);
+}
 
-	if (!bIsTraining)
-	{
-		// Start training immediately
-		CurrentlyTraining = UnitClass;
-		bIsTraining = true;
-		TrainingProgress = 0.0f;
-		
-		UE_LOG(LogRomanEmpire, Log, TEXT("Started training: %s"), *UnitClass->GetName());
-	}
-	else
-	{
-		// Add to queue
-		TrainingQueue.Add(UnitClass);
-		UE_LOG(LogRomanEmpire, Log, TEXT("Added to queue: %s (Queue size: %d)"), 
-			*UnitClass->GetName(), TrainingQueue.Num());
-	}
+int32 ABarracks::GetQueuedOrderCount() const
+{
+	AProductionService* Production = FindProductionService();
+	return Production ? Production->GetQueuedOrderCount(this) : 0;
 }
 
 void ABarracks::CancelTraining()
 {
-	if (bIsTraining)
+	if (AProductionService* Production = FindProductionService())
 	{
-		bIsTraining = false;
-		TrainingProgress = 0.0f;
-		CurrentlyTraining = nullptr;
-		
-		// TODO: Refund partial resources
-		
-		StartNextInQueue();
+		Production->CancelCurrentOrder(this);
 	}
 }
 
-void ABarracks::SpawnTrainedUnit()
+void ABarracks::OnDestroyed()
 {
-	UWorld* World = GetWorld();
-	if (!World || !CurrentlyTraining)
+	// Orders that never finished are refunded
+	if (AProductionService* Production = FindProductionService())
 	{
-		return;
+		Production->ClearQueue(this);
 	}
 
-	FVector SpawnLocation = GetActorLocation() + GetActorRotation().RotateVector(SpawnOffset);
-	FRotator SpawnRotation = GetActorRotation();
-
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-
-	AUnitBase* NewUnit = World->SpawnActor<AUnitBase>(CurrentlyTraining, SpawnLocation, SpawnRotation, SpawnParams);
-	
-	if (NewUnit)
-	{
-		NewUnit->SetOwnerFaction(OwnerFaction);
-		UE_LOG(LogRomanEmpire, Log, TEXT("Trained unit: %s"), *NewUnit->GetName());
-	}
+	Super::OnDestroyed();
 }
 
-void ABarracks::StartNextInQueue()
+AProductionService* ABarracks::FindProductionService() const
 {
-	if (TrainingQueue.Num() > 0)
-	{
-		CurrentlyTraining = TrainingQueue[0];
-		TrainingQueue.RemoveAt(0);
-		bIsTraining = true;
-		TrainingProgress = 0.0f;
-	}
+	// Queries never spawn the service; only queuing an order does
+	return URomanEmpireWorldSubsystem::FindManager<AProductionService>(this);
 }
@@ -21,40 +21,31 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Barracks")
 	void TrainUnit(TSubclassOf<class AUnitBase> UnitClass);
 
+	// Queues a batch order, e.g. twenty legionaries, as one queue slot
+	UFUNCTION(BlueprintCallable, Category = "Barracks")
+	bool TrainUnits(TSubclassOf<class AUnitBase> UnitClass, int32 Count);
+
 	UFUNCTION(BlueprintPure, Category = "Barracks")
-	float GetTrainingProgress() const { return TrainingProgress; }
+	float GetTrainingProgress() const;
 
 	UFUNCTION(BlueprintPure, Category = "Barracks")
-	bool IsTraining() const { return bIsTraining; }
+	bool IsTraining() const;
+
+	UFUNCTION(BlueprintPure, Category = "Barracks")
+	int32 GetQueuedOrderCount() const;
 
 	UFUNCTION(BlueprintCallable, Category = "Barracks")
 	void CancelTraining();
 
-	virtual void Tick(float DeltaSeconds) override;
-
 protected:
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Barracks")
-	bool bIsTraining;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Barracks")
-	float TrainingProgress;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Barracks")
-	float TrainingTime;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Barracks")
-	TSubclassOf<AUnitBase> CurrentlyTraining;
-
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Barracks")
 	FVector SpawnOffset;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Barracks")
 	int32 MaxQueueSize;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Barracks")
-	TArray<TSubclassOf<AUnitBase>> TrainingQueue;
+	virtual void OnDestroyed() override;
 
 private:
-	void SpawnTrainedUnit();
-	void StartNextInQueue();
+	class AProductionService* FindProductionService() const;
 };
@@ -2,12 +2,17 @@
 
 #include "BuildingBase.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/World/TerritoryRegion.h"
+#include "RomanEmpireGame/Building/ConstructionScheduler.h"
+#include "RomanEmpireGame/Building/BuildingRenderManager.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
 #include "Components/BoxComponent.h"
 #include "Components/StaticMeshComponent.h"
 
 ABuildingBase::ABuildingBase()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// Construction is driven by AConstructionScheduler, so plain buildings never tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Create root
 	RootScene = CreateDefaultSubobject<USceneComponent>(TEXT("RootScene"));
@@ -33,8 +38,11 @@ ABuildingBase::ABuildingBase()
 	CurrentState = EBuildingState::Placing;
 	OwnerFaction = EFactionID::None;
 	ConstructionProgress = 0.0f;
+	ConstructionStartTime = 0.0;
+	ConstructionEndTime = 0.0;
 	CurrentHealth = 1000;
 	bIsSelected = false;
+	OwningTerritory = nullptr;
 
 	// Default materials will be set in Blueprint
 	ValidPlacementMaterial = nullptr;
@@ -51,14 +59,17 @@ void ABuildingBase::BeginPlay()
 	UpdateVisuals();
 }
 
-void ABuildingBase::Tick(float DeltaSeconds)
+void ABuildingBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaSeconds);
-
-	if (CurrentState == EBuildingState::Constructing)
+	if (ABuildingRenderManager* RenderManager = InstancingManager.Get())
 	{
-		UpdateConstruction(DeltaSeconds);
+		RenderManager->RemoveInstance(this);
 	}
+	InstancingManager.Reset();
+
+	UnregisterAsObstacle();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ABuildingBase::OnConstruction(const FTransform& Transform)
@@ -97,36 +108,77 @@ void ABuildingBase::StartConstruction()
 		}
 		
 		UpdateVisuals();
+
+		// Start below ground; the scheduler raises it while the site is on screen
+		if (BuildingMesh)
+		{
+			BuildingMesh->SetRelativeLocation(FVector(0.0f, 0.0f, -200.0f));
+		}
+
+		// Units steer around the site from the moment work begins
+		RegisterAsObstacle();
+
+		ConstructionStartTime = GetWorld()->GetTimeSeconds();
+		ConstructionEndTime = ConstructionStartTime + FMath::Max(0.0f, BuildingData.ConstructionTime);
+
+		AConstructionScheduler* Scheduler = AConstructionScheduler::GetConstructionScheduler(this);
+		if (Scheduler && BuildingData.ConstructionTime > 0.0f)
+		{
+			Scheduler->ScheduleConstruction(this, ConstructionEndTime);
+		}
+		else
+		{
+			CompleteConstruction();
+			return;
+		}
 		
 		UE_LOG(LogRomanEmpire, Log, TEXT("Started construction of %s"), 
 			*BuildingData.DisplayName.ToString());
 	}
 }
 
-void ABuildingBase::UpdateConstruction(float DeltaSeconds)
+float ABuildingBase::GetConstructionProgress() const
 {
-	if (CurrentState != EBuildingState::Constructing)
+	if (CurrentState != EBuildingState::Constructing || ConstructionEndTime <= ConstructionStartTime)
+	{
+		return ConstructionProgress;
+	}
+
+	// Derived from the schedule so it is exact without ticking
+	const double Now = GetWorld()->GetTimeSeconds();
+	return FMath::Clamp(static_cast<float>((Now - ConstructionStartTime) / (ConstructionEndTime - ConstructionStartTime)), 0.0f, 1.0f);
+}
+
+void ABuildingBase::UpdateConstructionVisual(double WorldTime)
+{
+	if (CurrentState != EBuildingState::Constructing || !BuildingMesh)
 	{
 		return;
 	}
 
-	// Progress construction
-	float ProgressRate = 1.0f / BuildingData.ConstructionTime;
-	ConstructionProgress += ProgressRate * DeltaSeconds;
+	const double Duration = ConstructionEndTime - ConstructionStartTime;
+	ConstructionProgress = Duration > 0.0 ? FMath::Clamp(static_cast<float>((WorldTime - ConstructionStartTime) / Duration), 0.0f, 1.0f) : 1.0f;
 
 	// Visual progress - raise building from ground
-	if (BuildingMesh)
+	const float TargetZ = FMath::Lerp(-200.0f, 0.0f, ConstructionProgress);
+	BuildingMesh->SetRelativeLocation(FVector(0.0f, 0.0f, TargetZ));
+}
+
+void ABuildingBase::CompleteConstruction()
+{
+	if (CurrentState != EBuildingState::Constructing)
 	{
-		FVector BaseLocation = RootScene->GetComponentLocation();
-		float TargetZ = FMath::Lerp(-200.0f, 0.0f, ConstructionProgress);
-		BuildingMesh->SetRelativeLocation(FVector(0.0f, 0.0f, TargetZ));
+		return;
 	}
 
-	if (ConstructionProgress >= 1.0f)
+	ConstructionProgress = 1.0f;
+
+	if (BuildingMesh)
 	{
-		ConstructionProgress = 1.0f;
-		OnConstructionFinished();
+		BuildingMesh->SetRelativeLocation(FVector::ZeroVector);
 	}
+
+	OnConstructionFinished();
 }
 
 void ABuildingBase::OnConstructionFinished()
@@ -139,6 +191,13 @@ void ABuildingBase::OnConstructionFinished()
 	}
 	
 	UpdateVisuals();
+
+	// Completed buildings start contributing production
+	if (OwningTerritory)
+	{
+		OwningTerritory->NotifyProductionChanged();
+	}
+
 	OnConstructionComplete.Broadcast(this);
 	
 	UE_LOG(LogRomanEmpire, Log, TEXT("Construction complete: %s"), 
@@ -188,6 +247,15 @@ void ABuildingBase::Repair(float Amount)
 void ABuildingBase::OnDestroyed()
 {
 	CurrentState = EBuildingState::Destroyed;
+	UpdateRenderMode();
+	UnregisterAsObstacle();
+
+	if (OwningTerritory)
+	{
+		OwningTerritory->ReleaseFootprint(this);
+		OwningTerritory->UnregisterBuilding(this);
+	}
+
 	OnBuildingDestroyed.Broadcast(this);
 	
 	UE_LOG(LogRomanEmpire, Log, TEXT("Building destroyed: %s"), 
@@ -198,6 +266,29 @@ void ABuildingBase::OnDestroyed()
 	SetActorEnableCollision(false);
 }
 
+void ABuildingBase::RegisterAsObstacle()
+{
+	AUnitSimulationManager* Simulation = AUnitSimulationManager::GetUnitSimulationManager(this);
+	if (!Simulation)
+	{
+		return;
+	}
+
+	// Footprints are in metres; a circle across the longer side is close enough for steering
+	const float Radius = 0.5f * FMath::Max(BuildingData.FootprintSize.X, BuildingData.FootprintSize.Y) * 100.0f;
+	Simulation->RegisterObstacle(this, GetActorLocation(), Radius);
+	ObstacleSimulation = Simulation;
+}
+
+void ABuildingBase::UnregisterAsObstacle()
+{
+	if (AUnitSimulationManager* Simulation = ObstacleSimulation.Get())
+	{
+		Simulation->UnregisterObstacle(this);
+	}
+	ObstacleSimulation.Reset();
+}
+
 bool ABuildingBase::CanPlaceAt(const FVector& Location) const
 {
 	// Check for overlapping actors
@@ -218,7 +309,15 @@ bool ABuildingBase::CanPlaceAt(const FVector& Location) const
 
 void ABuildingBase::SetSelected(bool bNewSelected)
 {
+	if (bIsSelected == bNewSelected)
+	{
+		return;
+	}
+
 	bIsSelected = bNewSelected;
+
+	// Selected buildings get their own mesh back so highlights can be applied to it
+	UpdateRenderMode();
 	// TODO: Show selection indicator
 }
 
@@ -275,4 +374,50 @@ void ABuildingBase::UpdateVisuals()
 	{
 		BuildingMesh->SetMaterial(0, MaterialToUse);
 	}
+
+	UpdateRenderMode();
+}
+
+bool ABuildingBase::ShouldRenderInstanced() const
+{
+	return CurrentState == EBuildingState::Complete && !bIsSelected && !IsHidden() &&
+		BuildingMesh && BuildingMesh->GetStaticMesh() && GetWorld() && GetWorld()->IsGameWorld();
+}
+
+void ABuildingBase::UpdateRenderMode()
+{
+	const bool bWantInstanced = ShouldRenderInstanced();
+	if (bWantInstanced == IsRenderInstanced())
+	{
+		return;
+	}
+
+	if (bWantInstanced)
+	{
+		ABuildingRenderManager* RenderManager = ABuildingRenderManager::GetBuildingRenderManager(this);
+		if (!RenderManager || !RenderManager->AddInstance(this, BuildingMesh->GetStaticMesh(), CompleteMaterial, BuildingMesh->GetComponentTransform()))
+		{
+			return;
+		}
+
+		// Collision and traces stay on the collision box; the mesh and scaffolding leave the scene entirely
+		BuildingMesh->UnregisterComponent();
+		if (ConstructionScaffolding && ConstructionScaffolding->IsRegistered())
+		{
+			ConstructionScaffolding->UnregisterComponent();
+		}
+
+		InstancingManager = RenderManager;
+	}
+	else
+	{
+		InstancingManager->RemoveInstance(this);
+		InstancingManager.Reset();
+
+		BuildingMesh->RegisterComponent();
+		if (ConstructionScaffolding && !ConstructionScaffolding->IsRegistered())
+		{
+			ConstructionScaffolding->RegisterComponent();
+		}
+	}
 }
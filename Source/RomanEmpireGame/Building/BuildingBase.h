@@ -10,6 +10,9 @@
 
 class UBoxComponent;
 class UStaticMeshComponent;
+class ATerritoryRegion;
+class ABuildingRenderManager;
+class AUnitSimulationManager;
 
 /**
  * Base class for all placeable buildings in the game
@@ -24,18 +27,29 @@ public:
 	ABuildingBase();
 
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	// Building info
 	UFUNCTION(BlueprintPure, Category = "Building")
 	FBuildingData GetBuildingData() const { return BuildingData; }
 
+	const FBuildingData& GetBuildingDataRef() const { return BuildingData; }
+
 	UFUNCTION(BlueprintPure, Category = "Building")
 	EBuildingType GetBuildingType() const { return BuildingData.BuildingType; }
 
 	UFUNCTION(BlueprintPure, Category = "Building")
 	EBuildingState GetBuildingState() const { return CurrentState; }
 
+	UStaticMeshComponent* GetBuildingMesh() const { return BuildingMesh; }
+
+	UMaterialInterface* GetPlacementMaterial(bool bValid) const { return bValid ? ValidPlacementMaterial : InvalidPlacementMaterial; }
+
+	UMaterialInterface* GetCompleteMaterial() const { return CompleteMaterial; }
+
+	// True while the building is drawn by the shared render manager instead of its own mesh
+	bool IsRenderInstanced() const { return InstancingManager.IsValid(); }
+
 	// Ownership
 	UFUNCTION(BlueprintPure, Category = "Building")
 	EFactionID GetOwnerFaction() const { return OwnerFaction; }
@@ -43,12 +57,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Building")
 	void SetOwnerFaction(EFactionID NewOwner);
 
+	// Territory whose production ledger this building contributes to
+	UFUNCTION(BlueprintPure, Category = "Building")
+	ATerritoryRegion* GetOwningTerritory() const { return OwningTerritory; }
+
+	void SetOwningTerritory(ATerritoryRegion* Territory) { OwningTerritory = Territory; }
+
 	// Construction
 	UFUNCTION(BlueprintCallable, Category = "Building|Construction")
 	void StartConstruction();
 
 	UFUNCTION(BlueprintPure, Category = "Building|Construction")
-	float GetConstructionProgress() const { return ConstructionProgress; }
+	float GetConstructionProgress() const;
+
+	double GetConstructionEndTime() const { return ConstructionEndTime; }
+
+	// Called by the construction scheduler
+	void CompleteConstruction();
+	void UpdateConstructionVisual(double WorldTime);
 
 	UFUNCTION(BlueprintPure, Category = "Building|Construction")
 	bool IsComplete() const { return CurrentState == EBuildingState::Complete; }
@@ -112,6 +138,9 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|State")
 	bool bIsSelected;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|State")
+	ATerritoryRegion* OwningTerritory;
+
 	// Materials for visual feedback
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Visuals")
 	UMaterialInterface* ValidPlacementMaterial;
@@ -140,10 +169,26 @@ protected:
 	FOnBuildingDestroyed OnBuildingDestroyed;
 
 	virtual void OnConstruction(const FTransform& Transform) override;
-	virtual void UpdateConstruction(float DeltaSeconds);
 	virtual void OnConstructionFinished();
 	virtual void OnDestroyed();
 
 private:
+	// World times bracketing the current construction
+	double ConstructionStartTime;
+	double ConstructionEndTime;
+
+	// Render manager currently drawing this building, if any
+	TWeakObjectPtr<ABuildingRenderManager> InstancingManager;
+
+	// Unit simulation this building is registered with as an obstacle, if any
+	TWeakObjectPtr<AUnitSimulationManager> ObstacleSimulation;
+
+	void RegisterAsObstacle();
+	void UnregisterAsObstacle();
+
 	void UpdateVisuals();
+
+	// Hands settled buildings to the render manager and takes them back when they need their own mesh
+	void UpdateRenderMode();
+	bool ShouldRenderInstanced() const;
 };
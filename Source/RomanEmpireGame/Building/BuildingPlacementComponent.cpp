@@ -3,6 +3,11 @@
 #include "BuildingPlacementComponent.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
 #include "RomanEmpireGame/Building/BuildingBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireGameMode.h"
+#include "RomanEmpireGame/World/WorldMapManager.h"
+#include "RomanEmpireGame/World/TerritoryRegion.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Kismet/GameplayStatics.h"
 
 UBuildingPlacementComponent::UBuildingPlacementComponent()
@@ -12,10 +17,22 @@ UBuildingPlacementComponent::UBuildingPlacementComponent()
 	bIsPlacing = false;
 	bCanPlace = false;
 	CurrentBuildingClass = nullptr;
-	PreviewBuilding = nullptr;
+	PreviewActor = nullptr;
 	CurrentRotation = 0.0f;
+	CurrentTerritory = nullptr;
+	CurrentFootprint = FVector2D::ZeroVector;
+	ValidatedGridVersion = 0;
 	GridSize = 100.0f;   // 1 meter grid
 	bSnapToGrid = true;
+	MaxDragSegments = 64;
+	DragValidMaterial = nullptr;
+	DragInvalidMaterial = nullptr;
+	DragMode = EPlacementDragMode::Single;
+	bIsDragging = false;
+	DragAnchor = FVector::ZeroVector;
+	LastDragEnd = FVector::ZeroVector;
+	ValidSegmentInstances = nullptr;
+	InvalidSegmentInstances = nullptr;
 }
 
 void UBuildingPlacementComponent::BeginPlay()
@@ -23,15 +40,27 @@ void UBuildingPlacementComponent::BeginPlay()
 	Super::BeginPlay();
 }
 
+void UBuildingPlacementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (PreviewActor)
+	{
+		PreviewActor->Destroy();
+		PreviewActor = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void UBuildingPlacementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	if (bIsPlacing && PreviewBuilding)
+	// Only revalidate when something was built or destroyed under a still preview
+	if (bIsPlacing && !bIsDragging && PreviewActor && CurrentTerritory &&
+		CurrentTerritory->GetOccupancyGrid().GetVersion() != ValidatedGridVersion)
 	{
-		// Continuously validate placement
 		bCanPlace = ValidatePlacement();
-		PreviewBuilding->SetPlacementMode(true, bCanPlace);
+		PreviewActor->SetPlacementValid(bCanPlace);
 	}
 }
 
@@ -50,17 +79,18 @@ void UBuildingPlacementComponent::StartPlacement(TSubclassOf<ABuildingBase> Buil
 	}
 
 	CurrentBuildingClass = BuildingClass;
+	CurrentFootprint = GetPreviewData(BuildingClass).FootprintSize;
 	CurrentRotation = 0.0f;
 	bIsPlacing = true;
 
-	CreatePreviewBuilding();
+	ShowPreview();
 
 	UE_LOG(LogRomanEmpire, Log, TEXT("Started placing building: %s"), *BuildingClass->GetName());
 }
 
 void UBuildingPlacementComponent::UpdatePreview(const FVector& WorldLocation)
 {
-	if (!bIsPlacing || !PreviewBuilding)
+	if (!bIsPlacing || !PreviewActor)
 	{
 		return;
 	}
@@ -69,13 +99,27 @@ void UBuildingPlacementComponent::UpdatePreview(const FVector& WorldLocation)
 	FVector SnappedLocation = bSnapToGrid ? SnapToGrid(WorldLocation) : WorldLocation;
 	CurrentPlacementLocation = SnappedLocation;
 
+	// While dragging the cursor moves the far end of the run
+	if (bIsDragging)
+	{
+		if (!SnappedLocation.Equals(LastDragEnd))
+		{
+			LastDragEnd = SnappedLocation;
+			BuildDragSegments(SnappedLocation);
+			ValidateDragSegments();
+			UpdateDragPreview();
+			bCanPlace = GetValidDragSegmentCount() > 0;
+		}
+		return;
+	}
+
 	// Update preview position and rotation
 	FRotator Rotation(0.0f, CurrentRotation, 0.0f);
-	PreviewBuilding->SetActorLocationAndRotation(SnappedLocation, Rotation);
+	PreviewActor->SetActorLocationAndRotation(SnappedLocation, Rotation);
 
 	// Validate placement
 	bCanPlace = ValidatePlacement();
-	PreviewBuilding->SetPlacementMode(true, bCanPlace);
+	PreviewActor->SetPlacementValid(bCanPlace);
 }
 
 void UBuildingPlacementComponent::RotatePreview(float Degrees)
@@ -87,15 +131,24 @@ void UBuildingPlacementComponent::RotatePreview(float Degrees)
 
 	CurrentRotation = FMath::Fmod(CurrentRotation + Degrees, 360.0f);
 	
-	if (PreviewBuilding)
+	if (PreviewActor)
 	{
 		FRotator Rotation(0.0f, CurrentRotation, 0.0f);
-		PreviewBuilding->SetActorRotation(Rotation);
+		PreviewActor->SetActorRotation(Rotation);
+
+		// Rotation changes the footprint cells
+		bCanPlace = ValidatePlacement();
+		PreviewActor->SetPlacementValid(bCanPlace);
 	}
 }
 
 bool UBuildingPlacementComponent::ConfirmPlacement()
 {
+	if (bIsDragging)
+	{
+		return ConfirmDragPlacement();
+	}
+
 	if (!bIsPlacing || !bCanPlace || !CurrentBuildingClass)
 	{
 		UE_LOG(LogRomanEmpire, Warning, TEXT("Cannot confirm placement: invalid state"));
@@ -108,8 +161,15 @@ bool UBuildingPlacementComponent::ConfirmPlacement()
 		return false;
 	}
 
-	// Destroy preview
-	DestroyPreviewBuilding();
+	const EFactionID Faction = GetPlacingFaction();
+	if (!ChargePlacement(Faction, 1))
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("Cannot afford %s"), *CurrentBuildingClass->GetName());
+		return false;
+	}
+
+	// Hide preview
+	HidePreview();
 
 	// Spawn actual building
 	FActorSpawnParameters SpawnParams;
@@ -125,8 +185,15 @@ bool UBuildingPlacementComponent::ConfirmPlacement()
 
 	if (NewBuilding)
 	{
-		// Set owner faction (TODO: Get from player controller)
-		NewBuilding->SetOwnerFaction(EFactionID::Rome);
+		NewBuilding->SetOwnerFaction(Faction);
+
+		// Claim the footprint so later previews see it without physics queries
+		if (CurrentTerritory)
+		{
+			NewBuilding->SetOwningTerritory(CurrentTerritory);
+			CurrentTerritory->OccupyFootprint(NewBuilding);
+			CurrentTerritory->RegisterBuilding(NewBuilding);
+		}
 		
 		// Start construction
 		NewBuilding->StartConstruction();
@@ -141,6 +208,8 @@ bool UBuildingPlacementComponent::ConfirmPlacement()
 	bIsPlacing = false;
 	bCanPlace = false;
 	CurrentBuildingClass = nullptr;
+	CurrentTerritory = nullptr;
+	BlockedCells.Reset();
 
 	return NewBuilding != nullptr;
 }
@@ -152,19 +221,31 @@ void UBuildingPlacementComponent::CancelPlacement()
 		return;
 	}
 
-	DestroyPreviewBuilding();
+	EndDrag();
+	HidePreview();
 
 	bIsPlacing = false;
 	bCanPlace = false;
 	CurrentBuildingClass = nullptr;
 	CurrentRotation = 0.0f;
+	CurrentTerritory = nullptr;
+	BlockedCells.Reset();
 
 	OnPlacementCancelled.Broadcast();
 
 	UE_LOG(LogRomanEmpire, Log, TEXT("Building placement cancelled"));
 }
 
-void UBuildingPlacementComponent::CreatePreviewBuilding()
+const FBuildingPreviewData& UBuildingPlacementComponent::GetPreviewData(TSubclassOf<ABuildingBase> BuildingClass)
+{
+	if (const FBuildingPreviewData* Cached = PreviewDataCache.Find(BuildingClass))
+	{
+		return *Cached;
+	}
+	return PreviewDataCache.Add(BuildingClass, FBuildingPreviewData::FromClass(BuildingClass));
+}
+
+void UBuildingPlacementComponent::ShowPreview()
 {
 	UWorld* World = GetWorld();
 	if (!World || !CurrentBuildingClass)
@@ -172,28 +253,26 @@ void UBuildingPlacementComponent::CreatePreviewBuilding()
 		return;
 	}
 
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-	PreviewBuilding = World->SpawnActor<ABuildingBase>(
-		CurrentBuildingClass, 
-		FVector::ZeroVector, 
-		FRotator::ZeroRotator, 
-		SpawnParams
-	);
+	// Spawned once, then reused for every placement
+	if (!PreviewActor)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		PreviewActor = World->SpawnActor<ABuildingPreviewActor>(ABuildingPreviewActor::StaticClass(), FTransform::Identity, SpawnParams);
+	}
 
-	if (PreviewBuilding)
+	if (PreviewActor)
 	{
-		PreviewBuilding->SetPlacementMode(true, false);
+		PreviewActor->ApplyPreviewData(GetPreviewData(CurrentBuildingClass));
+		PreviewActor->SetActorHiddenInGame(false);
 	}
 }
 
-void UBuildingPlacementComponent::DestroyPreviewBuilding()
+void UBuildingPlacementComponent::HidePreview()
 {
-	if (PreviewBuilding)
+	if (PreviewActor)
 	{
-		PreviewBuilding->Destroy();
-		PreviewBuilding = nullptr;
+		PreviewActor->SetActorHiddenInGame(true);
 	}
 }
 
@@ -212,22 +291,346 @@ FVector UBuildingPlacementComponent::SnapToGrid(const FVector& Location) const
 
 bool UBuildingPlacementComponent::ValidatePlacement()
 {
-	if (!PreviewBuilding)
+	BlockedCells.Reset();
+
+	if (!PreviewActor)
 	{
 		return false;
 	}
 
-	// Check if building can be placed at current location
-	if (!PreviewBuilding->CanPlaceAt(CurrentPlacementLocation))
+	// Must be inside a territory
+	CurrentTerritory = FindTerritoryAt(CurrentPlacementLocation, CurrentTerritory);
+	if (!CurrentTerritory)
+	{
+		return false;
+	}
+
+	// The territory would refuse to register the building
+	ValidatedGridVersion = CurrentTerritory->GetOccupancyGrid().GetVersion();
+	if (CurrentTerritory->GetFreeBuildingSlots() == 0)
+	{
+		return false;
+	}
+
+	// Footprint against the territory's occupancy bits
+	if (!CurrentTerritory->CanPlaceFootprint(CurrentPlacementLocation, CurrentFootprint, CurrentRotation, &BlockedCells))
 	{
 		return false;
 	}
 
 	// TODO: Additional checks:
 	// - Resource requirements
-	// - Within territory
 	// - Not in water
-	// - Sufficient distance from other buildings
 
 	return true;
 }
+
+ATerritoryRegion* UBuildingPlacementComponent::FindTerritoryAt(const FVector& Location, ATerritoryRegion* Hint) const
+{
+	// The cursor rarely leaves the territory it is in, so skip the map lookup
+	if (Hint && Hint->ContainsLocation(Location))
+	{
+		return Hint;
+	}
+
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	AWorldMapManager* WorldMapManager = GameMode ? GameMode->GetWorldMapManager() : nullptr;
+	return WorldMapManager ? WorldMapManager->GetTerritoryAtLocation(Location) : nullptr;
+}
+
+TArray<FVector> UBuildingPlacementComponent::GetBlockedCellLocations() const
+{
+	TArray<FVector> Locations;
+	if (!CurrentTerritory)
+	{
+		return Locations;
+	}
+
+	const FOccupancyGrid& Grid = CurrentTerritory->GetOccupancyGrid();
+	Locations.Reserve(BlockedCells.Num());
+	for (const FIntPoint& Cell : BlockedCells)
+	{
+		const FVector2D Center = Grid.GetCellCenter(Cell);
+		Locations.Add(FVector(Center.X, Center.Y, CurrentPlacementLocation.Z));
+	}
+	return Locations;
+}
+
+void UBuildingPlacementComponent::SetDragMode(EPlacementDragMode NewMode)
+{
+	if (bIsDragging)
+	{
+		EndDrag();
+	}
+	DragMode = NewMode;
+}
+
+bool UBuildingPlacementComponent::BeginDragPlacement(const FVector& WorldLocation)
+{
+	if (!bIsPlacing || !CurrentBuildingClass || DragMode == EPlacementDragMode::Single)
+	{
+		return false;
+	}
+
+	if (!SupportsDragPlacement(CurrentBuildingClass->GetDefaultObject<ABuildingBase>()->GetBuildingType()))
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("%s cannot be drag placed"), *CurrentBuildingClass->GetName());
+		return false;
+	}
+
+	EnsureDragPreviewComponents();
+
+	bIsDragging = true;
+	DragAnchor = bSnapToGrid ? SnapToGrid(WorldLocation) : WorldLocation;
+	LastDragEnd = FVector(TNumericLimits<float>::Max());
+
+	// The run preview replaces the single ghost
+	HidePreview();
+
+	UpdatePreview(WorldLocation);
+	return true;
+}
+
+int32 UBuildingPlacementComponent::GetValidDragSegmentCount() const
+{
+	int32 Valid = 0;
+	for (const FDragSegment& Segment : DragSegments)
+	{
+		Valid += Segment.bValid ? 1 : 0;
+	}
+	return Valid;
+}
+
+bool UBuildingPlacementComponent::SupportsDragPlacement(EBuildingType BuildingType)
+{
+	return BuildingType == EBuildingType::Wall || BuildingType == EBuildingType::Tower || BuildingType == EBuildingType::Gate;
+}
+
+void UBuildingPlacementComponent::BuildDragSegments(const FVector& DragEnd)
+{
+	DragSegments.Reset();
+
+	// Segments are laid end to end along the footprint's X axis
+	const float SegmentLength = FMath::Max(1.0f, CurrentFootprint.X) * 100.0f;
+	const FVector Delta = DragEnd - DragAnchor;
+	const int32 StepsX = FMath::RoundToInt(FMath::Abs(Delta.X) / SegmentLength);
+	const int32 StepsY = FMath::RoundToInt(FMath::Abs(Delta.Y) / SegmentLength);
+	const FVector StepX(FMath::Sign(Delta.X) * SegmentLength, 0.0f, 0.0f);
+	const FVector StepY(0.0f, FMath::Sign(Delta.Y) * SegmentLength, 0.0f);
+
+	if (DragMode == EPlacementDragMode::Rectangle && StepsX > 0 && StepsY > 0)
+	{
+		// The two X edges own the corners; the Y edges fill in between
+		AddDragRun(DragAnchor, StepX, StepsX + 1, 0.0f);
+		AddDragRun(DragAnchor + StepY * StepsY, StepX, StepsX + 1, 0.0f);
+		AddDragRun(DragAnchor + StepY, StepY, StepsY - 1, 90.0f);
+		AddDragRun(DragAnchor + StepX * StepsX + StepY, StepY, StepsY - 1, 90.0f);
+	}
+	else if (StepsX >= StepsY)
+	{
+		AddDragRun(DragAnchor, StepX, StepsX + 1, 0.0f);
+	}
+	else
+	{
+		AddDragRun(DragAnchor, StepY, StepsY + 1, 90.0f);
+	}
+}
+
+void UBuildingPlacementComponent::AddDragRun(const FVector& Start, const FVector& Step, int32 Count, float Yaw)
+{
+	for (int32 Index = 0; Index < Count && DragSegments.Num() < MaxDragSegments; ++Index)
+	{
+		FDragSegment& Segment = DragSegments.AddDefaulted_GetRef();
+		Segment.Location = Start + Step * Index;
+		Segment.Yaw = Yaw;
+		Segment.Territory = nullptr;
+		Segment.bValid = false;
+	}
+}
+
+void UBuildingPlacementComponent::ValidateDragSegments()
+{
+	// Slots left in each territory the run crosses; segments past a territory's capacity are invalid
+	TMap<const ATerritoryRegion*, int32> FreeSlots;
+
+	// One pass over the run; neighbouring segments usually share a territory
+	ATerritoryRegion* Territory = CurrentTerritory;
+	for (FDragSegment& Segment : DragSegments)
+	{
+		Territory = FindTerritoryAt(Segment.Location, Territory);
+		Segment.Territory = Territory;
+		Segment.bValid = Territory && Territory->CanPlaceFootprint(Segment.Location, CurrentFootprint, Segment.Yaw);
+
+		if (Segment.bValid)
+		{
+			int32& Free = FreeSlots.FindOrAdd(Territory, Territory->GetFreeBuildingSlots());
+			Segment.bValid = Free > 0;
+			Free -= Segment.bValid ? 1 : 0;
+		}
+	}
+	CurrentTerritory = Territory;
+}
+
+void UBuildingPlacementComponent::UpdateDragPreview()
+{
+	if (!ValidSegmentInstances || !InvalidSegmentInstances)
+	{
+		return;
+	}
+
+	TArray<FTransform> ValidTransforms;
+	TArray<FTransform> InvalidTransforms;
+	for (const FDragSegment& Segment : DragSegments)
+	{
+		const FTransform Transform(FRotator(0.0f, Segment.Yaw, 0.0f), Segment.Location);
+		(Segment.bValid ? ValidTransforms : InvalidTransforms).Add(Transform);
+	}
+
+	ValidSegmentInstances->ClearInstances();
+	InvalidSegmentInstances->ClearInstances();
+	ValidSegmentInstances->AddInstances(ValidTransforms, false, true);
+	InvalidSegmentInstances->AddInstances(InvalidTransforms, false, true);
+}
+
+bool UBuildingPlacementComponent::ConfirmDragPlacement()
+{
+	UWorld* World = GetWorld();
+	if (!World || !CurrentBuildingClass)
+	{
+		return false;
+	}
+
+	// Territories may have filled up since the run was last previewed; only what will register is charged
+	ValidateDragSegments();
+	UpdateDragPreview();
+
+	const int32 ValidCount = GetValidDragSegmentCount();
+	if (ValidCount == 0)
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("Cannot confirm placement: no valid segments"));
+		return false;
+	}
+
+	// Charge the whole run at once
+	const EFactionID Faction = GetPlacingFaction();
+	if (!ChargePlacement(Faction, ValidCount))
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("Cannot afford %d segments"), ValidCount);
+		return false;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	TArray<ABuildingBase*> Placed;
+	Placed.Reserve(ValidCount);
+
+	for (const FDragSegment& Segment : DragSegments)
+	{
+		if (!Segment.bValid)
+		{
+			continue;
+		}
+
+		ABuildingBase* NewBuilding = World->SpawnActor<ABuildingBase>(
+			CurrentBuildingClass, Segment.Location, FRotator(0.0f, Segment.Yaw, 0.0f), SpawnParams);
+
+		if (NewBuilding)
+		{
+			NewBuilding->SetOwnerFaction(Faction);
+			NewBuilding->SetOwningTerritory(Segment.Territory);
+			Segment.Territory->OccupyFootprint(NewBuilding);
+			Segment.Territory->RegisterBuilding(NewBuilding);
+			NewBuilding->StartConstruction();
+			Placed.Add(NewBuilding);
+		}
+	}
+
+	OnBuildingsPlaced.Broadcast(Placed);
+
+	UE_LOG(LogRomanEmpire, Log, TEXT("Placed %d of %d segments of %s"), Placed.Num(), DragSegments.Num(), *CurrentBuildingClass->GetName());
+
+	// Reset state
+	EndDrag();
+	HidePreview();
+	bIsPlacing = false;
+	bCanPlace = false;
+	CurrentBuildingClass = nullptr;
+	CurrentTerritory = nullptr;
+
+	return Placed.Num() > 0;
+}
+
+void UBuildingPlacementComponent::EndDrag()
+{
+	bIsDragging = false;
+	DragSegments.Reset();
+
+	if (ValidSegmentInstances)
+	{
+		ValidSegmentInstances->ClearInstances();
+	}
+	if (InvalidSegmentInstances)
+	{
+		InvalidSegmentInstances->ClearInstances();
+	}
+
+	if (PreviewActor && bIsPlacing)
+	{
+		PreviewActor->SetActorHiddenInGame(false);
+	}
+}
+
+void UBuildingPlacementComponent::EnsureDragPreviewComponents()
+{
+	AActor* Owner = GetOwner();
+	if (!Owner)
+	{
+		return;
+	}
+
+	if (!ValidSegmentInstances)
+	{
+		ValidSegmentInstances = NewObject<UInstancedStaticMeshComponent>(Owner, TEXT("ValidSegmentInstances"));
+		ValidSegmentInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		ValidSegmentInstances->SetCastShadow(false);
+		ValidSegmentInstances->RegisterComponent();
+	}
+
+	if (!InvalidSegmentInstances)
+	{
+		InvalidSegmentInstances = NewObject<UInstancedStaticMeshComponent>(Owner, TEXT("InvalidSegmentInstances"));
+		InvalidSegmentInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		InvalidSegmentInstances->SetCastShadow(false);
+		InvalidSegmentInstances->RegisterComponent();
+	}
+
+	// Instances share the building class's mesh with the ghost materials
+	UStaticMesh* Mesh = CurrentBuildingClass ? GetPreviewData(CurrentBuildingClass).Mesh : nullptr;
+
+	ValidSegmentInstances->SetStaticMesh(Mesh);
+	InvalidSegmentInstances->SetStaticMesh(Mesh);
+	ValidSegmentInstances->SetMaterial(0, DragValidMaterial);
+	InvalidSegmentInstances->SetMaterial(0, DragInvalidMaterial);
+}
+
+bool UBuildingPlacementComponent::ChargePlacement(EFactionID Faction, int32 Count) const
+{
+	const FFactionResources& Cost = CurrentBuildingClass->GetDefaultObject<ABuildingBase>()->GetBuildingDataRef().Cost;
+	FFactionResources TotalCost = FFactionResources::MakeEmpty();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		TotalCost.Add(Cost);
+	}
+
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	AFactionManager* FactionManager = GameMode ? GameMode->GetFactionManager() : nullptr;
+	return !FactionManager || FactionManager->DeductFactionResources(Faction, TotalCost);
+}
+
+EFactionID UBuildingPlacementComponent::GetPlacingFaction() const
+{
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	AFactionManager* FactionManager = GameMode ? GameMode->GetFactionManager() : nullptr;
+	return FactionManager ? FactionManager->GetPlayerFaction() : EFactionID::Rome;
+}
@@ -5,9 +5,12 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "RomanEmpireGame/Building/BuildingTypes.h"
+#include "RomanEmpireGame/Building/BuildingPreviewActor.h"
 #include "BuildingPlacementComponent.generated.h"
 
 class ABuildingBase;
+class ATerritoryRegion;
+class UInstancedStaticMeshComponent;
 
 /**
  * Component handling building placement mechanics (Age of Empires style)
@@ -22,6 +25,7 @@ public:
 	UBuildingPlacementComponent();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 	// Placement control
@@ -40,6 +44,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Building|Placement")
 	void CancelPlacement();
 
+	// Drag placement for wall-like buildings; UpdatePreview moves the far end and ConfirmPlacement commits the run
+	UFUNCTION(BlueprintCallable, Category = "Building|Placement")
+	void SetDragMode(EPlacementDragMode NewMode);
+
+	UFUNCTION(BlueprintCallable, Category = "Building|Placement")
+	bool BeginDragPlacement(const FVector& WorldLocation);
+
+	UFUNCTION(BlueprintPure, Category = "Building|Placement")
+	bool IsDragging() const { return bIsDragging; }
+
+	UFUNCTION(BlueprintPure, Category = "Building|Placement")
+	int32 GetDragSegmentCount() const { return DragSegments.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "Building|Placement")
+	int32 GetValidDragSegmentCount() const;
+
+	UFUNCTION(BlueprintPure, Category = "Building|Placement")
+	static bool SupportsDragPlacement(EBuildingType BuildingType);
+
 	// State queries
 	UFUNCTION(BlueprintPure, Category = "Building|Placement")
 	bool IsPlacing() const { return bIsPlacing; }
@@ -50,6 +73,10 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Building|Placement")
 	TSubclassOf<ABuildingBase> GetCurrentBuildingClass() const { return CurrentBuildingClass; }
 
+	// World-space centres of the cells blocking the current preview, for UI highlighting
+	UFUNCTION(BlueprintPure, Category = "Building|Placement")
+	TArray<FVector> GetBlockedCellLocations() const;
+
 protected:
 	// Currently placing
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
@@ -61,8 +88,13 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
 	TSubclassOf<ABuildingBase> CurrentBuildingClass;
 
+	// Ghost reused across placements; hidden rather than destroyed between them
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
-	ABuildingBase* PreviewBuilding;
+	ABuildingPreviewActor* PreviewActor;
+
+	// Mesh, footprint and materials per building class, read once from the class defaults
+	UPROPERTY()
+	TMap<TSubclassOf<ABuildingBase>, FBuildingPreviewData> PreviewDataCache;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
 	FVector CurrentPlacementLocation;
@@ -70,6 +102,13 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
 	float CurrentRotation;
 
+	// Territory under the preview, whose occupancy grid validates it
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
+	ATerritoryRegion* CurrentTerritory;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
+	FVector2D CurrentFootprint;
+
 	// Settings
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Placement")
 	float GridSize; // Snap to grid
@@ -77,9 +116,36 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Placement")
 	bool bSnapToGrid;
 
+	// Drag placement
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Placement|Drag")
+	int32 MaxDragSegments;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Placement|Drag")
+	UMaterialInterface* DragValidMaterial;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Placement|Drag")
+	UMaterialInterface* DragInvalidMaterial;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement|Drag")
+	EPlacementDragMode DragMode;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement|Drag")
+	bool bIsDragging;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement|Drag")
+	FVector DragAnchor;
+
+	// One instance per segment instead of one preview actor each
+	UPROPERTY()
+	UInstancedStaticMeshComponent* ValidSegmentInstances;
+
+	UPROPERTY()
+	UInstancedStaticMeshComponent* InvalidSegmentInstances;
+
 	// Events
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBuildingPlaced, ABuildingBase*, Building);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPlacementCancelled);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBuildingsPlaced, const TArray<ABuildingBase*>&, Buildings);
 
 	UPROPERTY(BlueprintAssignable, Category = "Building|Placement")
 	FOnBuildingPlaced OnBuildingPlaced;
@@ -87,9 +153,37 @@ protected:
 	UPROPERTY(BlueprintAssignable, Category = "Building|Placement")
 	FOnPlacementCancelled OnPlacementCancelled;
 
+	// Fired once for a committed drag run
+	UPROPERTY(BlueprintAssignable, Category = "Building|Placement")
+	FOnBuildingsPlaced OnBuildingsPlaced;
+
 private:
-	void CreatePreviewBuilding();
-	void DestroyPreviewBuilding();
+	struct FDragSegment
+	{
+		FVector Location;
+		float Yaw;
+		ATerritoryRegion* Territory;
+		bool bValid;
+	};
+
+	TArray<FIntPoint> BlockedCells;
+	uint32 ValidatedGridVersion;
+	TArray<FDragSegment> DragSegments;
+	FVector LastDragEnd;
+
+	ATerritoryRegion* FindTerritoryAt(const FVector& Location, ATerritoryRegion* Hint) const;
+	void BuildDragSegments(const FVector& DragEnd);
+	void AddDragRun(const FVector& Start, const FVector& Step, int32 Count, float Yaw);
+	void ValidateDragSegments();
+	void UpdateDragPreview();
+	bool ConfirmDragPlacement();
+	bool ChargePlacement(EFactionID Faction, int32 Count) const;
+	void EndDrag();
+	void EnsureDragPreviewComponents();
+	EFactionID GetPlacingFaction() const;
+	const FBuildingPreviewData& GetPreviewData(TSubclassOf<ABuildingBase> BuildingClass);
+	void ShowPreview();
+	void HidePreview();
 	FVector SnapToGrid(const FVector& Location) const;
 	bool ValidatePlacement();
 };
@@ -0,0 +1,78 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "BuildingPreviewActor.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+#include "Components/StaticMeshComponent.h"
+
+FBuildingPreviewData FBuildingPreviewData::FromClass(TSubclassOf<ABuildingBase> BuildingClass)
+{
+	FBuildingPreviewData Data;
+
+	const ABuildingBase* Defaults = BuildingClass ? BuildingClass->GetDefaultObject<ABuildingBase>() : nullptr;
+	if (!Defaults)
+	{
+		return Data;
+	}
+
+	if (const UStaticMeshComponent* Template = Defaults->GetBuildingMesh())
+	{
+		Data.Mesh = Template->GetStaticMesh();
+		Data.MeshTransform = Template->GetRelativeTransform();
+	}
+
+	Data.FootprintSize = Defaults->GetBuildingDataRef().FootprintSize;
+	Data.ValidMaterial = Defaults->GetPlacementMaterial(true);
+	Data.InvalidMaterial = Defaults->GetPlacementMaterial(false);
+
+	return Data;
+}
+
+ABuildingPreviewActor::ABuildingPreviewActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootScene = CreateDefaultSubobject<USceneComponent>(TEXT("RootScene"));
+	SetRootComponent(RootScene);
+
+	PreviewMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("PreviewMesh"));
+	PreviewMesh->SetupAttachment(RootScene);
+	PreviewMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	PreviewMesh->SetCastShadow(false);
+	PreviewMesh->SetCanEverAffectNavigation(false);
+
+	SetActorEnableCollision(false);
+
+	ValidMaterial = nullptr;
+	InvalidMaterial = nullptr;
+	AppliedValidity = EAppliedValidity::Unknown;
+}
+
+void ABuildingPreviewActor::ApplyPreviewData(const FBuildingPreviewData& Data)
+{
+	PreviewMesh->SetStaticMesh(Data.Mesh);
+	PreviewMesh->SetRelativeTransform(Data.MeshTransform);
+	ValidMaterial = Data.ValidMaterial;
+	InvalidMaterial = Data.InvalidMaterial;
+
+	// Force the next validity update to apply a material to the new mesh
+	AppliedValidity = EAppliedValidity::Unknown;
+	SetPlacementValid(false);
+}
+
+void ABuildingPreviewActor::SetPlacementValid(bool bValid)
+{
+	const EAppliedValidity NewValidity = bValid ? EAppliedValidity::Valid : EAppliedValidity::Invalid;
+	if (NewValidity == AppliedValidity)
+	{
+		return;
+	}
+
+	AppliedValidity = NewValidity;
+
+	UMaterialInterface* MaterialToUse = bValid ? ValidMaterial : InvalidMaterial;
+	if (MaterialToUse)
+	{
+		PreviewMesh->SetMaterial(0, MaterialToUse);
+	}
+}
@@ -0,0 +1,86 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "BuildingPreviewActor.generated.h"
+
+class ABuildingBase;
+class UStaticMesh;
+class UStaticMeshComponent;
+class UMaterialInterface;
+
+/**
+ * What a placement ghost needs from a building class, read once from its default object
+ */
+USTRUCT(BlueprintType)
+struct FBuildingPreviewData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
+	UStaticMesh* Mesh;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
+	FTransform MeshTransform;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
+	FVector2D FootprintSize;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
+	UMaterialInterface* ValidMaterial;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building|Placement")
+	UMaterialInterface* InvalidMaterial;
+
+	FBuildingPreviewData()
+		: Mesh(nullptr)
+		, FootprintSize(FVector2D::ZeroVector)
+		, ValidMaterial(nullptr)
+		, InvalidMaterial(nullptr)
+	{}
+
+	static FBuildingPreviewData FromClass(TSubclassOf<ABuildingBase> BuildingClass);
+};
+
+/**
+ * Ghost shown while placing a building: a single mesh, no collision, no gameplay state.
+ * One instance is reused for every placement and simply swaps mesh between building classes.
+ */
+UCLASS(NotBlueprintable)
+class ROMANEMPIREGAME_API ABuildingPreviewActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ABuildingPreviewActor();
+
+	void ApplyPreviewData(const FBuildingPreviewData& Data);
+
+	// Swaps the ghost material only when validity actually changes
+	void SetPlacementValid(bool bValid);
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USceneComponent* RootScene;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UStaticMeshComponent* PreviewMesh;
+
+	UPROPERTY()
+	UMaterialInterface* ValidMaterial;
+
+	UPROPERTY()
+	UMaterialInterface* InvalidMaterial;
+
+private:
+	enum class EAppliedValidity : uint8
+	{
+		Unknown,
+		Valid,
+		Invalid
+	};
+
+	EAppliedValidity AppliedValidity;
+};
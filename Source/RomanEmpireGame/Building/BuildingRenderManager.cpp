@@ -0,0 +1,113 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "BuildingRenderManager.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Instanced Buildings"), STAT_InstancedBuildings, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Building Batches"), STAT_BuildingBatches, STATGROUP_RomanEmpire);
+
+ABuildingRenderManager::ABuildingRenderManager()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootScene = CreateDefaultSubobject<USceneComponent>(TEXT("RootScene"));
+	SetRootComponent(RootScene);
+
+	bCastShadows = true;
+	CullDistance = 0;
+}
+
+bool ABuildingRenderManager::AddInstance(ABuildingBase* Building, UStaticMesh* Mesh, UMaterialInterface* Material, const FTransform& Transform)
+{
+	if (!Building || !Mesh || InstanceLookup.Contains(Building))
+	{
+		return false;
+	}
+
+	const int32 BatchIndex = FindOrCreateBatch(Mesh, Material);
+	FBatch& Batch = Batches[BatchIndex];
+
+	const int32 InstanceIndex = Batch.Component->AddInstance(Transform, true);
+	check(InstanceIndex == Batch.Owners.Num());
+	Batch.Owners.Add(Building);
+
+	InstanceLookup.Add(Building, { BatchIndex, InstanceIndex });
+	UpdateStats();
+	return true;
+}
+
+void ABuildingRenderManager::RemoveInstance(ABuildingBase* Building)
+{
+	FInstanceRef Ref;
+	if (!InstanceLookup.RemoveAndCopyValue(Building, Ref))
+	{
+		return;
+	}
+
+	FBatch& Batch = Batches[Ref.BatchIndex];
+	const int32 LastIndex = Batch.Owners.Num() - 1;
+
+	// Move the last instance into the hole so only the tail is ever removed and no other index shifts
+	if (Ref.InstanceIndex != LastIndex)
+	{
+		FTransform LastTransform;
+		Batch.Component->GetInstanceTransform(LastIndex, LastTransform, true);
+		Batch.Component->UpdateInstanceTransform(Ref.InstanceIndex, LastTransform, true, true);
+
+		Batch.Owners[Ref.InstanceIndex] = Batch.Owners[LastIndex];
+		if (ABuildingBase* Moved = Batch.Owners[Ref.InstanceIndex].Get())
+		{
+			InstanceLookup.FindChecked(Moved).InstanceIndex = Ref.InstanceIndex;
+		}
+	}
+
+	Batch.Component->RemoveInstance(LastIndex);
+	Batch.Owners.RemoveAt(LastIndex, 1, EAllowShrinking::No);
+	UpdateStats();
+}
+
+ABuildingRenderManager* ABuildingRenderManager::GetBuildingRenderManager(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<ABuildingRenderManager>(WorldContextObject);
+}
+
+int32 ABuildingRenderManager::FindOrCreateBatch(UStaticMesh* Mesh, UMaterialInterface* Material)
+{
+	const FBatchKey Key{ Mesh, Material };
+	if (const int32* Existing = BatchLookup.Find(Key))
+	{
+		return *Existing;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	Component->SetupAttachment(RootScene);
+	Component->SetStaticMesh(Mesh);
+	if (Material)
+	{
+		Component->SetMaterial(0, Material);
+	}
+
+	// Collision and selection stay on each building's own collision box
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetCastShadow(bCastShadows);
+	Component->SetCullDistances(0, CullDistance);
+	// Instances are added and removed at runtime, and the root they attach to is movable
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->RegisterComponent();
+
+	BatchComponents.Add(Component);
+
+	const int32 BatchIndex = Batches.Add({ Component, {} });
+	BatchLookup.Add(Key, BatchIndex);
+	return BatchIndex;
+}
+
+void ABuildingRenderManager::UpdateStats() const
+{
+	SET_DWORD_STAT(STAT_InstancedBuildings, InstanceLookup.Num());
+	SET_DWORD_STAT(STAT_BuildingBatches, Batches.Num());
+}
@@ -0,0 +1,88 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "BuildingRenderManager.generated.h"
+
+class ABuildingBase;
+class UStaticMesh;
+class UMaterialInterface;
+class UHierarchicalInstancedStaticMeshComponent;
+
+/**
+ * Draws settled buildings that share a mesh and material as instances of one HISM component.
+ * Buildings keep their own mesh component only while placing, constructing, damaged or selected.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API ABuildingRenderManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ABuildingRenderManager();
+
+	// Moves a building into its batch; the caller hides its own mesh
+	bool AddInstance(ABuildingBase* Building, UStaticMesh* Mesh, UMaterialInterface* Material, const FTransform& Transform);
+
+	void RemoveInstance(ABuildingBase* Building);
+
+	bool IsInstanced(const ABuildingBase* Building) const { return InstanceLookup.Contains(Building); }
+
+	UFUNCTION(BlueprintPure, Category = "Building|Rendering")
+	int32 GetInstancedBuildingCount() const { return InstanceLookup.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "Building|Rendering")
+	int32 GetBatchCount() const { return Batches.Num(); }
+
+	// Returns the world's render manager, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Building|Rendering", meta = (WorldContext = "WorldContextObject"))
+	static ABuildingRenderManager* GetBuildingRenderManager(UObject* WorldContextObject);
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USceneComponent* RootScene;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Rendering")
+	bool bCastShadows;
+
+	// Distance beyond which instanced buildings are culled, 0 for never
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Building|Rendering")
+	int32 CullDistance;
+
+private:
+	struct FBatchKey
+	{
+		UStaticMesh* Mesh;
+		UMaterialInterface* Material;
+
+		bool operator==(const FBatchKey& Other) const { return Mesh == Other.Mesh && Material == Other.Material; }
+		friend uint32 GetTypeHash(const FBatchKey& Key) { return HashCombine(GetTypeHash(Key.Mesh), GetTypeHash(Key.Material)); }
+	};
+
+	struct FBatch
+	{
+		UHierarchicalInstancedStaticMeshComponent* Component;
+
+		// Building drawn by each instance, kept in step with the component's instance order
+		TArray<TWeakObjectPtr<ABuildingBase>> Owners;
+	};
+
+	struct FInstanceRef
+	{
+		int32 BatchIndex;
+		int32 InstanceIndex;
+	};
+
+	TArray<FBatch> Batches;
+	TMap<FBatchKey, int32> BatchLookup;
+	TMap<const ABuildingBase*, FInstanceRef> InstanceLookup;
+
+	// Keeps the batch components alive for the garbage collector
+	UPROPERTY()
+	TArray<UHierarchicalInstancedStaticMeshComponent*> BatchComponents;
+
+	int32 FindOrCreateBatch(UStaticMesh* Mesh, UMaterialInterface* Material);
+	void UpdateStats() const;
+};
@@ -51,6 +51,17 @@ enum class EBuildingType : uint8
 	Fort		UMETA(DisplayName = "Fort")            // Military outpost
 };
 
+/**
+ * How a placement drag lays out segments (walls, towers, gates)
+ */
+UENUM(BlueprintType)
+enum class EPlacementDragMode : uint8
+{
+	Single		UMETA(DisplayName = "Single"),         // One building per click
+	Line		UMETA(DisplayName = "Line"),           // Straight run along the dominant axis
+	Rectangle	UMETA(DisplayName = "Rectangle")       // Closed perimeter of the dragged box
+};
+
 /**
  * Building construction state
  */
@@ -0,0 +1,78 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "ConstructionScheduler.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Construction Scheduler"), STAT_ConstructionScheduler, STATGROUP_RomanEmpire);
+
+AConstructionScheduler::AConstructionScheduler()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	VisibilityWindow = 0.25f;
+}
+
+void AConstructionScheduler::ScheduleConstruction(ABuildingBase* Building, double CompletionTime)
+{
+	if (!Building)
+	{
+		return;
+	}
+
+	CompletionHeap.HeapPush({ CompletionTime, Building });
+	ActiveBuildings.AddUnique(Building);
+	SetActorTickEnabled(true);
+}
+
+void AConstructionScheduler::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ConstructionScheduler);
+
+	Super::Tick(DeltaSeconds);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Finish every site whose time has come; only the heap top is ever inspected
+	while (CompletionHeap.Num() > 0 && CompletionHeap.HeapTop().CompletionTime <= Now)
+	{
+		FScheduledConstruction Entry;
+		CompletionHeap.HeapPop(Entry, EAllowShrinking::No);
+
+		// Destroyed or restarted sites leave stale entries behind
+		ABuildingBase* Building = Entry.Building.Get();
+		if (Building && Building->GetBuildingState() == EBuildingState::Constructing &&
+			Building->GetConstructionEndTime() == Entry.CompletionTime)
+		{
+			Building->CompleteConstruction();
+		}
+	}
+
+	// Raise the meshes of sites the player can see
+	for (int32 Index = ActiveBuildings.Num() - 1; Index >= 0; --Index)
+	{
+		ABuildingBase* Building = ActiveBuildings[Index].Get();
+		if (!Building || Building->GetBuildingState() != EBuildingState::Constructing)
+		{
+			ActiveBuildings.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		if (Building->WasRecentlyRendered(VisibilityWindow))
+		{
+			Building->UpdateConstructionVisual(Now);
+		}
+	}
+
+	if (CompletionHeap.Num() == 0 && ActiveBuildings.Num() == 0)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+AConstructionScheduler* AConstructionScheduler::GetConstructionScheduler(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AConstructionScheduler>(WorldContextObject);
+}
@@ -0,0 +1,54 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ConstructionScheduler.generated.h"
+
+class ABuildingBase;
+
+/**
+ * Completes building construction from a min-heap of completion times so buildings never tick.
+ * The rising-mesh animation only runs for construction sites that were recently rendered.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AConstructionScheduler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AConstructionScheduler();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Queues a building to finish at the given world time
+	void ScheduleConstruction(ABuildingBase* Building, double CompletionTime);
+
+	UFUNCTION(BlueprintPure, Category = "Construction")
+	int32 GetActiveConstructionCount() const { return ActiveBuildings.Num(); }
+
+	// Returns the world's scheduler, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Construction", meta = (WorldContext = "WorldContextObject"))
+	static AConstructionScheduler* GetConstructionScheduler(UObject* WorldContextObject);
+
+protected:
+	// A site counts as on screen if it was rendered within this many seconds
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Construction")
+	float VisibilityWindow;
+
+private:
+	struct FScheduledConstruction
+	{
+		double CompletionTime;
+		TWeakObjectPtr<ABuildingBase> Building;
+
+		bool operator<(const FScheduledConstruction& Other) const { return CompletionTime < Other.CompletionTime; }
+	};
+
+	// Min-heap on completion time; stale entries for cancelled sites are skipped when popped
+	TArray<FScheduledConstruction> CompletionHeap;
+
+	// Sites still under construction, for the visual pass
+	TArray<TWeakObjectPtr<ABuildingBase>> ActiveBuildings;
+};
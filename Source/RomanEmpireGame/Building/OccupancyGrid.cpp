@@ -0,0 +1,147 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "OccupancyGrid.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+
+// Footprints are authored in grid units of one metre
+static constexpr float FootprintUnitSize = 100.0f;
+
+void FOccupancyGrid::Initialize(const FVector2D& InOrigin, const FVector2D& InSize, float InCellSize)
+{
+	Origin = InOrigin;
+	CellSize = FMath::Max(1.0f, InCellSize);
+	Width = FMath::Max(0, FMath::CeilToInt(InSize.X / CellSize));
+	Height = FMath::Max(0, FMath::CeilToInt(InSize.Y / CellSize));
+	WordsPerRow = FMath::DivideAndRoundUp(Width, 64);
+	Words.Reset();
+	++Version;
+}
+
+FIntRect FOccupancyGrid::GetFootprintCells(const FVector& Location, const FVector2D& FootprintSize, float Yaw) const
+{
+	// Axis-aligned bounds of the rotated footprint; quarter turns are exact
+	const float Radians = FMath::DegreesToRadians(Yaw);
+	const float Cos = FMath::Abs(FMath::Cos(Radians));
+	const float Sin = FMath::Abs(FMath::Sin(Radians));
+	const FVector2D Size = FootprintSize * FootprintUnitSize;
+	const FVector2D HalfExtent(0.5f * (Size.X * Cos + Size.Y * Sin), 0.5f * (Size.X * Sin + Size.Y * Cos));
+
+	// A small tolerance keeps exact edges from spilling into the neighbouring cell
+	constexpr float Tolerance = 0.01f;
+	const FVector2D Local = FVector2D(Location.X, Location.Y) - Origin;
+
+	return FIntRect(
+		FMath::FloorToInt((Local.X - HalfExtent.X) / CellSize + Tolerance),
+		FMath::FloorToInt((Local.Y - HalfExtent.Y) / CellSize + Tolerance),
+		FMath::CeilToInt((Local.X + HalfExtent.X) / CellSize - Tolerance),
+		FMath::CeilToInt((Local.Y + HalfExtent.Y) / CellSize - Tolerance));
+}
+
+bool FOccupancyGrid::IsInside(const FIntRect& Cells) const
+{
+	return Cells.Min.X >= 0 && Cells.Min.Y >= 0 && Cells.Max.X <= Width && Cells.Max.Y <= Height;
+}
+
+uint64 FOccupancyGrid::MakeRowMask(int32 FirstBit, int32 EndBit)
+{
+	// Bits [FirstBit, EndBit) of one word
+	const uint64 High = EndBit >= 64 ? ~0ull : ((1ull << EndBit) - 1);
+	const uint64 Low = (1ull << FirstBit) - 1;
+	return High & ~Low;
+}
+
+bool FOccupancyGrid::IsAreaFree(const FIntRect& Cells) const
+{
+	if (!IsInside(Cells) || Cells.Area() <= 0)
+	{
+		return false;
+	}
+
+	if (Words.Num() == 0)
+	{
+		return true;
+	}
+
+	const int32 FirstWord = Cells.Min.X >> 6;
+	const int32 LastWord = (Cells.Max.X - 1) >> 6;
+
+	for (int32 Row = Cells.Min.Y; Row < Cells.Max.Y; ++Row)
+	{
+		const uint64* RowWords = Words.GetData() + Row * WordsPerRow;
+		for (int32 Word = FirstWord; Word <= LastWord; ++Word)
+		{
+			const int32 FirstBit = Word == FirstWord ? (Cells.Min.X & 63) : 0;
+			const int32 EndBit = Word == LastWord ? ((Cells.Max.X - 1) & 63) + 1 : 64;
+			if (RowWords[Word] & MakeRowMask(FirstBit, EndBit))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void FOccupancyGrid::GetBlockedCells(const FIntRect& Cells, TArray<FIntPoint>& OutBlocked) const
+{
+	OutBlocked.Reset();
+
+	for (int32 Row = Cells.Min.Y; Row < Cells.Max.Y; ++Row)
+	{
+		for (int32 Column = Cells.Min.X; Column < Cells.Max.X; ++Column)
+		{
+			const bool bOutside = Column < 0 || Row < 0 || Column >= Width || Row >= Height;
+			const bool bOccupied = !bOutside && Words.Num() > 0 &&
+				(Words[Row * WordsPerRow + (Column >> 6)] & (1ull << (Column & 63))) != 0;
+
+			if (bOutside || bOccupied)
+			{
+				OutBlocked.Add(FIntPoint(Column, Row));
+			}
+		}
+	}
+}
+
+void FOccupancyGrid::SetArea(const FIntRect& Cells, bool bOccupied)
+{
+	// Clip to the grid; buildings overhanging the edge only mark what is inside
+	const FIntRect Clipped(
+		FMath::Max(Cells.Min.X, 0), FMath::Max(Cells.Min.Y, 0),
+		FMath::Min(Cells.Max.X, Width), FMath::Min(Cells.Max.Y, Height));
+
+	if (Clipped.Min.X >= Clipped.Max.X || Clipped.Min.Y >= Clipped.Max.Y)
+	{
+		return;
+	}
+
+	if (Words.Num() == 0)
+	{
+		if (!bOccupied)
+		{
+			return;
+		}
+		Words.SetNumZeroed(WordsPerRow * Height);
+	}
+
+	const int32 FirstWord = Clipped.Min.X >> 6;
+	const int32 LastWord = (Clipped.Max.X - 1) >> 6;
+
+	for (int32 Row = Clipped.Min.Y; Row < Clipped.Max.Y; ++Row)
+	{
+		uint64* RowWords = Words.GetData() + Row * WordsPerRow;
+		for (int32 Word = FirstWord; Word <= LastWord; ++Word)
+		{
+			const int32 FirstBit = Word == FirstWord ? (Clipped.Min.X & 63) : 0;
+			const int32 EndBit = Word == LastWord ? ((Clipped.Max.X - 1) & 63) + 1 : 64;
+			const uint64 Mask = MakeRowMask(FirstBit, EndBit);
+			RowWords[Word] = bOccupied ? (RowWords[Word] | Mask) : (RowWords[Word] & ~Mask);
+		}
+	}
+
+	++Version;
+}
+
+FVector2D FOccupancyGrid::GetCellCenter(const FIntPoint& Cell) const
+{
+	return Origin + FVector2D((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize);
+}
@@ -0,0 +1,44 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * One bit per placement cell over a rectangular area, packed 64 cells per word along each row.
+ * Placement checks become word masks instead of physics overlap queries.
+ */
+struct ROMANEMPIREGAME_API FOccupancyGrid
+{
+	// Sets the covered area; bits are allocated on the first occupied cell
+	void Initialize(const FVector2D& InOrigin, const FVector2D& InSize, float InCellSize);
+
+	bool IsInitialized() const { return Width > 0 && Height > 0; }
+
+	// Cells covered by a footprint given in grid units (100 uu each) centred on Location
+	FIntRect GetFootprintCells(const FVector& Location, const FVector2D& FootprintSize, float Yaw) const;
+
+	// Cells outside the grid count as blocked
+	bool IsAreaFree(const FIntRect& Cells) const;
+	void GetBlockedCells(const FIntRect& Cells, TArray<FIntPoint>& OutBlocked) const;
+
+	void SetArea(const FIntRect& Cells, bool bOccupied);
+
+	FVector2D GetCellCenter(const FIntPoint& Cell) const;
+	float GetCellSize() const { return CellSize; }
+
+	// Bumped on every change so callers can skip revalidation when nothing moved
+	uint32 GetVersion() const { return Version; }
+
+private:
+	FVector2D Origin = FVector2D::ZeroVector;
+	float CellSize = 100.0f;
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 WordsPerRow = 0;
+	uint32 Version = 0;
+	TArray<uint64> Words;
+
+	bool IsInside(const FIntRect& Cells) const;
+	static uint64 MakeRowMask(int32 FirstBit, int32 EndBit);
+};
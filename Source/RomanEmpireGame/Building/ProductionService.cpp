@@ -0,0 +1,317 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "ProductionService.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Core/RomanEmpireGameMode.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unit Production"), STAT_UnitProduction, STATGROUP_RomanEmpire);
+
+void AProductionService::FProductionQueue::PopFront()
+{
+	Head = (Head + 1) % Orders.Num();
+	--Count;
+	Progress = 0.0f;
+}
+
+AProductionService::AProductionService()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	BatchGroupSize = 5;
+	MaxSpawnsPerUpdate = 8;
+	GroupSpacing = 120.0f;
+	PendingSpawnHead = 0;
+}
+
+bool AProductionService::EnqueueTraining(ABuildingBase* Building, TSubclassOf<AUnitBase> UnitClass, int32 Count, const FTransform& SpawnTransform, int32 MaxQueueSize)
+{
+	if (!Building || !UnitClass || Count <= 0 || !Building->IsComplete())
+	{
+		return false;
+	}
+
+	FProductionQueue* Queue = FindQueue(Building);
+	if (!Queue)
+	{
+		const int32 Slot = Queues.AddDefaulted();
+		Queue = &Queues[Slot];
+		Queue->Building = Building;
+		Queue->SlotKey = Building;
+		Queue->SpawnTransform = SpawnTransform;
+		Queue->Orders.SetNum(FMath::Max(1, MaxQueueSize));
+		Queue->Head = 0;
+		Queue->Count = 0;
+		Queue->Progress = 0.0f;
+		QueueSlots.Add(Building, Slot);
+	}
+
+	if (Queue->Count >= Queue->Orders.Num())
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("Training queue is full"));
+		return false;
+	}
+
+	const FUnitData& UnitData = UnitClass->GetDefaultObject<AUnitBase>()->GetUnitData();
+
+	// The whole batch is paid for when it is queued
+	AFactionManager* FactionManager = GetFactionManager();
+	if (FactionManager && Building->GetOwnerFaction() != EFactionID::None)
+	{
+		FFactionResources Cost = FFactionResources::MakeEmpty();
+		Cost.Gold = UnitData.GoldCost * Count;
+		Cost.Food = UnitData.FoodCost * Count;
+
+		if (!FactionManager->DeductFactionResources(Building->GetOwnerFaction(), Cost))
+		{
+			UE_LOG(LogRomanEmpire, Warning, TEXT("Cannot afford %d x %s"), Count, *UnitClass->GetName());
+			return false;
+		}
+	}
+
+	Queue->OwnerFaction = Building->GetOwnerFaction();
+
+	FProductionOrder& Order = Queue->Orders[(Queue->Head + Queue->Count) % Queue->Orders.Num()];
+	Order.UnitClass = UnitClass;
+	Order.Remaining = Count;
+	Order.TrainingTime = FMath::Max(0.01f, UnitData.TrainingTime);
+	Order.GoldCost = UnitData.GoldCost;
+	Order.FoodCost = UnitData.FoodCost;
+	++Queue->Count;
+
+	SetActorTickEnabled(true);
+
+	UE_LOG(LogRomanEmpire, Log, TEXT("Queued %d x %s (Queue size: %d)"), Count, *UnitClass->GetName(), Queue->Count);
+	return true;
+}
+
+void AProductionService::CancelCurrentOrder(ABuildingBase* Building)
+{
+	FProductionQueue* Queue = FindQueue(Building);
+	if (!Queue || Queue->Count == 0)
+	{
+		return;
+	}
+
+	Refund(Queue->OwnerFaction, Queue->Front().GoldCost, Queue->Front().FoodCost, Queue->Front().Remaining);
+	Queue->PopFront();
+}
+
+void AProductionService::ClearQueue(ABuildingBase* Building)
+{
+	FProductionQueue* Queue = FindQueue(Building);
+	if (!Queue)
+	{
+		return;
+	}
+
+	RefundAll(*Queue);
+}
+
+bool AProductionService::IsTraining(const ABuildingBase* Building) const
+{
+	const FProductionQueue* Queue = FindQueue(Building);
+	return Queue && Queue->Count > 0;
+}
+
+float AProductionService::GetTrainingProgress(const ABuildingBase* Building) const
+{
+	const FProductionQueue* Queue = FindQueue(Building);
+	if (!Queue || Queue->Count == 0)
+	{
+		return 0.0f;
+	}
+
+	const FProductionOrder& Order = Queue->Front();
+	return FMath::Clamp(Queue->Progress / (Order.TrainingTime * GetGroupSize(Order)), 0.0f, 1.0f);
+}
+
+int32 AProductionService::GetQueuedOrderCount(const ABuildingBase* Building) const
+{
+	const FProductionQueue* Queue = FindQueue(Building);
+	return Queue ? Queue->Count : 0;
+}
+
+void AProductionService::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitProduction);
+
+	Super::Tick(DeltaSeconds);
+
+	for (int32 Index = Queues.Num() - 1; Index >= 0; --Index)
+	{
+		FProductionQueue& Queue = Queues[Index];
+		ABuildingBase* Building = Queue.Building.Get();
+
+		if (!Building || Building->GetBuildingState() == EBuildingState::Destroyed || Queue.Count == 0)
+		{
+			RefundAll(Queue);
+			RemoveQueue(Index);
+			continue;
+		}
+
+		// Damaged buildings pause training until repaired
+		if (!Building->IsComplete())
+		{
+			continue;
+		}
+
+		Queue.Progress += DeltaSeconds;
+
+		while (Queue.Count > 0)
+		{
+			FProductionOrder& Order = Queue.Front();
+			const int32 GroupSize = GetGroupSize(Order);
+			const float GroupTime = Order.TrainingTime * GroupSize;
+
+			if (Queue.Progress < GroupTime)
+			{
+				break;
+			}
+
+			QueueGroupSpawn(Queue, Order, GroupSize);
+			Order.Remaining -= GroupSize;
+
+			const float Leftover = Queue.Progress - GroupTime;
+			if (Order.Remaining <= 0)
+			{
+				Queue.PopFront();
+			}
+			Queue.Progress = Leftover;
+		}
+	}
+
+	ProcessPendingSpawns();
+
+	if (Queues.Num() == 0 && PendingSpawnHead >= PendingSpawns.Num())
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+AProductionService* AProductionService::GetProductionService(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AProductionService>(WorldContextObject);
+}
+
+AProductionService::FProductionQueue* AProductionService::FindQueue(const ABuildingBase* Building)
+{
+	const int32* Slot = QueueSlots.Find(Building);
+	return Slot ? &Queues[*Slot] : nullptr;
+}
+
+const AProductionService::FProductionQueue* AProductionService::FindQueue(const ABuildingBase* Building) const
+{
+	const int32* Slot = QueueSlots.Find(Building);
+	return Slot ? &Queues[*Slot] : nullptr;
+}
+
+void AProductionService::RemoveQueue(int32 Index)
+{
+	QueueSlots.Remove(Queues[Index].SlotKey);
+
+	Queues.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Queues.IsValidIndex(Index))
+	{
+		QueueSlots.Add(Queues[Index].SlotKey, Index);
+	}
+}
+
+void AProductionService::Refund(EFactionID Faction, int32 GoldCost, int32 FoodCost, int32 Units) const
+{
+	AFactionManager* FactionManager = GetFactionManager();
+	if (!FactionManager || Faction == EFactionID::None || Units <= 0)
+	{
+		return;
+	}
+
+	FFactionResources Returned = FFactionResources::MakeEmpty();
+	Returned.Gold = GoldCost * Units;
+	Returned.Food = FoodCost * Units;
+	FactionManager->ModifyFactionResources(Faction, Returned);
+}
+
+void AProductionService::RefundAll(FProductionQueue& Queue) const
+{
+	while (Queue.Count > 0)
+	{
+		Refund(Queue.OwnerFaction, Queue.Front().GoldCost, Queue.Front().FoodCost, Queue.Front().Remaining);
+		Queue.PopFront();
+	}
+}
+
+void AProductionService::QueueGroupSpawn(const FProductionQueue& Queue, const FProductionOrder& Order, int32 Units)
+{
+	// Lay the group out in ranks of five in front of the building
+	constexpr int32 RankWidth = 5;
+	for (int32 Unit = 0; Unit < Units; ++Unit)
+	{
+		const int32 Rank = Unit / RankWidth;
+		const int32 File = Unit % RankWidth;
+		const FVector LocalOffset(Rank * GroupSpacing, (File - (RankWidth - 1) * 0.5f) * GroupSpacing, 0.0f);
+
+		FPendingSpawn& Spawn = PendingSpawns.AddDefaulted_GetRef();
+		Spawn.Building = Queue.Building;
+		Spawn.UnitClass = Order.UnitClass;
+		Spawn.SpawnTransform = FTransform(Queue.SpawnTransform.GetRotation(), Queue.SpawnTransform.TransformPosition(LocalOffset));
+		Spawn.OwnerFaction = Queue.OwnerFaction;
+		Spawn.GoldCost = Order.GoldCost;
+		Spawn.FoodCost = Order.FoodCost;
+	}
+}
+
+void AProductionService::ProcessPendingSpawns()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// Spread large batches over several frames
+	int32 Spawned = 0;
+	while (PendingSpawnHead < PendingSpawns.Num() && Spawned < MaxSpawnsPerUpdate)
+	{
+		const FPendingSpawn& Spawn = PendingSpawns[PendingSpawnHead++];
+		ABuildingBase* Building = Spawn.Building.Get();
+		if (!Building || Building->GetBuildingState() == EBuildingState::Destroyed)
+		{
+			// Paid for when queued, like the orders of a lost queue
+			Refund(Spawn.OwnerFaction, Spawn.GoldCost, Spawn.FoodCost, 1);
+			continue;
+		}
+
+		AUnitBase* NewUnit = World->SpawnActor<AUnitBase>(Spawn.UnitClass, Spawn.SpawnTransform, SpawnParams);
+		if (NewUnit)
+		{
+			NewUnit->SetOwnerFaction(Building->GetOwnerFaction());
+			UE_LOG(LogRomanEmpire, Log, TEXT("Trained unit: %s"), *NewUnit->GetName());
+		}
+		++Spawned;
+	}
+
+	if (PendingSpawnHead >= PendingSpawns.Num())
+	{
+		PendingSpawns.Reset();
+		PendingSpawnHead = 0;
+	}
+}
+
+int32 AProductionService::GetGroupSize(const FProductionOrder& Order) const
+{
+	return FMath::Clamp(BatchGroupSize, 1, FMath::Max(1, Order.Remaining));
+}
+
+AFactionManager* AProductionService::GetFactionManager() const
+{
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	return GameMode ? GameMode->GetFactionManager() : nullptr;
+}
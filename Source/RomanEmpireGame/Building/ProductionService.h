@@ -0,0 +1,116 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "ProductionService.generated.h"
+
+class ABuildingBase;
+class AUnitBase;
+class AFactionManager;
+
+/**
+ * Trains units for every production building (Barracks, ArcheryRange, Stable) in one batched update.
+ * Each building gets a fixed-size ring buffer of orders; an order can train many units of one type.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AProductionService : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AProductionService();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Charges the full cost up front and queues Count units; fails if the queue is full or unaffordable
+	bool EnqueueTraining(ABuildingBase* Building, TSubclassOf<AUnitBase> UnitClass, int32 Count, const FTransform& SpawnTransform, int32 MaxQueueSize);
+
+	// Drops the order in progress and refunds the units it has not produced yet
+	void CancelCurrentOrder(ABuildingBase* Building);
+
+	// Drops every order of a building, refunding unproduced units
+	void ClearQueue(ABuildingBase* Building);
+
+	bool IsTraining(const ABuildingBase* Building) const;
+	float GetTrainingProgress(const ABuildingBase* Building) const;
+	int32 GetQueuedOrderCount(const ABuildingBase* Building) const;
+
+	// Returns the world's production service, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Production", meta = (WorldContext = "WorldContextObject"))
+	static AProductionService* GetProductionService(UObject* WorldContextObject);
+
+protected:
+	// Units of a batch order that finish together
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Production")
+	int32 BatchGroupSize;
+
+	// Units actually spawned per update across all buildings; the rest wait for later frames
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Production")
+	int32 MaxSpawnsPerUpdate;
+
+	// Distance between units of a group when they leave the building
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Production")
+	float GroupSpacing;
+
+private:
+	struct FProductionOrder
+	{
+		TSubclassOf<AUnitBase> UnitClass;
+		int32 Remaining;
+		float TrainingTime;
+		int32 GoldCost;
+		int32 FoodCost;
+	};
+
+	struct FProductionQueue
+	{
+		TWeakObjectPtr<ABuildingBase> Building;
+		const ABuildingBase* SlotKey;
+		FTransform SpawnTransform;
+
+		// Faction that paid for the orders, so they can be refunded after the building is gone
+		EFactionID OwnerFaction;
+
+		// Ring buffer of orders, sized once from the building's queue limit
+		TArray<FProductionOrder> Orders;
+		int32 Head;
+		int32 Count;
+
+		// Seconds into the group at the head of the queue
+		float Progress;
+
+		FProductionOrder& Front() { return Orders[Head]; }
+		const FProductionOrder& Front() const { return Orders[Head]; }
+		void PopFront();
+	};
+
+	struct FPendingSpawn
+	{
+		TWeakObjectPtr<ABuildingBase> Building;
+		TSubclassOf<AUnitBase> UnitClass;
+		FTransform SpawnTransform;
+
+		// What was paid for this unit, refunded if its building is lost before it spawns
+		EFactionID OwnerFaction;
+		int32 GoldCost;
+		int32 FoodCost;
+	};
+
+	TArray<FProductionQueue> Queues;
+	TMap<const ABuildingBase*, int32> QueueSlots;
+	TArray<FPendingSpawn> PendingSpawns;
+	int32 PendingSpawnHead;
+
+	FProductionQueue* FindQueue(const ABuildingBase* Building);
+	const FProductionQueue* FindQueue(const ABuildingBase* Building) const;
+	void RemoveQueue(int32 Index);
+	void Refund(EFactionID Faction, int32 GoldCost, int32 FoodCost, int32 Units) const;
+	void RefundAll(FProductionQueue& Queue) const;
+	void QueueGroupSpawn(const FProductionQueue& Queue, const FProductionOrder& Order, int32 Units);
+	void ProcessPendingSpawns();
+	int32 GetGroupSize(const FProductionOrder& Order) const;
+	AFactionManager* GetFactionManager() const;
+};
@@ -5,6 +5,9 @@
 #include "RomanEmpireGame/Faction/FactionManager.h"
 #include "RomanEmpireGame/World/WorldMapManager.h"
 #include "RomanEmpireGame/World/CampaignManager.h"
+#include "RomanEmpireGame/World/TradeNetworkManager.h"
+#include "RomanEmpireGame/World/ArmyManager.h"
+#include "RomanEmpireGame/Units/UnitTypeRegistry.h"
 #include "Kismet/GameplayStatics.h"
 
 ARomanEmpireGameMode::ARomanEmpireGameMode()
@@ -17,6 +20,17 @@ ARomanEmpireGameMode::ARomanEmpireGameMode()
 	FactionManager = nullptr;
 	WorldMapManager = nullptr;
 	CampaignManager = nullptr;
+	TradeNetworkManager = nullptr;
+	ArmyManager = nullptr;
+	UnitTypeTable = nullptr;
+}
+
+void ARomanEmpireGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// Before BeginPlay, so placed units already see data table definitions
+	FUnitTypeRegistry::Get().LoadFromDataTable(UnitTypeTable);
 }
 
 void ARomanEmpireGameMode::BeginPlay()
@@ -135,6 +149,20 @@ void ARomanEmpireGameMode::InitializeManagers()
 		UE_LOG(LogRomanEmpire, Log, TEXT("World Map Manager initialized"));
 	}
 	
+	// Spawn Trade Network Manager (needs the map and factions)
+	TradeNetworkManager = World->SpawnActor<ATradeNetworkManager>(ATradeNetworkManager::StaticClass(), SpawnParams);
+	if (TradeNetworkManager)
+	{
+		UE_LOG(LogRomanEmpire, Log, TEXT("Trade Network Manager initialized"));
+	}
+	
+	// Spawn Army Manager (needs the map and factions)
+	ArmyManager = World->SpawnActor<AArmyManager>(AArmyManager::StaticClass(), SpawnParams);
+	if (ArmyManager)
+	{
+		UE_LOG(LogRomanEmpire, Log, TEXT("Army Manager initialized"));
+	}
+	
 	// Spawn Campaign Manager
 	CampaignManager = World->SpawnActor<ACampaignManager>(ACampaignManager::StaticClass(), SpawnParams);
 	if (CampaignManager)
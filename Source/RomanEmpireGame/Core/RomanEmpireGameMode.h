@@ -9,6 +9,9 @@
 class AFactionManager;
 class AWorldMapManager;
 class ACampaignManager;
+class ATradeNetworkManager;
+class AArmyManager;
+class UDataTable;
 
 /**
  * Game phase representing the current mode of gameplay
@@ -34,6 +37,7 @@ class ROMANEMPIREGAME_API ARomanEmpireGameMode : public AGameModeBase
 public:
 	ARomanEmpireGameMode();
 
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
 	virtual void BeginPlay() override;
 	virtual void Tick(float DeltaSeconds) override;
 
@@ -62,6 +66,12 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Managers")
 	ACampaignManager* GetCampaignManager() const { return CampaignManager; }
 
+	UFUNCTION(BlueprintPure, Category = "Managers")
+	ATradeNetworkManager* GetTradeNetworkManager() const { return TradeNetworkManager; }
+
+	UFUNCTION(BlueprintPure, Category = "Managers")
+	AArmyManager* GetArmyManager() const { return ArmyManager; }
+
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game Phase")
 	EGamePhase CurrentPhase;
@@ -69,6 +79,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Campaign")
 	int32 CurrentTurn;
 
+	// Unit type definitions (FUnitTypeRow) loaded into the unit type registry before any unit spawns
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units")
+	UDataTable* UnitTypeTable;
+
 	// Manager references
 	UPROPERTY()
 	AFactionManager* FactionManager;
@@ -79,6 +93,12 @@ protected:
 	UPROPERTY()
 	ACampaignManager* CampaignManager;
 
+	UPROPERTY()
+	ATradeNetworkManager* TradeNetworkManager;
+
+	UPROPERTY()
+	AArmyManager* ArmyManager;
+
 	// Phase change delegate
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnGamePhaseChanged, EGamePhase, OldPhase, EGamePhase, NewPhase);
 	
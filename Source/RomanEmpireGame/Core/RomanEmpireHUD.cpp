@@ -75,11 +75,11 @@ void ARomanEmpireHUD::ToggleBuildingMenu()
 	}
 }
 
-void ARomanEmpireHUD::UpdateUnitSelection(const TArray<AUnitBase*>& SelectedUnits)
+void ARomanEmpireHUD::UpdateUnitSelection(const FUnitSelectionSummary& Summary)
 {
 	if (MainWidget)
 	{
-		MainWidget->UpdateUnitPanel(SelectedUnits);
+		MainWidget->UpdateUnitPanel(Summary);
 	}
 }
 
@@ -100,6 +100,14 @@ void ARomanEmpireHUD::UpdateResources(int32 Gold, int32 Food, int32 Iron, int32
 	}
 }
 
+void ARomanEmpireHUD::UpdateIncomeBreakdown(const FFactionIncomeBreakdown& Breakdown)
+{
+	if (MainWidget)
+	{
+		MainWidget->UpdateIncomeDisplay(Breakdown);
+	}
+}
+
 void ARomanEmpireHUD::OnZoomLevelChanged(float ZoomLevel)
 {
 	CurrentZoomLevel = ZoomLevel;
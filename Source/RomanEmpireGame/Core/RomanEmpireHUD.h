@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/HUD.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "RomanEmpireGame/Units/UnitSelection.h"
 #include "RomanEmpireHUD.generated.h"
 
 class URomanEmpireMainWidget;
@@ -42,7 +44,7 @@ public:
 	void ToggleBuildingMenu();
 
 	UFUNCTION(BlueprintCallable, Category = "HUD")
-	void UpdateUnitSelection(const TArray<class AUnitBase*>& SelectedUnits);
+	void UpdateUnitSelection(const FUnitSelectionSummary& Summary);
 
 	UFUNCTION(BlueprintCallable, Category = "HUD")
 	void ShowFPSOverlay(bool bShow);
@@ -50,6 +52,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "HUD")
 	void UpdateResources(int32 Gold, int32 Food, int32 Iron, int32 Wood, int32 Stone, int32 Population);
 
+	UFUNCTION(BlueprintCallable, Category = "HUD")
+	void UpdateIncomeBreakdown(const FFactionIncomeBreakdown& Breakdown);
+
 	// Zoom level based UI
 	UFUNCTION(BlueprintCallable, Category = "HUD")
 	void OnZoomLevelChanged(float ZoomLevel);
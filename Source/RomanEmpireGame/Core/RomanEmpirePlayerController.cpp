@@ -3,11 +3,21 @@
 #include "RomanEmpirePlayerController.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
 #include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Units/UnitCommandBus.h"
+#include "RomanEmpireGame/Units/UnitSelectionRenderer.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "RomanEmpireGame/Core/RomanEmpireHUD.h"
 #include "RomanEmpireGame/Building/BuildingBase.h"
 #include "RomanEmpireGame/Building/BuildingPlacementComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "Kismet/GameplayStatics.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "SceneView.h"
+
+DECLARE_CYCLE_STAT(TEXT("Box Select"), STAT_BoxSelect, STATGROUP_RomanEmpire);
 
 ARomanEmpirePlayerController::ARomanEmpirePlayerController()
 {
@@ -21,6 +31,8 @@ ARomanEmpirePlayerController::ARomanEmpirePlayerController()
 	ZoomSpeed = 2.0f;
 	bIsInFirstPersonMode = false;
 	bIsBoxSelecting = false;
+	bSelectionSummaryDirty = false;
+	CommandFormation = EFormationType::Line;
 	PossessedUnit = nullptr;
 	GameMode = nullptr;
 }
@@ -40,6 +52,10 @@ void ARomanEmpirePlayerController::BeginPlay()
 	
 	// Cache game mode
 	GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+
+	CommandBus = AUnitCommandBus::GetUnitCommandBus(this);
+
+	SelectedUnitUpdatedHandle = AUnitBase::OnSelectedUnitUpdated.AddUObject(this, &ARomanEmpirePlayerController::OnSelectedUnitUpdated);
 	
 	// Create building placement component
 	BuildingPlacementComponent = NewObject<UBuildingPlacementComponent>(this);
@@ -51,6 +67,14 @@ void ARomanEmpirePlayerController::BeginPlay()
 	UE_LOG(LogRomanEmpire, Log, TEXT("Player Controller initialized"));
 }
 
+void ARomanEmpirePlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AUnitBase::OnSelectedUnitUpdated.Remove(SelectedUnitUpdatedHandle);
+	SelectedUnitUpdatedHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ARomanEmpirePlayerController::SetupInputComponent()
 {
 	Super::SetupInputComponent();
@@ -111,6 +135,12 @@ void ARomanEmpirePlayerController::SetupInputComponent()
 			EnhancedInputComponent->BindAction(IA_Block, ETriggerEvent::Started, this, &ARomanEmpirePlayerController::OnBlockPressed);
 			EnhancedInputComponent->BindAction(IA_Block, ETriggerEvent::Completed, this, &ARomanEmpirePlayerController::OnBlockReleased);
 		}
+
+		// Control groups
+		if (IA_ControlGroup)
+		{
+			EnhancedInputComponent->BindAction(IA_ControlGroup, ETriggerEvent::Started, this, &ARomanEmpirePlayerController::OnControlGroupInput);
+		}
 	}
 }
 
@@ -127,43 +157,107 @@ void ARomanEmpirePlayerController::Tick(float DeltaSeconds)
 		GetHitResultUnderCursor(ECC_Visibility, true, HitResult);
 		BuildingPlacementComponent->UpdatePreview(HitResult.Location);
 	}
+
+	if (bSelectionSummaryDirty)
+	{
+		if (ARomanEmpireHUD* RomanHUD = GetHUD<ARomanEmpireHUD>())
+		{
+			RomanHUD->UpdateUnitSelection(Selection.GetSummary());
+		}
+		bSelectionSummaryDirty = false;
+	}
 }
 
 void ARomanEmpirePlayerController::SelectUnit(AUnitBase* Unit)
 {
-	ClearSelection();
+	TArray<AUnitBase*> Units;
 	if (Unit)
 	{
-		SelectedUnits.Add(Unit);
-		Unit->SetSelected(true);
+		Units.Add(Unit);
 		UE_LOG(LogRomanEmpire, Verbose, TEXT("Selected unit: %s"), *Unit->GetName());
 	}
+	SelectUnits(Units);
 }
 
 void ARomanEmpirePlayerController::SelectUnits(const TArray<AUnitBase*>& Units)
 {
-	ClearSelection();
-	for (AUnitBase* Unit : Units)
+	Selection.Select(Units, SelectionDiff);
+	ApplySelectionDiff();
+	UE_LOG(LogRomanEmpire, Verbose, TEXT("Selected %d units"), Selection.Num());
+}
+
+void ARomanEmpirePlayerController::AddToSelection(const TArray<AUnitBase*>& Units)
+{
+	Selection.Add(Units, SelectionDiff);
+	ApplySelectionDiff();
+}
+
+void ARomanEmpirePlayerController::RemoveFromSelection(const TArray<AUnitBase*>& Units)
+{
+	Selection.Remove(Units, SelectionDiff);
+	ApplySelectionDiff();
+}
+
+void ARomanEmpirePlayerController::ClearSelection()
+{
+	Selection.Clear(SelectionDiff);
+	ApplySelectionDiff();
+}
+
+void ARomanEmpirePlayerController::AssignControlGroup(int32 Group, bool bAddToGroup)
+{
+	if (bAddToGroup)
 	{
-		if (Unit)
-		{
-			SelectedUnits.Add(Unit);
-			Unit->SetSelected(true);
-		}
+		Selection.AddSelectionToGroup(Group);
+	}
+	else
+	{
+		Selection.AssignGroup(Group);
 	}
-	UE_LOG(LogRomanEmpire, Verbose, TEXT("Selected %d units"), SelectedUnits.Num());
+	UE_LOG(LogRomanEmpire, Verbose, TEXT("Control group %d has %d units"), Group, Selection.GetGroupSize(Group));
 }
 
-void ARomanEmpirePlayerController::ClearSelection()
+bool ARomanEmpirePlayerController::RecallControlGroup(int32 Group)
+{
+	const bool bChanged = Selection.RecallGroup(Group, SelectionDiff);
+	ApplySelectionDiff();
+	return bChanged;
+}
+
+void ARomanEmpirePlayerController::ApplySelectionDiff()
 {
-	for (AUnitBase* Unit : SelectedUnits)
+	if (SelectionDiff.IsEmpty())
 	{
-		if (Unit)
-		{
-			Unit->SetSelected(false);
-		}
+		return;
+	}
+
+	AUnitSelectionRenderer* Renderer = SelectionRenderer.Get();
+	if (!Renderer)
+	{
+		Renderer = AUnitSelectionRenderer::GetUnitSelectionRenderer(this);
+		SelectionRenderer = Renderer;
+	}
+
+	for (AUnitBase* Unit : SelectionDiff.Removed)
+	{
+		Unit->SetSelectedWithRenderer(false, Renderer);
+	}
+	for (AUnitBase* Unit : SelectionDiff.Added)
+	{
+		Unit->SetSelectedWithRenderer(true, Renderer);
+	}
+
+	SelectionDiff.Reset();
+	bSelectionSummaryDirty = true;
+}
+
+void ARomanEmpirePlayerController::OnSelectedUnitUpdated(AUnitBase* Unit, bool bLeavingPlay)
+{
+	if (Selection.UpdateUnit(Unit, bLeavingPlay, SelectionDiff))
+	{
+		ApplySelectionDiff();
+		bSelectionSummaryDirty = true;
 	}
-	SelectedUnits.Empty();
 }
 
 void ARomanEmpirePlayerController::StartBuildingPlacement(TSubclassOf<ABuildingBase> BuildingClass)
@@ -288,19 +382,36 @@ void ARomanEmpirePlayerController::OnCommandPressed()
 		return;
 	}
 	
-	// Issue movement command to selected units
-	if (SelectedUnits.Num() > 0)
+	const TArray<AUnitBase*>& SelectedUnits = Selection.GetUnits();
+	AUnitCommandBus* Bus = CommandBus.Get();
+	if (SelectedUnits.Num() == 0 || !Bus)
 	{
-		FHitResult HitResult;
-		if (GetHitResultUnderCursor(ECC_Visibility, true, HitResult))
+		return;
+	}
+
+	// One record for the whole selection; shift queues it as a waypoint
+	FHitResult HitResult;
+	if (GetHitResultUnderCursor(ECC_Visibility, true, HitResult))
+	{
+		const AUnitBase* Leader = SelectedUnits[0];
+		AUnitBase* TargetUnit = Cast<AUnitBase>(HitResult.GetActor());
+		bool bHostileTarget = false;
+		if (TargetUnit && TargetUnit->IsAlive() && Leader && TargetUnit->GetOwnerFaction() != Leader->GetOwnerFaction())
+		{
+			// Without diplomacy every other faction is an enemy, as in the simulation; allies and neutrals get a move instead
+			const AFactionManager* FactionManager = GameMode ? GameMode->GetFactionManager() : nullptr;
+			const EDiplomaticStatus Status = FactionManager ? FactionManager->GetDiplomaticStatus(Leader->GetOwnerFaction(), TargetUnit->GetOwnerFaction()) : EDiplomaticStatus::War;
+			bHostileTarget = Status == EDiplomaticStatus::War || Status == EDiplomaticStatus::Hostile;
+		}
+
+		if (bHostileTarget)
 		{
-			for (AUnitBase* Unit : SelectedUnits)
-			{
-				if (Unit)
-				{
-					Unit->CommandMoveTo(HitResult.Location);
-				}
-			}
+			Bus->IssueAttack(SelectedUnits, TargetUnit);
+		}
+		else
+		{
+			const bool bQueue = IsInputKeyDown(EKeys::LeftShift) || IsInputKeyDown(EKeys::RightShift);
+			Bus->IssueMove(SelectedUnits, HitResult.Location, CommandFormation, bQueue);
 		}
 	}
 }
@@ -335,9 +446,9 @@ void ARomanEmpirePlayerController::OnEnterFPSPressed()
 	{
 		ExitFirstPersonMode();
 	}
-	else if (SelectedUnits.Num() > 0)
+	else if (Selection.Num() > 0)
 	{
-		EnterFirstPersonMode(SelectedUnits[0]);
+		EnterFirstPersonMode(Selection.GetUnits()[0]);
 	}
 }
 
@@ -371,6 +482,31 @@ void ARomanEmpirePlayerController::OnBlockReleased()
 	}
 }
 
+void ARomanEmpirePlayerController::OnControlGroupInput(const FInputActionValue& Value)
+{
+	if (bIsInFirstPersonMode)
+	{
+		return;
+	}
+
+	// Keys 1-9 are groups 0-8 and key 0 is group 9, matching the keyboard layout
+	const int32 Group = (FMath::RoundToInt(Value.Get<float>()) + FUnitSelection::NumControlGroups - 1) % FUnitSelection::NumControlGroups;
+
+	// Ctrl assigns the selection to the group, shift adds it, otherwise the group is selected
+	if (IsInputKeyDown(EKeys::LeftControl) || IsInputKeyDown(EKeys::RightControl))
+	{
+		AssignControlGroup(Group, false);
+	}
+	else if (IsInputKeyDown(EKeys::LeftShift) || IsInputKeyDown(EKeys::RightShift))
+	{
+		AssignControlGroup(Group, true);
+	}
+	else
+	{
+		RecallControlGroup(Group);
+	}
+}
+
 void ARomanEmpirePlayerController::UpdateZoom(float DeltaTime)
 {
 	// Smooth zoom interpolation handled by camera component
@@ -378,31 +514,76 @@ void ARomanEmpirePlayerController::UpdateZoom(float DeltaTime)
 
 void ARomanEmpirePlayerController::PerformBoxSelect()
 {
+	SCOPE_CYCLE_COUNTER(STAT_BoxSelect);
+
 	FVector2D CurrentMousePos;
 	GetMousePosition(CurrentMousePos.X, CurrentMousePos.Y);
-	
+
+	// Shift adds to the selection, ctrl removes from it
+	const bool bAdditive = IsInputKeyDown(EKeys::LeftShift) || IsInputKeyDown(EKeys::RightShift);
+	const bool bSubtractive = IsInputKeyDown(EKeys::LeftControl) || IsInputKeyDown(EKeys::RightControl);
+
+	TArray<AUnitBase*> Units;
+
 	// Check if it's a click (small movement) or drag (box select)
 	float Distance = FVector2D::Distance(BoxSelectStart, CurrentMousePos);
 	
-	if (Distance < 10.0f)
+	if (Distance < BoxSelectThreshold)
 	{
 		// Single click selection
-		AActor* HitActor = GetActorUnderCursor();
-		if (AUnitBase* Unit = Cast<AUnitBase>(HitActor))
-		{
-			SelectUnit(Unit);
-		}
-		else
+		if (AUnitBase* Unit = Cast<AUnitBase>(GetActorUnderCursor()))
 		{
-			ClearSelection();
+			Units.Add(Unit);
 		}
 	}
 	else
 	{
-		// Box selection - find all units within the box
-		// TODO: Implement proper screen-space box selection
-		ClearSelection();
+		GetUnitsInScreenBox(BoxSelectStart, CurrentMousePos, Units);
+	}
+
+	if (bSubtractive)
+	{
+		RemoveFromSelection(Units);
+	}
+	else if (bAdditive)
+	{
+		AddToSelection(Units);
+	}
+	else
+	{
+		SelectUnits(Units);
+	}
+}
+
+void ARomanEmpirePlayerController::GetUnitsInScreenBox(const FVector2D& Corner, const FVector2D& OppositeCorner, TArray<AUnitBase*>& OutUnits)
+{
+	// Marquee selection only picks up the player's own units; None would match every faction
+	const AFactionManager* FactionManager = GameMode ? GameMode->GetFactionManager() : nullptr;
+	const EFactionID Faction = FactionManager ? FactionManager->GetPlayerFaction() : EFactionID::None;
+	if (Faction == EFactionID::None)
+	{
+		return;
+	}
+
+	AUnitSimulationManager* Simulation = AUnitSimulationManager::GetUnitSimulationManager(this);
+	const ULocalPlayer* LocalPlayer = GetLocalPlayer();
+	if (!Simulation || !LocalPlayer || !LocalPlayer->ViewportClient)
+	{
+		return;
 	}
+
+	// One view-projection for the whole box, the same one ProjectWorldLocationToScreen would build per call
+	FSceneViewProjectionData ProjectionData;
+	if (!LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, ProjectionData))
+	{
+		return;
+	}
+
+	FBox2D ScreenBox(ForceInit);
+	ScreenBox += Corner;
+	ScreenBox += OppositeCorner;
+
+	Simulation->GetUnitsInScreenRect(ProjectionData.ComputeViewProjectionMatrix(), ProjectionData.GetConstrainedViewRect(), ScreenBox, Faction, OutUnits);
 }
 
 AActor* ARomanEmpirePlayerController::GetActorUnderCursor() const
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
 #include "RomanEmpireGame/Core/RomanEmpireGameMode.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "RomanEmpireGame/Units/UnitSelection.h"
 #include "InputActionValue.h"
 #include "RomanEmpirePlayerController.generated.h"
 
@@ -14,6 +16,8 @@ class AUnitBase;
 class ABuildingBase;
 class UBuildingPlacementComponent;
 class USeamlessZoomCamera;
+class AUnitCommandBus;
+class AUnitSelectionRenderer;
 
 /**
  * Selection mode for the player
@@ -40,6 +44,7 @@ public:
 	ARomanEmpirePlayerController();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void SetupInputComponent() override;
 	virtual void Tick(float DeltaSeconds) override;
 
@@ -50,11 +55,32 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Selection")
 	void SelectUnits(const TArray<AUnitBase*>& Units);
 
+	// Adds units not already selected
+	UFUNCTION(BlueprintCallable, Category = "Selection")
+	void AddToSelection(const TArray<AUnitBase*>& Units);
+
+	UFUNCTION(BlueprintCallable, Category = "Selection")
+	void RemoveFromSelection(const TArray<AUnitBase*>& Units);
+
 	UFUNCTION(BlueprintCallable, Category = "Selection")
 	void ClearSelection();
 
 	UFUNCTION(BlueprintPure, Category = "Selection")
-	TArray<AUnitBase*> GetSelectedUnits() const { return SelectedUnits; }
+	TArray<AUnitBase*> GetSelectedUnits() const { return Selection.GetUnits(); }
+
+	// Counts by unit type and average health, maintained as the selection changes
+	UFUNCTION(BlueprintPure, Category = "Selection")
+	const FUnitSelectionSummary& GetSelectionSummary() const { return Selection.GetSummary(); }
+
+	// Control groups, numbered from 0
+	UFUNCTION(BlueprintCallable, Category = "Selection")
+	void AssignControlGroup(int32 Group, bool bAddToGroup);
+
+	UFUNCTION(BlueprintCallable, Category = "Selection")
+	bool RecallControlGroup(int32 Group);
+
+	UFUNCTION(BlueprintPure, Category = "Selection")
+	int32 GetControlGroupSize(int32 Group) const { return Selection.GetGroupSize(Group); }
 
 	// Building
 	UFUNCTION(BlueprintCallable, Category = "Building")
@@ -112,13 +138,18 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input")
 	UInputAction* IA_Block;
 
-	// Selection state
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Selection")
-	TArray<AUnitBase*> SelectedUnits;
+	// Axis1D action; each number key maps to its digit through a Scalar modifier, with 0 mapped to 10
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input")
+	UInputAction* IA_ControlGroup;
 
+	// Selection state
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Selection")
 	ESelectionMode CurrentSelectionMode;
 
+	// Formation selected units take up when ordered to move
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection")
+	EFormationType CommandFormation;
+
 	// Zoom state
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
 	float CurrentZoomLevel;
@@ -149,16 +180,37 @@ protected:
 	void OnAttackPressed();
 	void OnBlockPressed();
 	void OnBlockReleased();
+	void OnControlGroupInput(const FInputActionValue& Value);
 
 private:
 	// Box selection
 	FVector2D BoxSelectStart;
 	bool bIsBoxSelecting;
 
+	// Drags shorter than this many pixels count as a click
+	static constexpr float BoxSelectThreshold = 10.0f;
+
 	// Cache game mode
 	ARomanEmpireGameMode* GameMode;
 
+	TWeakObjectPtr<AUnitCommandBus> CommandBus;
+
+	// Resolved once and handed to units as they join or leave the selection
+	TWeakObjectPtr<AUnitSelectionRenderer> SelectionRenderer;
+
+	// Selection changes are applied as diffs, so only units that joined or left touch their selection visuals
+	FUnitSelection Selection;
+	FUnitSelectionDiff SelectionDiff;
+	FDelegateHandle SelectedUnitUpdatedHandle;
+
+	// The HUD is refreshed at most once per frame however many selected units were hit
+	bool bSelectionSummaryDirty;
+
+	void ApplySelectionDiff();
+	void OnSelectedUnitUpdated(AUnitBase* Unit, bool bLeavingPlay);
+
 	void UpdateZoom(float DeltaTime);
 	void PerformBoxSelect();
+	void GetUnitsInScreenBox(const FVector2D& Corner, const FVector2D& OppositeCorner, TArray<AUnitBase*>& OutUnits);
 	AActor* GetActorUnderCursor() const;
 };
@@ -0,0 +1,49 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "RomanEmpireWorldSubsystem.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "EngineUtils.h"
+
+AActor* URomanEmpireWorldSubsystem::FindOrSpawnManager(UClass* ManagerClass)
+{
+	if (AActor* Manager = FindManager(ManagerClass))
+	{
+		return Manager;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World || World->bIsTearingDown)
+	{
+		return nullptr;
+	}
+
+	AActor* Spawned = World->SpawnActor(ManagerClass);
+	Managers.Add(ManagerClass, Spawned);
+	return Spawned;
+}
+
+AActor* URomanEmpireWorldSubsystem::FindManager(UClass* ManagerClass)
+{
+	if (const TWeakObjectPtr<AActor>* Cached = Managers.Find(ManagerClass))
+	{
+		if (AActor* Manager = Cached->Get())
+		{
+			return Manager;
+		}
+	}
+
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	// Prefer one placed in the level, which may be a Blueprint subclass carrying assets
+	for (TActorIterator<AActor> It(World, ManagerClass); It; ++It)
+	{
+		Managers.Add(ManagerClass, *It);
+		return *It;
+	}
+
+	return nullptr;
+}
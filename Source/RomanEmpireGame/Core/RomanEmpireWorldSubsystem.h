@@ -0,0 +1,44 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RomanEmpireWorldSubsystem.generated.h"
+
+/**
+ * Remembers the one instance of each world-wide manager actor, so looking one up is a map lookup
+ * instead of a scan of every actor in the world. Managers placed in the level are found once;
+ * otherwise one is spawned on first use.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API URomanEmpireWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Returns the world's manager of type T, spawning one if the level has none
+	template<typename T>
+	static T* FindOrSpawnManager(const UObject* WorldContextObject)
+	{
+		UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+		URomanEmpireWorldSubsystem* Subsystem = World ? World->GetSubsystem<URomanEmpireWorldSubsystem>() : nullptr;
+		return Subsystem ? static_cast<T*>(Subsystem->FindOrSpawnManager(T::StaticClass())) : nullptr;
+	}
+
+	// Returns the world's manager of type T if one exists, without spawning
+	template<typename T>
+	static T* FindManager(const UObject* WorldContextObject)
+	{
+		UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+		URomanEmpireWorldSubsystem* Subsystem = World ? World->GetSubsystem<URomanEmpireWorldSubsystem>() : nullptr;
+		return Subsystem ? static_cast<T*>(Subsystem->FindManager(T::StaticClass())) : nullptr;
+	}
+
+	AActor* FindOrSpawnManager(UClass* ManagerClass);
+	AActor* FindManager(UClass* ManagerClass);
+
+private:
+	TMap<UClass*, TWeakObjectPtr<AActor>> Managers;
+};
@@ -80,6 +80,10 @@ struct FFactionInfo
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Faction|Bonuses")
 	float EconomyBonus;
 
+	// Scales how fast units steady themselves and divides the morale they lose
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Faction|Bonuses")
+	float MoraleBonus;
+
 	// Unique units available to this faction
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Faction|Units")
 	TArray<FName> UniqueUnitTypes;
@@ -95,17 +99,21 @@ struct FFactionInfo
 		, InfantryBonus(1.0f)
 		, CavalryBonus(1.0f)
 		, EconomyBonus(1.0f)
+		, MoraleBonus(1.0f)
 	{}
 };
 
 /**
  * Resources owned by a faction
+ * The six resource fields are laid out contiguously and padded to eight int32 lanes,
+ * so arithmetic and comparisons run as two 4-wide integer vector operations
  */
 USTRUCT(BlueprintType)
 struct FFactionResources
 {
 	GENERATED_BODY()
 
+	// Lanes 0-3
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Resources")
 	int32 Gold;
 
@@ -118,12 +126,16 @@ struct FFactionResources
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Resources")
 	int32 Wood;
 
+	// Lanes 4-7
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Resources")
 	int32 Stone;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Resources")
 	int32 Population;
 
+	// Padding lanes, always zero so they never affect sums or comparisons
+	int32 LanePadding[2];
+
 	FFactionResources()
 		: Gold(1000)
 		, Food(500)
@@ -131,26 +143,146 @@ struct FFactionResources
 		, Wood(300)
 		, Stone(200)
 		, Population(100)
+		, LanePadding{0, 0}
 	{}
 
+	// All-zero resources, used as the starting point for sums and deltas
+	static FFactionResources MakeEmpty()
+	{
+		FFactionResources Empty;
+		Empty.StoreLanes(MakeVectorRegisterInt(0, 0, 0, 0), MakeVectorRegisterInt(0, 0, 0, 0));
+		return Empty;
+	}
+
 	bool CanAfford(const FFactionResources& Cost) const
 	{
-		return Gold >= Cost.Gold &&
-			   Food >= Cost.Food &&
-			   Iron >= Cost.Iron &&
-			   Wood >= Cost.Wood &&
-			   Stone >= Cost.Stone &&
-			   Population >= Cost.Population;
+		// Any lane where we hold less than the cost sets a mask bit
+		VectorRegister4Int ShortLow = VectorIntCompareLT(LoadLowLanes(), Cost.LoadLowLanes());
+		VectorRegister4Int ShortHigh = VectorIntCompareLT(LoadHighLanes(), Cost.LoadHighLanes());
+		return VectorMaskBits(VectorCastIntToFloat(VectorIntOr(ShortLow, ShortHigh))) == 0;
 	}
 
 	void Deduct(const FFactionResources& Cost)
 	{
-		Gold -= Cost.Gold;
-		Food -= Cost.Food;
-		Iron -= Cost.Iron;
-		Wood -= Cost.Wood;
-		Stone -= Cost.Stone;
-		Population -= Cost.Population;
+		StoreLanes(
+			VectorIntSubtract(LoadLowLanes(), Cost.LoadLowLanes()),
+			VectorIntSubtract(LoadHighLanes(), Cost.LoadHighLanes()));
+	}
+
+	void Add(const FFactionResources& Delta)
+	{
+		StoreLanes(
+			VectorIntAdd(LoadLowLanes(), Delta.LoadLowLanes()),
+			VectorIntAdd(LoadHighLanes(), Delta.LoadHighLanes()));
+	}
+
+	void AddResource(EResourceType Type, int32 Amount)
+	{
+		switch (Type)
+		{
+			case EResourceType::Gold:		Gold += Amount; break;
+			case EResourceType::Food:		Food += Amount; break;
+			case EResourceType::Iron:		Iron += Amount; break;
+			case EResourceType::Wood:		Wood += Amount; break;
+			case EResourceType::Stone:		Stone += Amount; break;
+			case EResourceType::Population:	Population += Amount; break;
+		}
+	}
+
+	// Batch operations
+
+	// Sums many entries (e.g. territory contributions) keeping the accumulator in registers
+	static FFactionResources Sum(TArrayView<const FFactionResources> Entries)
+	{
+		VectorRegister4Int AccumLow = MakeVectorRegisterInt(0, 0, 0, 0);
+		VectorRegister4Int AccumHigh = MakeVectorRegisterInt(0, 0, 0, 0);
+
+		for (const FFactionResources& Entry : Entries)
+		{
+			AccumLow = VectorIntAdd(AccumLow, Entry.LoadLowLanes());
+			AccumHigh = VectorIntAdd(AccumHigh, Entry.LoadHighLanes());
+		}
+
+		FFactionResources Result;
+		Result.StoreLanes(AccumLow, AccumHigh);
+		return Result;
+	}
+
+	// Tests every cost against this pool, sets one flag per cost and returns how many are affordable
+	int32 CanAffordEach(TArrayView<const FFactionResources> Costs, TBitArray<>& OutAffordable) const
+	{
+		const VectorRegister4Int PoolLow = LoadLowLanes();
+		const VectorRegister4Int PoolHigh = LoadHighLanes();
+
+		OutAffordable.Init(false, Costs.Num());
+		int32 AffordableCount = 0;
+
+		for (int32 Index = 0; Index < Costs.Num(); ++Index)
+		{
+			VectorRegister4Int ShortLow = VectorIntCompareLT(PoolLow, Costs[Index].LoadLowLanes());
+			VectorRegister4Int ShortHigh = VectorIntCompareLT(PoolHigh, Costs[Index].LoadHighLanes());
+			const bool bAffordable = VectorMaskBits(VectorCastIntToFloat(VectorIntOr(ShortLow, ShortHigh))) == 0;
+
+			OutAffordable[Index] = bAffordable;
+			AffordableCount += bAffordable ? 1 : 0;
+		}
+
+		return AffordableCount;
+	}
+
+private:
+	FORCEINLINE VectorRegister4Int LoadLowLanes() const { return VectorIntLoad(&Gold); }
+	FORCEINLINE VectorRegister4Int LoadHighLanes() const { return VectorIntLoad(&Stone); }
+
+	FORCEINLINE void StoreLanes(const VectorRegister4Int& Low, const VectorRegister4Int& High)
+	{
+		VectorIntStore(Low, &Gold);
+		VectorIntStore(High, &Stone);
+	}
+};
+
+// The vector loads above rely on the resource fields being contiguous
+static_assert(STRUCT_OFFSET(FFactionResources, Wood) == STRUCT_OFFSET(FFactionResources, Gold) + 3 * sizeof(int32), "FFactionResources low lanes must be contiguous");
+static_assert(STRUCT_OFFSET(FFactionResources, Stone) == STRUCT_OFFSET(FFactionResources, Gold) + 4 * sizeof(int32), "FFactionResources high lanes must follow the low lanes");
+static_assert(sizeof(FFactionResources) == 8 * sizeof(int32), "FFactionResources must be exactly eight int32 lanes");
+
+/**
+ * Per-turn income and expense breakdown of a faction
+ * Maintained by the faction manager's production ledger so the HUD can read it without scanning territories
+ */
+USTRUCT(BlueprintType)
+struct FFactionIncomeBreakdown
+{
+	GENERATED_BODY()
+
+	// Sum of cached territory contributions (settlements and buildings included)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Resources")
+	FFactionResources TerritoryIncome;
+
+	// Income from the trade network's cached routes
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Resources")
+	FFactionResources TradeIncome;
+
+	// Resources spent through the faction manager since the last turn
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Resources")
+	FFactionResources Expenses;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Resources")
+	int32 ContributingTerritories;
+
+	FFactionIncomeBreakdown()
+		: TerritoryIncome(FFactionResources::MakeEmpty())
+		, TradeIncome(FFactionResources::MakeEmpty())
+		, Expenses(FFactionResources::MakeEmpty())
+		, ContributingTerritories(0)
+	{}
+
+	FFactionResources GetNetIncome() const
+	{
+		FFactionResources Net = TerritoryIncome;
+		Net.Add(TradeIncome);
+		Net.Deduct(Expenses);
+		return Net;
 	}
 };
 
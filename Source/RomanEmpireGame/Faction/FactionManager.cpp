@@ -2,6 +2,7 @@
 
 #include "FactionManager.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/World/TerritoryRegion.h"
 
 AFactionManager::AFactionManager()
 {
@@ -31,6 +32,7 @@ void AFactionManager::InitializeDefaultFactions()
 	Rome.InfantryBonus = 1.2f;
 	Rome.CavalryBonus = 1.0f;
 	Rome.EconomyBonus = 1.1f;
+	Rome.MoraleBonus = 1.2f;
 	Rome.UniqueUnitTypes.Add(TEXT("Legionary"));
 	Rome.UniqueUnitTypes.Add(TEXT("Praetorian"));
 	Rome.UniqueBuildingTypes.Add(TEXT("Colosseum"));
@@ -45,6 +47,7 @@ void AFactionManager::InitializeDefaultFactions()
 	Carthage.InfantryBonus = 0.9f;
 	Carthage.CavalryBonus = 1.1f;
 	Carthage.EconomyBonus = 1.3f;
+	Carthage.MoraleBonus = 0.9f;
 	Carthage.UniqueUnitTypes.Add(TEXT("WarElephant"));
 	Carthage.UniqueUnitTypes.Add(TEXT("SacredBand"));
 	Carthage.UniqueBuildingTypes.Add(TEXT("TradePort"));
@@ -59,6 +62,7 @@ void AFactionManager::InitializeDefaultFactions()
 	Gaul.InfantryBonus = 1.1f;
 	Gaul.CavalryBonus = 1.2f;
 	Gaul.EconomyBonus = 0.9f;
+	Gaul.MoraleBonus = 1.1f;
 	Gaul.UniqueUnitTypes.Add(TEXT("NakedFanatic"));
 	Gaul.UniqueUnitTypes.Add(TEXT("NobleCavalry"));
 	Gaul.UniqueBuildingTypes.Add(TEXT("SacredGrove"));
@@ -129,12 +133,7 @@ void AFactionManager::ModifyFactionResources(EFactionID FactionID, const FFactio
 {
 	if (FFactionResources* Resources = FactionResourcesMap.Find(FactionID))
 	{
-		Resources->Gold += Delta.Gold;
-		Resources->Food += Delta.Food;
-		Resources->Iron += Delta.Iron;
-		Resources->Wood += Delta.Wood;
-		Resources->Stone += Delta.Stone;
-		Resources->Population += Delta.Population;
+		Resources->Add(Delta);
 	}
 }
 
@@ -147,6 +146,17 @@ bool AFactionManager::CanFactionAfford(EFactionID FactionID, const FFactionResou
 	return false;
 }
 
+int32 AFactionManager::CanFactionAffordEach(EFactionID FactionID, TArrayView<const FFactionResources> Costs, TBitArray<>& OutAffordable) const
+{
+	if (const FFactionResources* Resources = FactionResourcesMap.Find(FactionID))
+	{
+		return Resources->CanAffordEach(Costs, OutAffordable);
+	}
+
+	OutAffordable.Init(false, Costs.Num());
+	return 0;
+}
+
 bool AFactionManager::DeductFactionResources(EFactionID FactionID, const FFactionResources& Cost)
 {
 	if (FFactionResources* Resources = FactionResourcesMap.Find(FactionID))
@@ -154,6 +164,7 @@ bool AFactionManager::DeductFactionResources(EFactionID FactionID, const FFactio
 		if (Resources->CanAfford(Cost))
 		{
 			Resources->Deduct(Cost);
+			FactionIncomeMap.FindOrAdd(FactionID).Expenses.Add(Cost);
 			return true;
 		}
 	}
@@ -231,6 +242,76 @@ int32 AFactionManager::GetFactionTerritoryCount(EFactionID FactionID) const
 	return Count;
 }
 
+void AFactionManager::RefreshTerritoryContribution(ATerritoryRegion* Territory)
+{
+	if (!Territory)
+	{
+		return;
+	}
+
+	const FName TerritoryID = Territory->GetTerritoryID();
+	FTerritoryLedgerEntry& Entry = TerritoryLedger.FindOrAdd(Territory);
+
+	// Take the stale contribution out of the previous owner's cached sum
+	if (Entry.Owner != EFactionID::None)
+	{
+		FFactionIncomeBreakdown& OldIncome = FactionIncomeMap.FindOrAdd(Entry.Owner);
+		OldIncome.TerritoryIncome.Deduct(Entry.Contribution);
+		OldIncome.ContributingTerritories--;
+	}
+
+	Entry.Owner = Territory->GetOwnerFaction();
+	Entry.Contribution = Territory->CalculateTurnProduction();
+
+	if (Entry.Owner != EFactionID::None)
+	{
+		FFactionIncomeBreakdown& NewIncome = FactionIncomeMap.FindOrAdd(Entry.Owner);
+		NewIncome.TerritoryIncome.Add(Entry.Contribution);
+		NewIncome.ContributingTerritories++;
+	}
+
+	AssignTerritoryToFaction(TerritoryID, Entry.Owner);
+}
+
+void AFactionManager::SetTradeIncome(EFactionID FactionID, const FFactionResources& Income)
+{
+	if (FactionID != EFactionID::None)
+	{
+		FactionIncomeMap.FindOrAdd(FactionID).TradeIncome = Income;
+	}
+}
+
+FFactionIncomeBreakdown AFactionManager::GetFactionIncome(EFactionID FactionID) const
+{
+	if (const FFactionIncomeBreakdown* Income = FactionIncomeMap.Find(FactionID))
+	{
+		return *Income;
+	}
+	return FFactionIncomeBreakdown();
+}
+
+FFactionIncomeBreakdown AFactionManager::GetLastTurnIncome(EFactionID FactionID) const
+{
+	if (const FFactionIncomeBreakdown* Income = LastTurnIncomeMap.Find(FactionID))
+	{
+		return *Income;
+	}
+	return FFactionIncomeBreakdown();
+}
+
+void AFactionManager::ApplyTurnIncome()
+{
+	for (auto& Pair : FactionIncomeMap)
+	{
+		ModifyFactionResources(Pair.Key, Pair.Value.TerritoryIncome);
+		ModifyFactionResources(Pair.Key, Pair.Value.TradeIncome);
+
+		// Snapshot for the HUD, then start a fresh expense record for the next turn
+		LastTurnIncomeMap.Add(Pair.Key, Pair.Value);
+		Pair.Value.Expenses = FFactionResources::MakeEmpty();
+	}
+}
+
 void AFactionManager::ProcessAITurns()
 {
 	for (const auto& Pair : FactionInfoMap)
@@ -7,6 +7,8 @@
 #include "RomanEmpireGame/Faction/FactionData.h"
 #include "FactionManager.generated.h"
 
+class ATerritoryRegion;
+
 /**
  * Manages all factions in the game
  * Handles faction initialization, resources, diplomacy, and AI behavior
@@ -25,6 +27,8 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Faction")
 	FFactionInfo GetFactionInfo(EFactionID FactionID) const;
 
+	const FFactionInfo* FindFactionInfo(EFactionID FactionID) const { return FactionInfoMap.Find(FactionID); }
+
 	UFUNCTION(BlueprintPure, Category = "Faction")
 	FFactionResources GetFactionResources(EFactionID FactionID) const;
 
@@ -37,6 +41,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faction")
 	bool DeductFactionResources(EFactionID FactionID, const FFactionResources& Cost);
 
+	// Batch affordability test for AI planning, returns how many of the costs are affordable
+	int32 CanFactionAffordEach(EFactionID FactionID, TArrayView<const FFactionResources> Costs, TBitArray<>& OutAffordable) const;
+
 	// Diplomacy
 	UFUNCTION(BlueprintPure, Category = "Faction|Diplomacy")
 	EDiplomaticStatus GetDiplomaticStatus(EFactionID Faction1, EFactionID Faction2) const;
@@ -64,6 +71,22 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Faction|Territory")
 	int32 GetFactionTerritoryCount(EFactionID FactionID) const;
 
+	// Production ledger
+	UFUNCTION(BlueprintCallable, Category = "Faction|Economy")
+	void RefreshTerritoryContribution(ATerritoryRegion* Territory);
+
+	UFUNCTION(BlueprintCallable, Category = "Faction|Economy")
+	void SetTradeIncome(EFactionID FactionID, const FFactionResources& Income);
+
+	UFUNCTION(BlueprintPure, Category = "Faction|Economy")
+	FFactionIncomeBreakdown GetFactionIncome(EFactionID FactionID) const;
+
+	UFUNCTION(BlueprintPure, Category = "Faction|Economy")
+	FFactionIncomeBreakdown GetLastTurnIncome(EFactionID FactionID) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Faction|Economy")
+	void ApplyTurnIncome();
+
 	// AI turn processing
 	UFUNCTION(BlueprintCallable, Category = "Faction|AI")
 	void ProcessAITurns();
@@ -88,7 +111,26 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Faction")
 	EFactionID PlayerFaction;
 
+	// Running income/expense ledger for the current turn
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Faction|Economy")
+	TMap<EFactionID, FFactionIncomeBreakdown> FactionIncomeMap;
+
+	// Snapshot of the ledger taken when the last turn's income was applied
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Faction|Economy")
+	TMap<EFactionID, FFactionIncomeBreakdown> LastTurnIncomeMap;
+
 private:
+	// Cached contribution of a single territory to its owner's income
+	struct FTerritoryLedgerEntry
+	{
+		EFactionID Owner = EFactionID::None;
+		FFactionResources Contribution = FFactionResources::MakeEmpty();
+	};
+
+	// Keyed by territory rather than ID so a duplicate or missing ID cannot merge two ledger entries
+	TMap<const ATerritoryRegion*, FTerritoryLedgerEntry> TerritoryLedger;
+
+
 	void InitializeDefaultFactions();
 	void InitializeDefaultDiplomacy();
 	void ProcessAIFactionTurn(EFactionID FactionID);
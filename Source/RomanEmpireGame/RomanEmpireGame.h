@@ -3,9 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogRomanEmpire, Log, All);
 
+// Profiling group for game systems ("stat RomanEmpire")
+DECLARE_STATS_GROUP(TEXT("RomanEmpire"), STATGROUP_RomanEmpire, STATCAT_Advanced);
+
 // Game-wide constants
 namespace RomanEmpireConstants
 {
@@ -2,10 +2,14 @@
 
 #include "BuildingMenuWidget.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Core/RomanEmpireGameMode.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
 #include "Components/VerticalBox.h"
 #include "Components/Button.h"
 #include "Components/Image.h"
 #include "Components/TextBlock.h"
+#include "Kismet/GameplayStatics.h"
 
 void UBuildingMenuWidget::NativeConstruct()
 {
@@ -99,6 +103,43 @@ void UBuildingMenuWidget::PopulateBuildingList()
 
 	// Set initial visibility
 	FilterByCategory(EBuildingCategory::Military);
+
+	RefreshAffordability();
+}
+
+void UBuildingMenuWidget::RefreshAffordability()
+{
+	AffordableBuildings.Reset();
+
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	const AFactionManager* FactionManager = GameMode ? GameMode->GetFactionManager() : nullptr;
+	if (!FactionManager)
+	{
+		return;
+	}
+
+	TArray<EBuildingType> Types;
+	TArray<FFactionResources> Costs;
+	Types.Reserve(BuildingClasses.Num());
+	Costs.Reserve(BuildingClasses.Num());
+	for (const TPair<EBuildingType, TSubclassOf<ABuildingBase>>& Entry : BuildingClasses)
+	{
+		if (Entry.Value)
+		{
+			Types.Add(Entry.Key);
+			Costs.Add(Entry.Value->GetDefaultObject<ABuildingBase>()->GetBuildingDataRef().Cost);
+		}
+	}
+
+	TBitArray<> Affordable;
+	FactionManager->CanFactionAffordEach(FactionManager->GetPlayerFaction(), Costs, Affordable);
+	for (int32 Index = 0; Index < Types.Num(); ++Index)
+	{
+		if (Affordable[Index])
+		{
+			AffordableBuildings.Add(Types[Index]);
+		}
+	}
 }
 
 void UBuildingMenuWidget::FilterByCategory(EBuildingCategory Category)
@@ -39,6 +39,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Building Menu")
 	void ShowAllBuildings();
 
+	// Re-tests every building in BuildingClasses against the player's resources in one batch
+	UFUNCTION(BlueprintCallable, Category = "Building Menu")
+	void RefreshAffordability();
+
+	UFUNCTION(BlueprintPure, Category = "Building Menu")
+	bool IsBuildingAffordable(EBuildingType BuildingType) const { return AffordableBuildings.Contains(BuildingType); }
+
 	// Event when building is selected
 	UPROPERTY(BlueprintAssignable, Category = "Building Menu")
 	FOnBuildingSelected OnBuildingSelected;
@@ -82,6 +89,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building Menu")
 	EBuildingCategory CurrentCategory;
 
+	// Buildings the player could pay for at the last refresh
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Building Menu")
+	TSet<EBuildingType> AffordableBuildings;
+
 	UFUNCTION()
 	void OnMilitaryTabClicked();
 
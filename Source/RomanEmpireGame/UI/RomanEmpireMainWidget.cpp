@@ -2,7 +2,7 @@
 
 #include "RomanEmpireMainWidget.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
-#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Units/UnitTypeRegistry.h"
 #include "Components/CanvasPanel.h"
 #include "Components/HorizontalBox.h"
 #include "Components/VerticalBox.h"
@@ -51,14 +51,14 @@ void URomanEmpireMainWidget::HideBuildingMenu()
 	}
 }
 
-void URomanEmpireMainWidget::UpdateUnitPanel(const TArray<AUnitBase*>& SelectedUnits)
+void URomanEmpireMainWidget::UpdateUnitPanel(const FUnitSelectionSummary& Summary)
 {
 	if (!UnitPanel)
 	{
 		return;
 	}
 
-	if (SelectedUnits.Num() == 0)
+	if (Summary.NumUnits == 0)
 	{
 		UnitPanel->SetVisibility(ESlateVisibility::Collapsed);
 		return;
@@ -66,20 +66,25 @@ void URomanEmpireMainWidget::UpdateUnitPanel(const TArray<AUnitBase*>& SelectedU
 
 	UnitPanel->SetVisibility(ESlateVisibility::Visible);
 
-	// Show first selected unit's info
-	AUnitBase* FirstUnit = SelectedUnits[0];
-	if (FirstUnit)
+	if (UnitNameText)
 	{
-		if (UnitNameText)
+		// Name the type when the selection has only one, otherwise just count
+		if (Summary.UnitTypeCounts.Num() == 1)
 		{
-			UnitNameText->SetText(FirstUnit->GetUnitData().DisplayName);
+			const FText& TypeName = FUnitTypeRegistry::Get().GetUnitData(Summary.UnitTypeCounts.CreateConstIterator()->Key).DisplayName;
+			UnitNameText->SetText(Summary.NumUnits == 1 ? TypeName
+				: FText::Format(FText::FromString(TEXT("{0} x{1}")), TypeName, FText::AsNumber(Summary.NumUnits)));
 		}
-
-		if (UnitHealthBar)
+		else
 		{
-			UnitHealthBar->SetPercent(FirstUnit->GetHealthPercent());
+			UnitNameText->SetText(FText::Format(FText::FromString(TEXT("{0} units")), FText::AsNumber(Summary.NumUnits)));
 		}
 	}
+
+	if (UnitHealthBar)
+	{
+		UnitHealthBar->SetPercent(Summary.AverageHealthPercent);
+	}
 }
 
 void URomanEmpireMainWidget::UpdateResourceDisplay(int32 Gold, int32 Food, int32 Iron, int32 Wood, int32 Stone, int32 Population)
@@ -110,6 +115,20 @@ void URomanEmpireMainWidget::UpdateResourceDisplay(int32 Gold, int32 Food, int32
 	}
 }
 
+void URomanEmpireMainWidget::UpdateIncomeDisplay(const FFactionIncomeBreakdown& Breakdown)
+{
+	FFactionResources Net = Breakdown.GetNetIncome();
+
+	if (GoldIncomeText)
+	{
+		GoldIncomeText->SetText(FText::FromString(FString::Printf(TEXT("%+d"), Net.Gold)));
+	}
+	if (FoodIncomeText)
+	{
+		FoodIncomeText->SetText(FText::FromString(FString::Printf(TEXT("%+d"), Net.Food)));
+	}
+}
+
 void URomanEmpireMainWidget::SetFPSMode(bool bEnabled)
 {
 	bFPSModeActive = bEnabled;
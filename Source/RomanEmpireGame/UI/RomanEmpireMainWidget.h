@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "RomanEmpireGame/Units/UnitSelection.h"
 #include "RomanEmpireMainWidget.generated.h"
 
 class UCanvasPanel;
@@ -37,12 +39,15 @@ public:
 
 	// Unit panel
 	UFUNCTION(BlueprintCallable, Category = "UI")
-	void UpdateUnitPanel(const TArray<AUnitBase*>& SelectedUnits);
+	void UpdateUnitPanel(const FUnitSelectionSummary& Summary);
 
 	// Resources
 	UFUNCTION(BlueprintCallable, Category = "UI")
 	void UpdateResourceDisplay(int32 Gold, int32 Food, int32 Iron, int32 Wood, int32 Stone, int32 Population);
 
+	UFUNCTION(BlueprintCallable, Category = "UI")
+	void UpdateIncomeDisplay(const FFactionIncomeBreakdown& Breakdown);
+
 	// FPS mode
 	UFUNCTION(BlueprintCallable, Category = "UI")
 	void SetFPSMode(bool bEnabled);
@@ -88,6 +93,13 @@ protected:
 	UPROPERTY(meta = (BindWidgetOptional), BlueprintReadOnly, Category = "UI|Resources")
 	UTextBlock* PopulationText;
 
+	// Per-turn net income (income minus expenses)
+	UPROPERTY(meta = (BindWidgetOptional), BlueprintReadOnly, Category = "UI|Resources")
+	UTextBlock* GoldIncomeText;
+
+	UPROPERTY(meta = (BindWidgetOptional), BlueprintReadOnly, Category = "UI|Resources")
+	UTextBlock* FoodIncomeText;
+
 	// Building menu (left side)
 	UPROPERTY(meta = (BindWidgetOptional), BlueprintReadOnly, Category = "UI|Building")
 	UVerticalBox* BuildingMenuPanel;
@@ -0,0 +1,257 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "AreaDamageService.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Area Damage"), STAT_AreaDamage, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Hits"), STAT_AreaDamageHits, STATGROUP_RomanEmpire);
+
+AAreaDamageService::AAreaDamageService()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Picks up impacts queued during the frame once everything has moved
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	FriendlyFireScale = 0.25f;
+	NeutralDamageScale = 0.5f;
+	StructureDamageScale = 2.0f;
+}
+
+void AAreaDamageService::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	FlushImpacts();
+}
+
+void AAreaDamageService::ApplyAreaDamage(const FVector& Location, float Radius, float Damage, float Falloff, EFactionID Faction, AActor* Instigator)
+{
+	if (Radius <= 0.0f || Damage <= 0.0f)
+	{
+		return;
+	}
+
+	FImpact& Impact = Impacts.AddDefaulted_GetRef();
+	Impact.Location = Location;
+	Impact.Radius = Radius;
+	Impact.Damage = Damage;
+	Impact.Falloff = FMath::Clamp(Falloff, 0.0f, 1.0f);
+	Impact.Faction = Faction;
+	Impact.Instigator = Instigator;
+}
+
+void AAreaDamageService::FlushImpacts()
+{
+	if (Impacts.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_AreaDamage);
+
+	// Damage events may queue further impacts; those wait for the next flush
+	Swap(Impacts, FlushingImpacts);
+	Impacts.Reset();
+
+	if (!Simulation.IsValid())
+	{
+		Simulation = AUnitSimulationManager::GetUnitSimulationManager(this);
+	}
+
+	if (AUnitSimulationManager* Sim = Simulation.Get())
+	{
+		GatherUnits(*Sim);
+		ComputeDamage();
+		ApplyToUnits(*Sim);
+		ApplyToBuildings(*Sim);
+	}
+
+	FlushingImpacts.Reset();
+}
+
+float AAreaDamageService::GetDiplomacyScale(const AUnitSimulationManager& Sim, EFactionID Attacker, EFactionID Target) const
+{
+	const FFactionRelationCache& Relations = Sim.GetFactionRelations();
+	if (Relations.AreHostile(Attacker, Target))
+	{
+		return 1.0f;
+	}
+	return Relations.AreFriendly(Attacker, Target) ? FriendlyFireScale : NeutralDamageScale;
+}
+
+void AAreaDamageService::GatherUnits(const AUnitSimulationManager& Sim)
+{
+	const FUnitSimulationData& Data = Sim.GetData();
+	const FUnitSpatialGrid& Grid = Sim.GetSpatialGrid();
+
+	PairTargets.Reset();
+	PairImpacts.Reset();
+	PairDistancesSquared.Reset();
+	PairBaseDamages.Reset();
+	PairFalloffs.Reset();
+
+	for (int32 ImpactIndex = 0; ImpactIndex < FlushingImpacts.Num(); ++ImpactIndex)
+	{
+		const FImpact& Impact = FlushingImpacts[ImpactIndex];
+
+		// Diplomacy only varies by faction, so resolve it once per impact rather than per unit
+		float FactionScales[FFactionRelationCache::MaxFactions];
+		for (int32 Faction = 0; Faction < FFactionRelationCache::MaxFactions; ++Faction)
+		{
+			FactionScales[Faction] = GetDiplomacyScale(Sim, Impact.Faction, static_cast<EFactionID>(Faction));
+		}
+
+		const float FalloffPerUnit = Impact.Falloff / Impact.Radius;
+
+		Grid.ForEachInRadius(FVector2D(Impact.Location), Impact.Radius, [&](int32 Unit, float DistanceSquared)
+		{
+			const float Scale = FactionScales[static_cast<uint8>(Data.Factions[Unit]) & (FFactionRelationCache::MaxFactions - 1)];
+			if (Scale <= 0.0f
+				|| EnumHasAnyFlags(Data.Flags[Unit], EUnitSimFlags::PendingRemoval)
+				|| FMath::Abs(Data.Positions[Unit].Z - Impact.Location.Z) > Impact.Radius + Data.HalfHeights[Unit])
+			{
+				return;
+			}
+
+			PairTargets.Add(Unit);
+			PairImpacts.Add(ImpactIndex);
+			PairDistancesSquared.Add(DistanceSquared);
+			PairBaseDamages.Add(Impact.Damage * Scale);
+			PairFalloffs.Add(FalloffPerUnit);
+		});
+	}
+
+	NumPairs = PairTargets.Num();
+
+	// Zero damage padding lets the vector pass run whole lanes
+	const int32 Padded = Align(NumPairs, 4);
+	PairDistancesSquared.SetNumZeroed(Padded);
+	PairBaseDamages.SetNumZeroed(Padded);
+	PairFalloffs.SetNumZeroed(Padded);
+	PairDamages.SetNumUninitialized(Padded);
+}
+
+void AAreaDamageService::ComputeDamage()
+{
+	const VectorRegister4Float Zero = VectorSetFloat1(0.0f);
+	const VectorRegister4Float One = VectorSetFloat1(1.0f);
+
+	const float* DistanceData = PairDistancesSquared.GetData();
+	const float* BaseData = PairBaseDamages.GetData();
+	const float* FalloffData = PairFalloffs.GetData();
+	float* DamageData = PairDamages.GetData();
+
+	for (int32 Base = 0; Base < NumPairs; Base += 4)
+	{
+		const VectorRegister4Float Distance = VectorSqrt(VectorLoad(DistanceData + Base));
+
+		// Linear falloff from the centre, never below zero
+		const VectorRegister4Float Factor = VectorMax(VectorSubtract(One, VectorMultiply(VectorLoad(FalloffData + Base), Distance)), Zero);
+		VectorStore(VectorMultiply(VectorLoad(BaseData + Base), Factor), DamageData + Base);
+	}
+}
+
+void AAreaDamageService::ApplyToUnits(AUnitSimulationManager& Sim)
+{
+	const int32 NumUnits = Sim.GetNumUnits();
+	if (UnitDamage.Num() < NumUnits)
+	{
+		UnitDamage.SetNumZeroed(NumUnits);
+		UnitInstigatorImpacts.SetNumUninitialized(NumUnits);
+	}
+
+	// Sum every hit on a unit so armour and death are resolved once per unit
+	DamagedUnits.Reset();
+	for (int32 Pair = 0; Pair < NumPairs; ++Pair)
+	{
+		if (PairDamages[Pair] <= 0.0f)
+		{
+			continue;
+		}
+
+		const int32 Unit = PairTargets[Pair];
+		if (UnitDamage[Unit] == 0.0f)
+		{
+			DamagedUnits.Add(Unit);
+			UnitInstigatorImpacts[Unit] = PairImpacts[Pair];
+		}
+		UnitDamage[Unit] += PairDamages[Pair];
+	}
+
+	SET_DWORD_STAT(STAT_AreaDamageHits, DamagedUnits.Num());
+
+	for (const int32 Unit : DamagedUnits)
+	{
+		const float Damage = UnitDamage[Unit];
+		UnitDamage[Unit] = 0.0f;
+
+		if (AUnitBase* Target = Sim.GetUnit(Unit))
+		{
+			Target->TakeCombatDamage(Damage, FlushingImpacts[UnitInstigatorImpacts[Unit]].Instigator.Get(), true);
+		}
+	}
+}
+
+void AAreaDamageService::ApplyToBuildings(AUnitSimulationManager& Sim)
+{
+	const FUnitSpatialGrid& ObstacleGrid = Sim.GetObstacleGrid();
+	if (ObstacleGrid.Num() == 0)
+	{
+		return;
+	}
+
+	// Few buildings sit under any volley; collect them first because a destroyed building reshuffles the obstacle list
+	TArray<TPair<ABuildingBase*, float>, TInlineAllocator<16>> Hits;
+	TArray<AActor*, TInlineAllocator<16>> HitInstigators;
+
+	for (const FImpact& Impact : FlushingImpacts)
+	{
+		ObstacleGrid.ForEachInRadius(FVector2D(Impact.Location), Impact.Radius + Sim.GetMaxObstacleRadius(), [&](int32 Obstacle, float DistanceSquared)
+		{
+			ABuildingBase* Building = Cast<ABuildingBase>(Sim.GetObstacleOwner(Obstacle));
+			if (!Building)
+			{
+				return;
+			}
+
+			// Measured to the building's edge, so large structures are not spared by their size
+			const float EdgeDistance = FMath::Max(0.0f, FMath::Sqrt(DistanceSquared) - Sim.GetObstacleRadius(Obstacle));
+			if (EdgeDistance > Impact.Radius)
+			{
+				return;
+			}
+
+			const float Scale = GetDiplomacyScale(Sim, Impact.Faction, Building->GetOwnerFaction());
+			const float Damage = Impact.Damage * Scale * StructureDamageScale * (1.0f - Impact.Falloff * EdgeDistance / Impact.Radius);
+			if (Damage <= 0.0f)
+			{
+				return;
+			}
+
+			const int32 Existing = Hits.IndexOfByPredicate([Building](const TPair<ABuildingBase*, float>& Hit) { return Hit.Key == Building; });
+			if (Existing != INDEX_NONE)
+			{
+				Hits[Existing].Value += Damage;
+			}
+			else
+			{
+				Hits.Emplace(Building, Damage);
+				HitInstigators.Add(Impact.Instigator.Get());
+			}
+		});
+	}
+
+	for (int32 Index = 0; Index < Hits.Num(); ++Index)
+	{
+		Hits[Index].Key->TakeDamage(Hits[Index].Value, HitInstigators[Index]);
+	}
+}
+
+AAreaDamageService* AAreaDamageService::GetAreaDamageService(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AAreaDamageService>(WorldContextObject);
+}
@@ -0,0 +1,90 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "AreaDamageService.generated.h"
+
+class AUnitSimulationManager;
+
+/**
+ * Splash damage for siege impacts and anything else that hits an area.
+ * Impacts are queued and resolved together: every unit and building in reach of any impact is gathered from the
+ * unit simulation's grids into flat arrays, damage is scaled by distance and diplomacy in one tight pass,
+ * and each target then takes the sum of its hits once.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AAreaDamageService : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAreaDamageService();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Queues an impact; damage falls linearly from Damage at the centre to Damage * (1 - Falloff) at Radius
+	UFUNCTION(BlueprintCallable, Category = "Combat|Area Damage")
+	void ApplyAreaDamage(const FVector& Location, float Radius, float Damage, float Falloff, EFactionID Faction, AActor* Instigator);
+
+	// Resolves every queued impact now rather than at the end of the frame
+	void FlushImpacts();
+
+	UFUNCTION(BlueprintPure, Category = "Combat|Area Damage")
+	int32 GetNumQueuedImpacts() const { return Impacts.Num(); }
+
+	// Returns the world's area damage service, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Combat|Area Damage", meta = (WorldContext = "WorldContextObject"))
+	static AAreaDamageService* GetAreaDamageService(UObject* WorldContextObject);
+
+protected:
+	// Share of damage dealt to the attacker's own faction, friends and allies
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat|Area Damage", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float FriendlyFireScale;
+
+	// Share of damage dealt to factions neither hostile nor friendly
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat|Area Damage", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float NeutralDamageScale;
+
+	// Multiplier on damage to buildings; siege shots are meant for walls
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Combat|Area Damage")
+	float StructureDamageScale;
+
+private:
+	struct FImpact
+	{
+		FVector Location;
+		float Radius;
+		float Damage;
+		float Falloff;
+		EFactionID Faction;
+		TWeakObjectPtr<AActor> Instigator;
+	};
+
+	TArray<FImpact> Impacts;
+	TArray<FImpact> FlushingImpacts;
+
+	// One entry per impact and unit in reach, padded to a multiple of four for the vector damage pass
+	TArray<int32> PairTargets;
+	TArray<int32> PairImpacts;
+	TArray<float> PairDistancesSquared;
+	TArray<float> PairBaseDamages;
+	TArray<float> PairFalloffs;
+	TArray<float> PairDamages;
+	int32 NumPairs = 0;
+
+	// Summed damage per unit slot, and the slots touched this flush
+	TArray<float> UnitDamage;
+	TArray<int32> UnitInstigatorImpacts;
+	TArray<int32> DamagedUnits;
+
+	TWeakObjectPtr<AUnitSimulationManager> Simulation;
+
+	void GatherUnits(const AUnitSimulationManager& Sim);
+	void ComputeDamage();
+	void ApplyToUnits(AUnitSimulationManager& Sim);
+	void ApplyToBuildings(AUnitSimulationManager& Sim);
+	float GetDiplomacyScale(const AUnitSimulationManager& Sim, EFactionID Attacker, EFactionID Target) const;
+};
@@ -2,48 +2,24 @@
 
 #include "Legionary.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
-#include "GameFramework/CharacterMovementComponent.h"
+#include "RomanEmpireGame/Units/ProjectileManager.h"
+
+namespace
+{
+	const FName TestudoRangedDefenseId(TEXT("Testudo.RangedDefense"));
+	const FName TestudoMeleeDefenseId(TEXT("Testudo.MeleeDefense"));
+	const FName TestudoSpeedId(TEXT("Testudo.Speed"));
+}
 
 ALegionary::ALegionary()
 {
-	// Setup Legionary stats
-	UnitData.UnitType = EUnitType::Legionary;
-	UnitData.Category = EUnitCategory::Infantry;
-	UnitData.DisplayName = FText::FromString(TEXT("Legionary"));
-	UnitData.Description = FText::FromString(TEXT("The disciplined backbone of the Roman army. Armed with gladius, pilum, and scutum."));
-
-	// Stats
-	UnitData.BaseStats.MaxHealth = 120;
-	UnitData.BaseStats.MeleeAttack = 12;
-	UnitData.BaseStats.RangedAttack = 8;
-	UnitData.BaseStats.MeleeDefense = 10;
-	UnitData.BaseStats.RangedDefense = 8;
-	UnitData.BaseStats.Armor = 5;
-	UnitData.BaseStats.Speed = 280.0f;
-	UnitData.BaseStats.Morale = 60;
-	UnitData.BaseStats.Stamina = 100.0f;
-	UnitData.BaseStats.AttackSpeed = 1.0f;
-	UnitData.BaseStats.BlockStrength = 1.2f;
-
-	// Cost
-	UnitData.GoldCost = 150;
-	UnitData.FoodCost = 50;
-	UnitData.TrainingTime = 15.0f;
-
-	// Combat
-	UnitData.AttackRange = 150.0f;
-	UnitData.bCanUseRanged = true; // Can throw pilum
-	UnitData.bHasShield = true;
-
-	// Equipment
-	UnitData.PrimaryWeapon = TEXT("Gladius");
-	UnitData.SecondaryWeapon = TEXT("Pilum");
+	// Stats, costs and equipment are shared by every Legionary through FUnitTypeRegistry
+	UnitType = EUnitType::Legionary;
 
 	// Legionary specific
 	bInTestudo = false;
 	MaxPila = 2;
 	PilaCount = MaxPila;
-	PilumProjectile = nullptr;
 	PilumDamage = 25.0f;
 	PilumRange = 2000.0f;
 }
@@ -64,15 +40,9 @@ void ALegionary::ActivateTestudo()
 	bInTestudo = true;
 
 	// Testudo greatly increases defense but reduces speed
-	UCharacterMovementComponent* Movement = GetCharacterMovementComponent();
-	if (Movement)
-	{
-		Movement->MaxWalkSpeed = UnitData.BaseStats.Speed * 0.3f;
-	}
-
-	// Boost defense (temporary stat modification)
-	UnitData.BaseStats.RangedDefense += 20;
-	UnitData.BaseStats.MeleeDefense += 10;
+	AddStatModifier(FUnitStatModifier(TestudoRangedDefenseId, EStatModifierSource::Formation, EUnitStat::RangedDefense, 20.0f));
+	AddStatModifier(FUnitStatModifier(TestudoMeleeDefenseId, EStatModifierSource::Formation, EUnitStat::MeleeDefense, 10.0f));
+	AddStatModifier(FUnitStatModifier(TestudoSpeedId, EStatModifierSource::Formation, EUnitStat::Speed, 0.0f, 0.3f));
 
 	UE_LOG(LogRomanEmpire, Log, TEXT("%s activated Testudo formation"), *GetName());
 }
@@ -86,15 +56,9 @@ void ALegionary::DeactivateTestudo()
 
 	bInTestudo = false;
 
-	// Restore normal stats
-	UCharacterMovementComponent* Movement = GetCharacterMovementComponent();
-	if (Movement)
-	{
-		Movement->MaxWalkSpeed = UnitData.BaseStats.Speed;
-	}
-
-	UnitData.BaseStats.RangedDefense -= 20;
-	UnitData.BaseStats.MeleeDefense -= 10;
+	RemoveStatModifier(TestudoRangedDefenseId);
+	RemoveStatModifier(TestudoMeleeDefenseId);
+	RemoveStatModifier(TestudoSpeedId);
 
 	UE_LOG(LogRomanEmpire, Log, TEXT("%s deactivated Testudo formation"), *GetName());
 }
@@ -112,40 +76,22 @@ void ALegionary::ThrowPilum()
 		return; // Not enough stamina
 	}
 
-	PilaCount--;
-	CurrentStamina -= 15.0f;
-
-	// Projectile spawn
-	FVector SpawnLocation = GetActorLocation() + FVector(0, 0, 150); // Throw from shoulder height
-	FRotator SpawnRotation = GetActorRotation();
-
-	if (PilumProjectile)
+	AProjectileManager* Projectiles = AProjectileManager::GetProjectileManager(this);
+	if (!Projectiles)
 	{
-		// TODO: Spawn projectile actor
-		// GetWorld()->SpawnActor<AActor>(PilumProjectile, SpawnLocation, SpawnRotation);
+		return;
 	}
-	else
+
+	// Thrown from shoulder height at the commanded target, otherwise as far ahead as the pilum carries
+	const FVector SpawnLocation = GetActorLocation() + FVector(0, 0, 150);
+	const FVector Target = AttackTarget ? AttackTarget->GetActorLocation() : GetActorLocation() + GetActorForwardVector() * PilumRange;
+	if (!Projectiles->LaunchAtTarget(EProjectileType::Pilum, this, OwnerFaction, SpawnLocation, Target, PilumDamage))
 	{
-		// Fallback: Instant hit trace
-		FVector End = SpawnLocation + GetActorForwardVector() * PilumRange;
-		
-		FHitResult HitResult;
-		FCollisionQueryParams Params;
-		Params.AddIgnoredActor(this);
-
-		if (GetWorld()->LineTraceSingleByChannel(HitResult, SpawnLocation, End, ECC_Pawn, Params))
-		{
-			if (AUnitBase* HitUnit = Cast<AUnitBase>(HitResult.GetActor()))
-			{
-				if (HitUnit->GetOwnerFaction() != OwnerFaction)
-				{
-					HitUnit->TakeCombatDamage(PilumDamage, this, true);
-					UE_LOG(LogRomanEmpire, Log, TEXT("%s hit %s with pilum for %f damage"), 
-						*GetName(), *HitUnit->GetName(), PilumDamage);
-				}
-			}
-		}
+		return; // Out of reach; the pilum is kept
 	}
 
+	PilaCount--;
+	CurrentStamina -= 15.0f;
+
 	UE_LOG(LogRomanEmpire, Log, TEXT("%s threw pilum (%d remaining)"), *GetName(), PilaCount);
 }
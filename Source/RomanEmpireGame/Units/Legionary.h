@@ -47,9 +47,6 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Legionary")
 	int32 PilaCount;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Legionary")
-	TSubclassOf<AActor> PilumProjectile;
-
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Legionary")
 	float PilumDamage;
 
@@ -0,0 +1,502 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "ProjectileManager.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
+#include "RomanEmpireGame/Units/AreaDamageService.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Simulation"), STAT_ProjectileSimulation, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Projectile Simulation - Impacts"), STAT_ProjectileImpacts, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Projectile Simulation - Draw"), STAT_ProjectileDraw, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles In Flight"), STAT_ProjectilesInFlight, STATGROUP_RomanEmpire);
+
+namespace
+{
+	// Covers the widest unit capsule plus the distance a unit can move between the grid build and this pass
+	constexpr float UnitQueryPadding = 150.0f;
+
+	FProjectileTypeSettings MakeProjectileType(float LaunchSpeed, float DragCoefficient, float HitRadius, bool bHighArc)
+	{
+		FProjectileTypeSettings Settings;
+		Settings.LaunchSpeed = LaunchSpeed;
+		Settings.DragCoefficient = DragCoefficient;
+		Settings.HitRadius = HitRadius;
+		Settings.bHighArc = bHighArc;
+		return Settings;
+	}
+}
+
+int32 AProjectileManager::FProjectileData::Add()
+{
+	Positions.AddUninitialized();
+	Velocities.AddUninitialized();
+	Damages.AddUninitialized();
+	HitRadii.AddUninitialized();
+	Drags.AddUninitialized();
+	Gravities.AddUninitialized();
+	FloorHeights.AddUninitialized();
+	Ages.AddZeroed();
+	Factions.Add(EFactionID::None);
+	Types.Add(EProjectileType::None);
+	return Instigators.AddDefaulted();
+}
+
+void AProjectileManager::FProjectileData::RemoveAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Damages.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	HitRadii.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Drags.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Gravities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	FloorHeights.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Ages.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Factions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Types.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Instigators.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+AProjectileManager::AProjectileManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Runs after units have moved so hits are tested against this frame's positions
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	RootScene = CreateDefaultSubobject<USceneComponent>(TEXT("RootScene"));
+	SetRootComponent(RootScene);
+
+	ProjectileTypes.Add(EProjectileType::Pilum, MakeProjectileType(2500.0f, 0.00003f, 8.0f, false));
+	ProjectileTypes.Add(EProjectileType::Arrow, MakeProjectileType(4500.0f, 0.00002f, 4.0f, true));
+	ProjectileTypes.Add(EProjectileType::SlingStone, MakeProjectileType(4000.0f, 0.00004f, 3.0f, false));
+	ProjectileTypes.Add(EProjectileType::Bolt, MakeProjectileType(6000.0f, 0.00001f, 10.0f, false));
+	ProjectileTypes.Add(EProjectileType::Stone, MakeProjectileType(2500.0f, 0.00001f, 60.0f, true));
+	ProjectileTypes[EProjectileType::Stone].SplashRadius = 300.0f;
+
+	MaxProjectiles = 65536;
+	MaxLifetime = 20.0f;
+	FloorDepth = 120.0f;
+	ObstacleHeight = 800.0f;
+	MaxStepSeconds = 0.1f;
+	bDrawProjectiles = true;
+}
+
+const FProjectileTypeSettings& AProjectileManager::GetTypeSettings(EProjectileType Type) const
+{
+	static const FProjectileTypeSettings DefaultSettings;
+	const FProjectileTypeSettings* Settings = ProjectileTypes.Find(Type);
+	return Settings ? *Settings : DefaultSettings;
+}
+
+bool AProjectileManager::LaunchAtTarget(EProjectileType Type, AActor* Instigator, EFactionID Faction, const FVector& Start, const FVector& Target, float Damage)
+{
+	const FProjectileTypeSettings& Settings = GetTypeSettings(Type);
+	const float Gravity = -GetWorld()->GetGravityZ() * Settings.GravityScale;
+
+	FVector Velocity;
+	if (!SuggestLaunchVelocity(Start, Target, Settings.LaunchSpeed, Gravity, Settings.bHighArc, Velocity))
+	{
+		return false;
+	}
+
+	Launch(Type, Instigator, Faction, Start, Velocity, Damage, Target.Z - FloorDepth);
+	return true;
+}
+
+void AProjectileManager::Launch(EProjectileType Type, AActor* Instigator, EFactionID Faction, const FVector& Start, const FVector& Velocity, float Damage, float FloorHeight)
+{
+	if (Projectiles.Num() >= MaxProjectiles)
+	{
+		UE_LOG(LogRomanEmpire, Verbose, TEXT("Projectile limit of %d reached; launch dropped"), MaxProjectiles);
+		return;
+	}
+
+	const FProjectileTypeSettings& Settings = GetTypeSettings(Type);
+
+	const int32 Index = Projectiles.Add();
+	Projectiles.Positions[Index] = Start;
+	Projectiles.Velocities[Index] = Velocity;
+	Projectiles.Damages[Index] = Damage;
+	Projectiles.HitRadii[Index] = Settings.HitRadius;
+	Projectiles.Drags[Index] = Settings.DragCoefficient;
+	Projectiles.Gravities[Index] = GetWorld()->GetGravityZ() * Settings.GravityScale;
+	Projectiles.FloorHeights[Index] = FloorHeight;
+	Projectiles.Factions[Index] = Faction;
+	Projectiles.Types[Index] = Type;
+	Projectiles.Instigators[Index] = Instigator;
+}
+
+bool AProjectileManager::SuggestLaunchVelocity(const FVector& Start, const FVector& Target, float Speed, float Gravity, bool bHighArc, FVector& OutVelocity)
+{
+	const FVector Delta = Target - Start;
+	const FVector2D Horizontal(Delta);
+	const float Distance = Horizontal.Size();
+
+	if (Gravity <= KINDA_SMALL_NUMBER || Distance <= KINDA_SMALL_NUMBER)
+	{
+		OutVelocity = Delta.GetSafeNormal() * Speed;
+		return !OutVelocity.IsZero();
+	}
+
+	const float SpeedSquared = Speed * Speed;
+	const float Discriminant = SpeedSquared * SpeedSquared - Gravity * (Gravity * Distance * Distance + 2.0f * Delta.Z * SpeedSquared);
+	if (Discriminant < 0.0f)
+	{
+		return false;
+	}
+
+	const float Root = FMath::Sqrt(Discriminant);
+	const float Angle = FMath::Atan((SpeedSquared + (bHighArc ? Root : -Root)) / (Gravity * Distance));
+	const FVector2D Direction = Horizontal / Distance;
+
+	OutVelocity = FVector(Direction * (Speed * FMath::Cos(Angle)), Speed * FMath::Sin(Angle));
+	return true;
+}
+
+EProjectileType AProjectileManager::GetProjectileTypeForUnit(EUnitType UnitType)
+{
+	switch (UnitType)
+	{
+	case EUnitType::Velites:
+	case EUnitType::Javelinmen:
+		return EProjectileType::Pilum;
+	case EUnitType::Sagittarii:
+	case EUnitType::CavalryArcher:
+		return EProjectileType::Arrow;
+	case EUnitType::Slingers:
+		return EProjectileType::SlingStone;
+	case EUnitType::Ballista:
+		return EProjectileType::Bolt;
+	case EUnitType::Onager:
+		return EProjectileType::Stone;
+	default:
+		// Legionaries carry a couple of pila, thrown through ALegionary::ThrowPilum rather than as their attack
+		return EProjectileType::None;
+	}
+}
+
+void AProjectileManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileSimulation);
+
+	Super::Tick(DeltaSeconds);
+
+	SET_DWORD_STAT(STAT_ProjectilesInFlight, Projectiles.Num());
+
+	if (Projectiles.Num() > 0)
+	{
+		if (!Simulation.IsValid())
+		{
+			Simulation = AUnitSimulationManager::GetUnitSimulationManager(this);
+		}
+
+		// Targets are found through the unit simulation's grids
+		if (AUnitSimulationManager* Sim = Simulation.Get())
+		{
+			Integrate(FMath::Min(DeltaSeconds, MaxStepSeconds));
+			DetectImpacts(Sim);
+			ApplyImpacts(Sim);
+		}
+	}
+
+	UpdateBatches();
+}
+
+void AProjectileManager::Integrate(float DeltaSeconds)
+{
+	const int32 NumProjectiles = Projectiles.Num();
+	PreviousPositions.SetNumUninitialized(NumProjectiles);
+
+	ParallelFor(NumProjectiles, [this, DeltaSeconds](int32 Index)
+	{
+		FVector& Position = Projectiles.Positions[Index];
+		FVector& Velocity = Projectiles.Velocities[Index];
+
+		PreviousPositions[Index] = Position;
+
+		// Semi-implicit Euler with quadratic drag against the direction of flight
+		const FVector Acceleration = FVector(0.0f, 0.0f, Projectiles.Gravities[Index]) - Velocity * (Projectiles.Drags[Index] * Velocity.Size());
+		Velocity += Acceleration * DeltaSeconds;
+		Position += Velocity * DeltaSeconds;
+		Projectiles.Ages[Index] += DeltaSeconds;
+	});
+}
+
+void AProjectileManager::DetectImpacts(AUnitSimulationManager* Sim)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileImpacts);
+
+	const int32 NumProjectiles = Projectiles.Num();
+	Impacts.SetNumUninitialized(NumProjectiles);
+
+	const FUnitSimulationData& Units = Sim->GetData();
+	const FUnitSpatialGrid& UnitGrid = Sim->GetSpatialGrid();
+	const FUnitSpatialGrid& ObstacleGrid = Sim->GetObstacleGrid();
+	const FFactionRelationCache& Relations = Sim->GetFactionRelations();
+	const float MaxObstacleRadius = Sim->GetMaxObstacleRadius();
+
+	ParallelFor(NumProjectiles, [&](int32 Index)
+	{
+		FProjectileImpact Impact;
+
+		const FVector& Start = PreviousPositions[Index];
+		const FVector& End = Projectiles.Positions[Index];
+		const float Floor = Projectiles.FloorHeights[Index];
+		const float HitRadius = Projectiles.HitRadii[Index];
+		const EFactionID Faction = Projectiles.Factions[Index];
+
+		if (End.Z <= Floor)
+		{
+			const float Drop = Start.Z - End.Z;
+			Impact.Time = Drop > KINDA_SMALL_NUMBER ? FMath::Clamp((Start.Z - Floor) / Drop, 0.0f, 1.0f) : 0.0f;
+		}
+
+		// Closest approach of the flight segment to each candidate, in the ground plane, then checked against its height span
+		const FVector2D Start2D(Start);
+		const FVector2D Segment(End - Start);
+		const float SegmentLengthSquared = Segment.SizeSquared();
+		const FVector2D Middle = Start2D + Segment * 0.5f;
+		const float HalfLength = 0.5f * FMath::Sqrt(SegmentLengthSquared);
+
+		auto ClosestTime = [&](const FVector2D& Point)
+		{
+			return SegmentLengthSquared > KINDA_SMALL_NUMBER
+				? FMath::Clamp(((Point - Start2D) | Segment) / SegmentLengthSquared, 0.0f, 1.0f)
+				: 0.0f;
+		};
+
+		UnitGrid.ForEachInRadius(Middle, HalfLength + HitRadius + UnitQueryPadding, [&](int32 Unit, float)
+		{
+			if (EnumHasAnyFlags(Units.Flags[Unit], EUnitSimFlags::PendingRemoval) || !Relations.AreHostile(Faction, Units.Factions[Unit]))
+			{
+				return;
+			}
+
+			const FVector& Center = Units.Positions[Unit];
+			const FVector2D Center2D(Center);
+			const float Time = ClosestTime(Center2D);
+			if (Time >= Impact.Time)
+			{
+				return;
+			}
+
+			const float Reach = Units.Radii[Unit] + HitRadius;
+			if (FVector2D::DistSquared(Start2D + Segment * Time, Center2D) > Reach * Reach)
+			{
+				return;
+			}
+
+			const float Height = FMath::Lerp(Start.Z, End.Z, Time);
+			if (FMath::Abs(Height - Center.Z) > Units.HalfHeights[Unit])
+			{
+				return;
+			}
+
+			Impact.Time = Time;
+			Impact.Unit = Unit;
+			Impact.Obstacle = INDEX_NONE;
+		});
+
+		ObstacleGrid.ForEachInRadius(Middle, HalfLength + HitRadius + MaxObstacleRadius, [&](int32 Obstacle, float)
+		{
+			const FVector& Center = Sim->GetObstacleCenter(Obstacle);
+			const FVector2D Center2D(Center);
+			const float Time = ClosestTime(Center2D);
+			if (Time >= Impact.Time)
+			{
+				return;
+			}
+
+			const float Reach = Sim->GetObstacleRadius(Obstacle) + HitRadius;
+			if (FVector2D::DistSquared(Start2D + Segment * Time, Center2D) > Reach * Reach)
+			{
+				return;
+			}
+
+			const float Height = FMath::Lerp(Start.Z, End.Z, Time);
+			if (Height < Center.Z || Height > Center.Z + ObstacleHeight)
+			{
+				return;
+			}
+
+			Impact.Time = Time;
+			Impact.Unit = INDEX_NONE;
+			Impact.Obstacle = Obstacle;
+		});
+
+		Impacts[Index] = Impact;
+	});
+}
+
+void AProjectileManager::ApplyImpacts(AUnitSimulationManager* Sim)
+{
+	SpentProjectiles.Reset();
+
+	const int32 NumProjectiles = Projectiles.Num();
+
+	// Resolve every target before applying damage, since a destroyed building unregisters and reshuffles the obstacle list
+	ImpactTargets.Reset();
+	ImpactTargets.SetNumZeroed(NumProjectiles);
+
+	for (int32 Index = 0; Index < NumProjectiles; ++Index)
+	{
+		const FProjectileImpact& Impact = Impacts[Index];
+		if (Impact.Time <= 1.0f)
+		{
+			SpentProjectiles.Add(Index);
+
+			if (Impact.Unit != INDEX_NONE)
+			{
+				ImpactTargets[Index] = Sim->GetUnit(Impact.Unit);
+			}
+			else if (Impact.Obstacle != INDEX_NONE)
+			{
+				ImpactTargets[Index] = Sim->GetObstacleOwner(Impact.Obstacle);
+			}
+		}
+		else if (Projectiles.Ages[Index] > MaxLifetime)
+		{
+			SpentProjectiles.Add(Index);
+		}
+	}
+
+	AAreaDamageService* AreaDamage = nullptr;
+
+	for (const int32 Index : SpentProjectiles)
+	{
+		AActor* Instigator = Projectiles.Instigators[Index].Get();
+		const float Damage = Projectiles.Damages[Index];
+
+		// Splash shots hurt everything around the impact, including a miss on open ground
+		const FProjectileTypeSettings& Settings = GetTypeSettings(Projectiles.Types[Index]);
+		if (Settings.SplashRadius > 0.0f && Impacts[Index].Time <= 1.0f)
+		{
+			if (!AreaDamage)
+			{
+				AreaDamage = AAreaDamageService::GetAreaDamageService(this);
+			}
+			if (AreaDamage)
+			{
+				const FVector ImpactPoint = FMath::Lerp(PreviousPositions[Index], Projectiles.Positions[Index], Impacts[Index].Time);
+				AreaDamage->ApplyAreaDamage(ImpactPoint, Settings.SplashRadius, Damage, Settings.SplashFalloff, Projectiles.Factions[Index], Instigator);
+			}
+			continue;
+		}
+
+		AActor* Target = ImpactTargets[Index];
+		if (!Target)
+		{
+			continue;
+		}
+
+		if (AUnitBase* Unit = Cast<AUnitBase>(Target))
+		{
+			// Armour, defence and shields apply through the unit's own ranged damage reduction
+			Unit->TakeCombatDamage(Damage, Instigator, true);
+		}
+		else if (ABuildingBase* Building = Cast<ABuildingBase>(Target))
+		{
+			// Friendly walls stop shots without taking damage
+			if (Sim->GetFactionRelations().AreHostile(Projectiles.Factions[Index], Building->GetOwnerFaction()))
+			{
+				Building->TakeDamage(Damage, Instigator);
+			}
+		}
+	}
+
+	// The whole volley lands together
+	if (AreaDamage)
+	{
+		AreaDamage->FlushImpacts();
+	}
+
+	// Ascending order, so walk backwards to keep pending indices valid while swapping
+	for (int32 Spent = SpentProjectiles.Num() - 1; Spent >= 0; --Spent)
+	{
+		Projectiles.RemoveAtSwap(SpentProjectiles[Spent]);
+	}
+}
+
+void AProjectileManager::UpdateBatches()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileDraw);
+
+	if (!bDrawProjectiles)
+	{
+		return;
+	}
+
+	for (const TPair<EProjectileType, FProjectileTypeSettings>& Pair : ProjectileTypes)
+	{
+		UInstancedStaticMeshComponent* Component = Batches.FindRef(Pair.Key);
+		if (!Component && !Pair.Value.Mesh)
+		{
+			continue;
+		}
+
+		BatchTransforms.Reset();
+		for (int32 Index = 0; Index < Projectiles.Num(); ++Index)
+		{
+			if (Projectiles.Types[Index] == Pair.Key)
+			{
+				BatchTransforms.Emplace(Projectiles.Velocities[Index].ToOrientationQuat(), Projectiles.Positions[Index]);
+			}
+		}
+
+		if (!Component)
+		{
+			if (BatchTransforms.Num() == 0)
+			{
+				continue;
+			}
+			Component = FindOrCreateBatch(Pair.Key);
+		}
+
+		const int32 Count = BatchTransforms.Num();
+		if (Count != Component->GetInstanceCount())
+		{
+			Component->ClearInstances();
+			Component->AddInstances(BatchTransforms, false, true);
+		}
+		else if (Count > 0)
+		{
+			Component->BatchUpdateInstancesTransforms(0, BatchTransforms, true, true, true);
+		}
+	}
+}
+
+UInstancedStaticMeshComponent* AProjectileManager::FindOrCreateBatch(EProjectileType Type)
+{
+	if (UInstancedStaticMeshComponent* Existing = Batches.FindRef(Type))
+	{
+		return Existing;
+	}
+
+	const FProjectileTypeSettings& Settings = GetTypeSettings(Type);
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(this);
+	Component->SetupAttachment(RootScene);
+	Component->SetStaticMesh(Settings.Mesh);
+	if (Settings.Material)
+	{
+		Component->SetMaterial(0, Settings.Material);
+	}
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetCastShadow(false);
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->RegisterComponent();
+
+	BatchComponents.Add(Component);
+	Batches.Add(Type, Component);
+	return Component;
+}
+
+AProjectileManager* AProjectileManager::GetProjectileManager(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AProjectileManager>(WorldContextObject);
+}
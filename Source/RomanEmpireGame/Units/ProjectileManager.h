@@ -0,0 +1,202 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "ProjectileManager.generated.h"
+
+class AUnitSimulationManager;
+class UStaticMesh;
+class UMaterialInterface;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Kinds of simulated projectile
+ */
+UENUM(BlueprintType)
+enum class EProjectileType : uint8
+{
+	None		UMETA(DisplayName = "None"),
+	Pilum		UMETA(DisplayName = "Pilum"),		// Thrown javelin
+	Arrow		UMETA(DisplayName = "Arrow"),
+	SlingStone	UMETA(DisplayName = "Sling Stone"),
+	Bolt		UMETA(DisplayName = "Ballista Bolt"),
+	Stone		UMETA(DisplayName = "Onager Stone")
+};
+
+/**
+ * Flight and appearance of one projectile type
+ */
+USTRUCT(BlueprintType)
+struct FProjectileTypeSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	UStaticMesh* Mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	UMaterialInterface* Material;
+
+	// cm/s
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	float LaunchSpeed;
+
+	// Quadratic drag: deceleration is DragCoefficient * speed squared, per cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	float DragCoefficient;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	float GravityScale;
+
+	// Added to a target's radius when testing for a hit
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	float HitRadius;
+
+	// Lob over friendly lines instead of firing flat
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	bool bHighArc;
+
+	// Above zero, impacts deal area damage through AAreaDamageService instead of hitting one target
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
+	float SplashRadius;
+
+	// Share of splash damage lost between the impact point and SplashRadius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float SplashFalloff;
+
+	FProjectileTypeSettings()
+		: Mesh(nullptr)
+		, Material(nullptr)
+		, LaunchSpeed(3000.0f)
+		, DragCoefficient(0.00002f)
+		, GravityScale(1.0f)
+		, HitRadius(5.0f)
+		, bHighArc(false)
+		, SplashRadius(0.0f)
+		, SplashFalloff(0.75f)
+	{}
+};
+
+/**
+ * Simulates every projectile in flight as parallel arrays.
+ * Each step integrates gravity and drag, sweeps the flight segment against the unit simulation's spatial grid
+ * and registered building obstacles in one parallel pass, then applies ranged damage to whatever was hit first.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AProjectileManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AProjectileManager();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Fires at Target with the type's launch speed; returns false if the target is out of reach
+	UFUNCTION(BlueprintCallable, Category = "Projectiles")
+	bool LaunchAtTarget(EProjectileType Type, AActor* Instigator, EFactionID Faction, const FVector& Start, const FVector& Target, float Damage);
+
+	// Fires with an explicit velocity; the projectile is spent when it falls below FloorHeight
+	void Launch(EProjectileType Type, AActor* Instigator, EFactionID Faction, const FVector& Start, const FVector& Velocity, float Damage, float FloorHeight);
+
+	UFUNCTION(BlueprintPure, Category = "Projectiles")
+	int32 GetNumProjectiles() const { return Projectiles.Num(); }
+
+	// Drag-free ballistic solution; picks the lob when bHighArc is set
+	static bool SuggestLaunchVelocity(const FVector& Start, const FVector& Target, float Speed, float Gravity, bool bHighArc, FVector& OutVelocity);
+
+	// Projectile a unit type shoots, or None for melee-only types
+	UFUNCTION(BlueprintPure, Category = "Projectiles")
+	static EProjectileType GetProjectileTypeForUnit(EUnitType UnitType);
+
+	// Returns the world's projectile manager, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Projectiles", meta = (WorldContext = "WorldContextObject"))
+	static AProjectileManager* GetProjectileManager(UObject* WorldContextObject);
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USceneComponent* RootScene;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectiles")
+	TMap<EProjectileType, FProjectileTypeSettings> ProjectileTypes;
+
+	// Launches beyond this many live projectiles are dropped
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectiles")
+	int32 MaxProjectiles;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectiles")
+	float MaxLifetime;
+
+	// Depth below an aimed point at which a miss counts as hitting the ground
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectiles")
+	float FloorDepth;
+
+	// Height of building obstacles above their origin
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectiles")
+	float ObstacleHeight;
+
+	// Longest step simulated at once
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectiles")
+	float MaxStepSeconds;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectiles")
+	bool bDrawProjectiles;
+
+private:
+	/** Hot projectile state as parallel arrays; removal swaps the last projectile into the hole */
+	struct FProjectileData
+	{
+		TArray<FVector> Positions;
+		TArray<FVector> Velocities;
+		TArray<float> Damages;
+		TArray<float> HitRadii;
+		TArray<float> Drags;
+		TArray<float> Gravities;
+		TArray<float> FloorHeights;
+		TArray<float> Ages;
+		TArray<EFactionID> Factions;
+		TArray<EProjectileType> Types;
+		TArray<TWeakObjectPtr<AActor>> Instigators;
+
+		int32 Num() const { return Positions.Num(); }
+
+		int32 Add();
+		void RemoveAtSwap(int32 Index);
+	};
+
+	/** First thing a projectile struck this step */
+	struct FProjectileImpact
+	{
+		int32 Unit = INDEX_NONE;
+		int32 Obstacle = INDEX_NONE;
+		float Time = 2.0f;	// Fraction of the step; above 1 means no impact
+	};
+
+	FProjectileData Projectiles;
+
+	TArray<FVector> PreviousPositions;
+	TArray<FProjectileImpact> Impacts;
+	TArray<AActor*> ImpactTargets;
+	TArray<int32> SpentProjectiles;
+
+	TWeakObjectPtr<AUnitSimulationManager> Simulation;
+
+	TMap<EProjectileType, UInstancedStaticMeshComponent*> Batches;
+
+	// Keeps the batch components alive for the garbage collector
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> BatchComponents;
+
+	TArray<FTransform> BatchTransforms;
+
+	const FProjectileTypeSettings& GetTypeSettings(EProjectileType Type) const;
+	void Integrate(float DeltaSeconds);
+	void DetectImpacts(AUnitSimulationManager* Sim);
+	void ApplyImpacts(AUnitSimulationManager* Sim);
+	void UpdateBatches();
+	UInstancedStaticMeshComponent* FindOrCreateBatch(EProjectileType Type);
+};
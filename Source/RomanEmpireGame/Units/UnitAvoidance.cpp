@@ -0,0 +1,260 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitAvoidance.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+
+namespace UnitAvoidance
+{
+	namespace
+	{
+		constexpr float Epsilon = 0.00001f;
+
+		// Directed line; permitted velocities lie to its left
+		struct FLine
+		{
+			FVector2D Point;
+			FVector2D Direction;
+		};
+
+		using FLineArray = TArray<FLine, TInlineAllocator<32>>;
+
+		float Det(const FVector2D& A, const FVector2D& B)
+		{
+			return A.X * B.Y - A.Y * B.X;
+		}
+
+		// Velocity constraint induced by something at RelativePosition moving at OtherVelocity
+		FLine MakeLine(const FVector2D& Velocity, const FVector2D& RelativePosition, const FVector2D& OtherVelocity,
+			float CombinedRadius, float Responsibility, float TimeHorizon, float TimeStep)
+		{
+			const FVector2D RelativeVelocity = Velocity - OtherVelocity;
+			const float DistanceSquared = RelativePosition.SizeSquared();
+			const float CombinedRadiusSquared = CombinedRadius * CombinedRadius;
+
+			FLine Line;
+			FVector2D U;
+
+			if (DistanceSquared > CombinedRadiusSquared)
+			{
+				const float InvTimeHorizon = 1.0f / TimeHorizon;
+
+				// Vector from the cutoff circle centre to the relative velocity
+				const FVector2D W = RelativeVelocity - InvTimeHorizon * RelativePosition;
+				const float WLengthSquared = W.SizeSquared();
+				const float DotProduct = W | RelativePosition;
+
+				if (DotProduct < 0.0f && DotProduct * DotProduct > CombinedRadiusSquared * WLengthSquared)
+				{
+					// Project on the cutoff circle
+					const float WLength = FMath::Sqrt(WLengthSquared);
+					const FVector2D UnitW = W / WLength;
+					Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+					U = (CombinedRadius * InvTimeHorizon - WLength) * UnitW;
+				}
+				else
+				{
+					// Project on the nearer leg of the velocity obstacle cone
+					const float Leg = FMath::Sqrt(DistanceSquared - CombinedRadiusSquared);
+					if (Det(RelativePosition, W) > 0.0f)
+					{
+						Line.Direction = FVector2D(
+							RelativePosition.X * Leg - RelativePosition.Y * CombinedRadius,
+							RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistanceSquared;
+					}
+					else
+					{
+						Line.Direction = -FVector2D(
+							RelativePosition.X * Leg + RelativePosition.Y * CombinedRadius,
+							-RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistanceSquared;
+					}
+
+					U = (RelativeVelocity | Line.Direction) * Line.Direction - RelativeVelocity;
+				}
+			}
+			else
+			{
+				// Already overlapping; resolve within one step
+				const float InvTimeStep = 1.0f / TimeStep;
+				const FVector2D W = RelativeVelocity - InvTimeStep * RelativePosition;
+				const float WLength = W.Size();
+				const FVector2D UnitW = WLength > Epsilon ? W / WLength : FVector2D(1.0f, 0.0f);
+				Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+				U = (CombinedRadius * InvTimeStep - WLength) * UnitW;
+			}
+
+			Line.Point = Velocity + Responsibility * U;
+			return Line;
+		}
+
+		// Optimises along line LineIndex subject to every earlier line and the speed circle
+		bool LinearProgram1(const FLineArray& Lines, int32 LineIndex, float Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+		{
+			const FLine& Line = Lines[LineIndex];
+			const float DotProduct = Line.Point | Line.Direction;
+			const float Discriminant = DotProduct * DotProduct + Radius * Radius - Line.Point.SizeSquared();
+
+			if (Discriminant < 0.0f)
+			{
+				// The speed circle fully invalidates this line
+				return false;
+			}
+
+			const float SqrtDiscriminant = FMath::Sqrt(Discriminant);
+			float TLeft = -DotProduct - SqrtDiscriminant;
+			float TRight = -DotProduct + SqrtDiscriminant;
+
+			for (int32 Index = 0; Index < LineIndex; ++Index)
+			{
+				const float Denominator = Det(Line.Direction, Lines[Index].Direction);
+				const float Numerator = Det(Lines[Index].Direction, Line.Point - Lines[Index].Point);
+
+				if (FMath::Abs(Denominator) <= Epsilon)
+				{
+					// Parallel lines
+					if (Numerator < 0.0f)
+					{
+						return false;
+					}
+					continue;
+				}
+
+				const float T = Numerator / Denominator;
+				if (Denominator >= 0.0f)
+				{
+					TRight = FMath::Min(TRight, T);
+				}
+				else
+				{
+					TLeft = FMath::Max(TLeft, T);
+				}
+
+				if (TLeft > TRight)
+				{
+					return false;
+				}
+			}
+
+			if (bDirectionOpt)
+			{
+				Result = Line.Point + ((OptVelocity | Line.Direction) > 0.0f ? TRight : TLeft) * Line.Direction;
+			}
+			else
+			{
+				const float T = FMath::Clamp(Line.Direction | (OptVelocity - Line.Point), TLeft, TRight);
+				Result = Line.Point + T * Line.Direction;
+			}
+
+			return true;
+		}
+
+		// Returns the number of lines satisfied; fewer than Lines.Num() means the program was infeasible
+		int32 LinearProgram2(const FLineArray& Lines, float Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+		{
+			if (bDirectionOpt)
+			{
+				Result = OptVelocity * Radius;
+			}
+			else if (OptVelocity.SizeSquared() > Radius * Radius)
+			{
+				Result = OptVelocity.GetSafeNormal() * Radius;
+			}
+			else
+			{
+				Result = OptVelocity;
+			}
+
+			for (int32 Index = 0; Index < Lines.Num(); ++Index)
+			{
+				if (Det(Lines[Index].Direction, Lines[Index].Point - Result) > 0.0f)
+				{
+					const FVector2D Previous = Result;
+					if (!LinearProgram1(Lines, Index, Radius, OptVelocity, bDirectionOpt, Result))
+					{
+						Result = Previous;
+						return Index;
+					}
+				}
+			}
+
+			return Lines.Num();
+		}
+
+		// Infeasible case: minimise the worst violation of the unit lines while keeping obstacle lines hard
+		void LinearProgram3(const FLineArray& Lines, int32 NumObstacleLines, int32 BeginLine, float Radius, FVector2D& Result)
+		{
+			float Distance = 0.0f;
+
+			for (int32 Index = BeginLine; Index < Lines.Num(); ++Index)
+			{
+				if (Det(Lines[Index].Direction, Lines[Index].Point - Result) <= Distance)
+				{
+					continue;
+				}
+
+				FLineArray Projected;
+				Projected.Append(Lines.GetData(), NumObstacleLines);
+
+				for (int32 Other = NumObstacleLines; Other < Index; ++Other)
+				{
+					FLine Line;
+					const float Determinant = Det(Lines[Index].Direction, Lines[Other].Direction);
+
+					if (FMath::Abs(Determinant) <= Epsilon)
+					{
+						if ((Lines[Index].Direction | Lines[Other].Direction) > 0.0f)
+						{
+							// Same direction
+							continue;
+						}
+						Line.Point = 0.5f * (Lines[Index].Point + Lines[Other].Point);
+					}
+					else
+					{
+						Line.Point = Lines[Index].Point + (Det(Lines[Other].Direction, Lines[Index].Point - Lines[Other].Point) / Determinant) * Lines[Index].Direction;
+					}
+
+					Line.Direction = (Lines[Other].Direction - Lines[Index].Direction).GetSafeNormal();
+					Projected.Add(Line);
+				}
+
+				const FVector2D Previous = Result;
+				if (LinearProgram2(Projected, Radius, FVector2D(-Lines[Index].Direction.Y, Lines[Index].Direction.X), true, Result) < Projected.Num())
+				{
+					// Only possible through floating point error; keep the previous answer
+					Result = Previous;
+				}
+
+				Distance = Det(Lines[Index].Direction, Lines[Index].Point - Result);
+			}
+		}
+	}
+
+	FVector2D ComputeVelocity(const FAgent& Agent, TConstArrayView<FObstacle> Obstacles, TConstArrayView<FNeighbour> Neighbours, const FParams& Params)
+	{
+		FLineArray Lines;
+
+		// Obstacles come first so the fallback program never relaxes them
+		for (const FObstacle& Obstacle : Obstacles)
+		{
+			Lines.Add(MakeLine(Agent.Velocity, Obstacle.Position - Agent.Position, FVector2D::ZeroVector,
+				Agent.Radius + Obstacle.Radius, 1.0f, Params.ObstacleTimeHorizon, Params.TimeStep));
+		}
+
+		const int32 NumObstacleLines = Lines.Num();
+
+		for (const FNeighbour& Neighbour : Neighbours)
+		{
+			Lines.Add(MakeLine(Agent.Velocity, Neighbour.Position - Agent.Position, Neighbour.Velocity,
+				Agent.Radius + Neighbour.Radius, Neighbour.Responsibility, Params.TimeHorizon, Params.TimeStep));
+		}
+
+		FVector2D Result;
+		const int32 Satisfied = LinearProgram2(Lines, Agent.MaxSpeed, Agent.PreferredVelocity, false, Result);
+		if (Satisfied < Lines.Num())
+		{
+			LinearProgram3(Lines, NumObstacleLines, Satisfied, Agent.MaxSpeed, Result);
+		}
+
+		return Result;
+	}
+}
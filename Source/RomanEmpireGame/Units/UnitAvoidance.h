@@ -0,0 +1,51 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Optimal reciprocal collision avoidance (ORCA) in the ground plane.
+ * Each neighbour contributes a half-plane of permitted velocities; a small linear program picks
+ * the permitted velocity closest to the preferred one. Stateless so it can run inside ParallelFor.
+ */
+namespace UnitAvoidance
+{
+	struct FNeighbour
+	{
+		FVector2D Position;
+		FVector2D Velocity;
+		float Radius;
+
+		// Share of the avoidance this unit takes on: 0.5 for another avoiding unit, 1 for anything that will not move aside
+		float Responsibility;
+	};
+
+	struct FObstacle
+	{
+		FVector2D Position;
+		float Radius;
+	};
+
+	struct FAgent
+	{
+		FVector2D Position;
+		FVector2D Velocity;
+		FVector2D PreferredVelocity;
+		float Radius;
+		float MaxSpeed;
+	};
+
+	struct FParams
+	{
+		// How far ahead collisions with other units are avoided
+		float TimeHorizon = 1.5f;
+
+		// How far ahead collisions with static obstacles are avoided; shorter lets units hug walls
+		float ObstacleTimeHorizon = 0.5f;
+
+		float TimeStep = 1.0f / 30.0f;
+	};
+
+	ROMANEMPIREGAME_API FVector2D ComputeVelocity(const FAgent& Agent, TConstArrayView<FObstacle> Obstacles, TConstArrayView<FNeighbour> Neighbours, const FParams& Params);
+}
@@ -2,12 +2,24 @@
 
 #include "UnitBase.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitCrowdRenderer.h"
+#include "RomanEmpireGame/Units/UnitSelectionRenderer.h"
+#include "RomanEmpireGame/Units/ProjectileManager.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/DecalComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "NavigationSystem.h"
 #include "AIController.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	const FName BlockingModifierId(TEXT("Blocking"));
+}
+
+AUnitBase::FOnSelectedUnitUpdated AUnitBase::OnSelectedUnitUpdated;
 
 AUnitBase::AUnitBase()
 {
@@ -31,10 +43,12 @@ AUnitBase::AUnitBase()
 	bUseControllerRotationRoll = false;
 
 	// Initialize state
+	UnitType = EUnitType::None;
 	OwnerFaction = EFactionID::None;
 	CurrentHealth = 100;
 	CurrentStamina = 100.0f;
 	CurrentMorale = 50;
+	bIsRouting = false;
 	bIsSelected = false;
 	bIsPossessedByPlayer = false;
 	bIsBlocking = false;
@@ -42,8 +56,15 @@ AUnitBase::AUnitBase()
 	CurrentStance = EUnitStance::Defensive;
 	bHasMoveCommand = false;
 	AttackTarget = nullptr;
+	bAutoTarget = false;
+	AutoEngageAnchor = FVector::ZeroVector;
+	DefensiveLeashDistance = 1500.0f;
+	bFallingBack = false;
 	AttackCooldown = 1.0f;
 	AttackCooldownRemaining = 0.0f;
+	bIsCrowdRepresented = false;
+	bKinematicMovement = false;
+	KinematicVelocity = FVector::ZeroVector;
 }
 
 void AUnitBase::BeginPlay()
@@ -51,18 +72,59 @@ void AUnitBase::BeginPlay()
 	Super::BeginPlay();
 	
 	// Initialize from unit data
-	CurrentHealth = UnitData.BaseStats.MaxHealth;
-	CurrentStamina = UnitData.BaseStats.Stamina;
-	CurrentMorale = UnitData.BaseStats.Morale;
+	CurrentHealth = GetStats().MaxHealth;
+	CurrentStamina = GetStats().Stamina;
+	CurrentMorale = GetStats().Morale;
 	
 	// Set movement speed from unit data
 	UCharacterMovementComponent* Movement = GetCharacterMovementComponent();
 	if (Movement)
 	{
-		Movement->MaxWalkSpeed = UnitData.BaseStats.Speed;
+		Movement->MaxWalkSpeed = GetMovementSpeed();
 	}
 	
-	UE_LOG(LogRomanEmpire, Verbose, TEXT("Unit spawned: %s"), *UnitData.DisplayName.ToString());
+	Simulation = AUnitSimulationManager::GetUnitSimulationManager(this);
+	if (Simulation.IsValid())
+	{
+		Simulation->RegisterUnit(this);
+		SetKinematicMovement(!bIsPossessedByPlayer);
+	}
+	
+	CrowdRenderer = AUnitCrowdRenderer::GetUnitCrowdRenderer(this);
+	if (CrowdRenderer.IsValid())
+	{
+		CrowdRenderer->RegisterUnit(this);
+	}
+	
+	UE_LOG(LogRomanEmpire, Verbose, TEXT("Unit spawned: %s"), *GetUnitData().DisplayName.ToString());
+}
+
+void AUnitBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bIsSelected)
+	{
+		OnSelectedUnitUpdated.Broadcast(this, true);
+	}
+
+	if (AUnitCrowdRenderer* Renderer = CrowdRenderer.Get())
+	{
+		Renderer->UnregisterUnit(this);
+	}
+	CrowdRenderer.Reset();
+
+	if (AUnitSelectionRenderer* Renderer = SelectionRenderer.Get())
+	{
+		Renderer->RemoveUnit(this);
+	}
+	SelectionRenderer.Reset();
+
+	if (AUnitSimulationManager* Sim = Simulation.Get())
+	{
+		Sim->UnregisterUnit(this);
+	}
+	Simulation.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AUnitBase::Tick(float DeltaSeconds)
@@ -85,50 +147,185 @@ void AUnitBase::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 	// Input is handled by PlayerController in FPS mode
 }
 
+FVector AUnitBase::GetVelocity() const
+{
+	return bKinematicMovement ? KinematicVelocity : Super::GetVelocity();
+}
+
 void AUnitBase::SetOwnerFaction(EFactionID NewOwner)
 {
 	OwnerFaction = NewOwner;
+
+	if (Simulation.IsValid())
+	{
+		Simulation->SetFaction(this, NewOwner);
+	}
 }
 
 void AUnitBase::SetSelected(bool bNewSelected)
 {
+	if (bIsSelected == bNewSelected)
+	{
+		return;
+	}
+
+	AUnitSelectionRenderer* Renderer = SelectionRenderer.Get();
+	SetSelectedWithRenderer(bNewSelected, Renderer ? Renderer : AUnitSelectionRenderer::GetUnitSelectionRenderer(this));
+}
+
+void AUnitBase::SetSelectedWithRenderer(bool bNewSelected, AUnitSelectionRenderer* Renderer)
+{
+	if (bIsSelected == bNewSelected)
+	{
+		return;
+	}
 	bIsSelected = bNewSelected;
-	
-	// Show/hide selection decal
-	if (SelectionDecal)
+
+	// Rings for every selected unit are drawn together as one instanced mesh
+	SelectionRenderer = Renderer;
+	if (Renderer)
 	{
-		SelectionDecal->SetVisibility(bNewSelected);
+		if (bNewSelected)
+		{
+			Renderer->AddUnit(this);
+		}
+		else
+		{
+			Renderer->RemoveUnit(this);
+		}
 	}
 }
 
 void AUnitBase::CommandMoveTo(const FVector& Destination)
 {
-	MoveDestination = Destination;
-	bHasMoveCommand = true;
-	AttackTarget = nullptr;
-	
-	// Use AI move request
-	AAIController* AIController = Cast<AAIController>(GetController());
-	if (AIController)
+	if (bIsRouting)
 	{
-		AIController->MoveToLocation(Destination, 50.0f); // 50cm acceptance radius
+		return;
 	}
+
+	SetAttackTarget(nullptr, false);
+	MoveToward(Destination);
 }
 
 void AUnitBase::CommandAttack(AActor* Target)
 {
-	AttackTarget = Target;
+	if (bIsRouting)
+	{
+		return;
+	}
+
+	SetAttackTarget(Target, false);
 	if (Target)
 	{
-		CommandMoveTo(Target->GetActorLocation());
+		MoveToward(Target->GetActorLocation());
 	}
 }
 
 void AUnitBase::CommandStop()
 {
-	bHasMoveCommand = false;
+	if (bIsRouting)
+	{
+		return;
+	}
+
+	SetAttackTarget(nullptr, false);
+	HaltMovement();
+}
+
+void AUnitBase::CommandHold()
+{
+	if (bIsRouting)
+	{
+		return;
+	}
+
+	CommandStop();
+	SetStance(EUnitStance::StandGround);
+}
+
+void AUnitBase::SetStance(EUnitStance NewStance)
+{
+	CurrentStance = NewStance;
+
+	if (Simulation.IsValid())
+	{
+		Simulation->SetStance(this, NewStance);
+	}
+}
+
+void AUnitBase::ApplyMoveOrder(const FVector& Destination)
+{
+	// The simulation has already set the destination and dropped its target flag
 	AttackTarget = nullptr;
-	
+	bAutoTarget = false;
+	bFallingBack = false;
+	MoveDestination = Destination;
+	bHasMoveCommand = true;
+}
+
+void AUnitBase::ApplyAcquiredTarget(AUnitBase* Target)
+{
+	if (bIsRouting || !Target || AttackTarget)
+	{
+		return;
+	}
+
+	AutoEngageAnchor = GetActorLocation();
+	SetAttackTarget(Target, true);
+}
+
+void AUnitBase::ApplyFallBack(const FVector& Destination)
+{
+	if (bIsRouting)
+	{
+		return;
+	}
+
+	bFallingBack = true;
+	MoveToward(Destination);
+}
+
+void AUnitBase::SetAttackTarget(AActor* Target, bool bAuto)
+{
+	AttackTarget = Target;
+	bAutoTarget = Target && bAuto;
+	bFallingBack = false;
+
+	if (Simulation.IsValid())
+	{
+		Simulation->SetHasTarget(this, Target != nullptr);
+	}
+}
+
+void AUnitBase::MoveToward(const FVector& Destination)
+{
+	MoveDestination = Destination;
+	bHasMoveCommand = true;
+
+	if (bKinematicMovement && Simulation.IsValid())
+	{
+		Simulation->SetDestination(this, Destination);
+		return;
+	}
+
+	// Use AI move request
+	AAIController* AIController = Cast<AAIController>(GetController());
+	if (AIController)
+	{
+		AIController->MoveToLocation(Destination, 50.0f); // 50cm acceptance radius
+	}
+}
+
+void AUnitBase::HaltMovement()
+{
+	bHasMoveCommand = false;
+	bFallingBack = false;
+
+	if (Simulation.IsValid())
+	{
+		Simulation->ClearDestination(this);
+	}
+
 	AAIController* AIController = Cast<AAIController>(GetController());
 	if (AIController)
 	{
@@ -136,10 +333,21 @@ void AUnitBase::CommandStop()
 	}
 }
 
-void AUnitBase::CommandHold()
+void AUnitBase::FaceTarget(const AActor* Target)
 {
-	CommandStop();
-	CurrentStance = EUnitStance::StandGround;
+	const FVector ToTarget = Target->GetActorLocation() - GetActorLocation();
+	if (ToTarget.SizeSquared2D() < KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	const float Yaw = ToTarget.Rotation().Yaw;
+	SetActorRotation(FRotator(0.0f, Yaw, 0.0f));
+
+	if (bKinematicMovement && Simulation.IsValid())
+	{
+		Simulation->SetYaw(this, Yaw);
+	}
 }
 
 void AUnitBase::MoveInput(const FVector2D& InputVector)
@@ -187,12 +395,12 @@ void AUnitBase::PerformAttack()
 	}
 
 	bIsAttacking = true;
-	AttackCooldownRemaining = AttackCooldown / UnitData.BaseStats.AttackSpeed;
+	AttackCooldownRemaining = AttackCooldown / GetStats().AttackSpeed;
 	CurrentStamina -= 10.0f;
 
 	// Perform melee attack trace
 	FVector Start = GetActorLocation() + FVector(0, 0, 80);
-	FVector End = Start + GetActorForwardVector() * UnitData.AttackRange;
+	FVector End = Start + GetActorForwardVector() * GetUnitData().AttackRange;
 
 	FHitResult HitResult;
 	FCollisionQueryParams Params;
@@ -205,7 +413,7 @@ void AUnitBase::PerformAttack()
 			// Check if enemy
 			if (HitUnit->GetOwnerFaction() != OwnerFaction)
 			{
-				float Damage = UnitData.BaseStats.MeleeAttack;
+				float Damage = GetStats().MeleeAttack;
 				HitUnit->TakeCombatDamage(Damage, this, false);
 			}
 		}
@@ -216,33 +424,58 @@ void AUnitBase::PerformAttack()
 	UE_LOG(LogRomanEmpire, Verbose, TEXT("Unit %s attacking"), *GetName());
 }
 
+bool AUnitBase::IsRangedUnit() const
+{
+	return GetUnitData().bCanUseRanged && AProjectileManager::GetProjectileTypeForUnit(UnitType) != EProjectileType::None;
+}
+
+bool AUnitBase::PerformRangedAttack(AActor* Target)
+{
+	if (!Target || !IsRangedUnit() || AttackCooldownRemaining > 0.0f)
+	{
+		return false;
+	}
+
+	const EProjectileType ProjectileType = AProjectileManager::GetProjectileTypeForUnit(UnitType);
+
+	AProjectileManager* Projectiles = AProjectileManager::GetProjectileManager(this);
+	if (!Projectiles)
+	{
+		return false;
+	}
+
+	const FVector Start = GetActorLocation() + FVector(0, 0, 80);
+	const float Damage = GetStats().RangedAttack;
+	if (!Projectiles->LaunchAtTarget(ProjectileType, this, OwnerFaction, Start, Target->GetActorLocation(), Damage))
+	{
+		return false;
+	}
+
+	bIsAttacking = true;
+	AttackCooldownRemaining = AttackCooldown / GetStats().AttackSpeed;
+
+	UE_LOG(LogRomanEmpire, Verbose, TEXT("Unit %s shooting at %s"), *GetName(), *Target->GetName());
+	return true;
+}
+
 void AUnitBase::StartBlocking()
 {
-	if (!UnitData.bHasShield)
+	if (!GetUnitData().bHasShield)
 	{
 		return;
 	}
 
 	bIsBlocking = true;
-	
-	// Reduce movement speed while blocking
-	UCharacterMovementComponent* Movement = GetCharacterMovementComponent();
-	if (Movement)
-	{
-		Movement->MaxWalkSpeed = UnitData.BaseStats.Speed * 0.5f;
-	}
+
+	// Shield raised; movement slows while blocking
+	AddStatModifier(FUnitStatModifier(BlockingModifierId, EStatModifierSource::Stance, EUnitStat::Speed, 0.0f, 0.5f));
 }
 
 void AUnitBase::StopBlocking()
 {
 	bIsBlocking = false;
-	
-	// Restore movement speed
-	UCharacterMovementComponent* Movement = GetCharacterMovementComponent();
-	if (Movement)
-	{
-		Movement->MaxWalkSpeed = UnitData.BaseStats.Speed;
-	}
+
+	RemoveStatModifier(BlockingModifierId);
 }
 
 void AUnitBase::PerformDodge(const FVector2D& Direction)
@@ -257,7 +490,7 @@ void AUnitBase::PerformDodge(const FVector2D& Direction)
 	// Launch in direction
 	FVector DodgeVector = GetActorRightVector() * Direction.X + GetActorForwardVector() * Direction.Y;
 	DodgeVector.Normalize();
-	DodgeVector *= 500.0f * UnitData.BaseStats.DodgeSpeed;
+	DodgeVector *= 500.0f * GetStats().DodgeSpeed;
 	DodgeVector.Z = 100.0f; // Slight upward push
 
 	LaunchCharacter(DodgeVector, true, true);
@@ -271,37 +504,43 @@ void AUnitBase::TakeCombatDamage(float Damage, AActor* DamageSource, bool bIsRan
 	}
 
 	// Calculate damage reduction from armor and blocking
-	float ActualDamage = CalculateDamageReduction(Damage, bIsRanged);
+	float ActualDamage = CalculateDamageReduction(Damage, DamageSource, bIsRanged);
 
 	CurrentHealth = FMath::Max(0, CurrentHealth - FMath::RoundToInt(ActualDamage));
 	
-	// Reduce morale when taking damage
-	CurrentMorale = FMath::Max(0, CurrentMorale - FMath::RoundToInt(ActualDamage * 0.1f));
+	// Reduce morale when taking damage; the simulation keeps the fractional value and decides when the unit breaks
+	const float MoraleLoss = ActualDamage * 0.1f;
+	if (!Simulation.IsValid() || !Simulation->ApplyMoraleDelta(this, -MoraleLoss))
+	{
+		CurrentMorale = FMath::Max(0, CurrentMorale - FMath::RoundToInt(MoraleLoss));
+	}
 
 	OnUnitDamaged.Broadcast(this, ActualDamage);
 
+	if (bIsSelected)
+	{
+		OnSelectedUnitUpdated.Broadcast(this, false);
+	}
+
 	if (CurrentHealth <= 0)
 	{
 		OnDeath();
 	}
 }
 
-float AUnitBase::CalculateDamageReduction(float RawDamage, bool bIsRanged) const
+float AUnitBase::CalculateDamageReduction(float RawDamage, const AActor* DamageSource, bool bIsRanged) const
 {
-	float Defense = bIsRanged ? UnitData.BaseStats.RangedDefense : UnitData.BaseStats.MeleeDefense;
-	float ArmorReduction = UnitData.BaseStats.Armor;
+	// Blocking reduces melee damage significantly
+	const bool bBlocked = bIsBlocking && !bIsRanged;
 
-	// Blocking reduces damage significantly
-	if (bIsBlocking && !bIsRanged)
+	// Faction bonuses and defences are cached per unit type by the simulation
+	if (AUnitSimulationManager* Sim = Simulation.Get())
 	{
-		Defense += 20 * UnitData.BaseStats.BlockStrength;
+		return Sim->ResolveDamage(Cast<AUnitBase>(DamageSource), this, RawDamage, bIsRanged, bBlocked);
 	}
 
-	// Apply defense and armor
-	float DamageMultiplier = 100.0f / (100.0f + Defense);
-	float FinalDamage = (RawDamage * DamageMultiplier) - ArmorReduction;
-
-	return FMath::Max(1.0f, FinalDamage); // Minimum 1 damage
+	const uint8 HitKind = (bIsRanged ? FUnitDamageTable::HitRanged : 0) | (bBlocked ? FUnitDamageTable::HitBlocking : 0);
+	return FUnitDamageTable::ComputeDamage(RawDamage, 1.0f, GetStats(), HitKind);
 }
 
 void AUnitBase::SetPossessedByPlayer(bool bPossessed)
@@ -317,22 +556,283 @@ void AUnitBase::SetPossessedByPlayer(bool bPossessed)
 		// Stop AI movement when possessed
 		CommandStop();
 	}
+
+	// Full character movement only while the player drives the unit
+	SetKinematicMovement(!bPossessed);
+}
+
+float AUnitBase::GetMovementSpeed() const
+{
+	return GetStats().Speed;
+}
+
+void AUnitBase::AddStatModifier(const FUnitStatModifier& Modifier)
+{
+	if (StatModifiers.Add(Modifier))
+	{
+		OnStatsChanged();
+	}
+}
+
+void AUnitBase::RemoveStatModifier(FName Id)
+{
+	if (StatModifiers.Remove(Id))
+	{
+		OnStatsChanged();
+	}
+}
+
+void AUnitBase::RemoveStatModifiersFromSource(EStatModifierSource Source)
+{
+	if (StatModifiers.RemoveAllFromSource(Source))
+	{
+		OnStatsChanged();
+	}
+}
+
+void AUnitBase::AddStatModifierToUnits(const TArray<AUnitBase*>& Units, const FUnitStatModifier& Modifier)
+{
+	TArray<AUnitBase*> Changed;
+	for (AUnitBase* Unit : Units)
+	{
+		if (IsValid(Unit) && Unit->StatModifiers.Add(Modifier))
+		{
+			Changed.Add(Unit);
+		}
+	}
+	RecomputeStats(Changed);
+}
+
+void AUnitBase::RemoveStatModifierFromUnits(const TArray<AUnitBase*>& Units, FName Id)
+{
+	TArray<AUnitBase*> Changed;
+	for (AUnitBase* Unit : Units)
+	{
+		if (IsValid(Unit) && Unit->StatModifiers.Remove(Id))
+		{
+			Changed.Add(Unit);
+		}
+	}
+	RecomputeStats(Changed);
+}
+
+void AUnitBase::RecomputeStats(const TArray<AUnitBase*>& Units)
+{
+	// Each stack only touches its own unit, so a whole regiment is rebuilt in parallel before the game-thread follow-up
+	ParallelFor(Units.Num(), [&Units](int32 Index)
+	{
+		const AUnitBase* Unit = Units[Index];
+		Unit->StatModifiers.Recompute(Unit->GetUnitData().BaseStats);
+	});
+
+	for (AUnitBase* Unit : Units)
+	{
+		Unit->OnStatsChanged();
+	}
+}
+
+void AUnitBase::OnStatsChanged()
+{
+	const FUnitStats& Stats = GetStats();
+	CurrentHealth = FMath::Min(CurrentHealth, Stats.MaxHealth);
+	CurrentStamina = FMath::Min(CurrentStamina, Stats.Stamina);
+	CurrentMorale = FMath::Min(CurrentMorale, Stats.Morale);
+
+	RefreshMovementSpeed();
+
+	// Morale recovers toward, and is capped at, the modified stat
+	if (Simulation.IsValid())
+	{
+		Simulation->SetBaseMorale(this, Stats.Morale);
+	}
+
+	// Max health may have changed, and with it the health percent
+	if (bIsSelected)
+	{
+		OnSelectedUnitUpdated.Broadcast(this, false);
+	}
+}
+
+void AUnitBase::RefreshMovementSpeed()
+{
+	const float Speed = GetMovementSpeed();
+
+	if (UCharacterMovementComponent* Movement = GetCharacterMovementComponent())
+	{
+		Movement->MaxWalkSpeed = Speed;
+	}
+
+	if (Simulation.IsValid())
+	{
+		Simulation->SetMaxSpeed(this, Speed);
+	}
+}
+
+void AUnitBase::SetKinematicMovement(bool bKinematic)
+{
+	if (!Simulation.IsValid())
+	{
+		bKinematic = false;
+	}
+
+	if (bKinematicMovement == bKinematic)
+	{
+		return;
+	}
+
+	bKinematicMovement = bKinematic;
+	KinematicVelocity = FVector::ZeroVector;
+
+	UCharacterMovementComponent* Movement = GetCharacterMovementComponent();
+	if (bKinematic)
+	{
+		// Hand over from any path the AI controller was following
+		if (AAIController* AIController = Cast<AAIController>(GetController()))
+		{
+			AIController->StopMovement();
+		}
+
+		if (Movement)
+		{
+			Movement->StopMovementImmediately();
+			Movement->SetComponentTickEnabled(false);
+		}
+	}
+	else if (Movement)
+	{
+		Movement->SetComponentTickEnabled(true);
+		Movement->SetMovementMode(MOVE_Walking);
+	}
+
+	if (Simulation.IsValid())
+	{
+		Simulation->SetKinematic(this, bKinematic);
+	}
+}
+
+void AUnitBase::ApplyKinematicMove(const FVector& Location, float Yaw, const FVector& Velocity)
+{
+	KinematicVelocity = Velocity;
+	SetActorLocationAndRotation(Location, FRotator(0.0f, Yaw, 0.0f), false, nullptr, ETeleportType::None);
+}
+
+void AUnitBase::ApplyMorale(int32 NewMorale)
+{
+	CurrentMorale = NewMorale;
+}
+
+void AUnitBase::ApplyRouting(bool bRouting)
+{
+	if (bIsRouting == bRouting)
+	{
+		return;
+	}
+
+	bIsRouting = bRouting;
+
+	// Whatever the unit was doing is abandoned; the simulation owns its movement until it rallies
+	bHasMoveCommand = false;
+	SetAttackTarget(nullptr, false);
+
+	UE_LOG(LogRomanEmpire, Verbose, TEXT("Unit %s %s"), *GetName(), bRouting ? TEXT("is routing") : TEXT("rallied"));
+
+	OnUnitRoutChanged.Broadcast(this, bRouting);
+}
+
+void AUnitBase::SetCrowdRepresentation(bool bCrowd)
+{
+	if (bIsCrowdRepresented == bCrowd)
+	{
+		return;
+	}
+
+	bIsCrowdRepresented = bCrowd;
+
+	// Skinning and animation are the bulk of a distant unit's cost; movement and combat keep running
+	if (USkeletalMeshComponent* SkeletalMesh = GetMesh())
+	{
+		SkeletalMesh->SetVisibility(!bCrowd, true);
+		SkeletalMesh->SetComponentTickEnabled(!bCrowd);
+	}
 }
 
 void AUnitBase::UpdateAIMovement(float DeltaSeconds)
 {
-	// Check if we have an attack target and are in range
-	if (AttackTarget && IsValid(AttackTarget))
+	if (!AttackTarget || bIsRouting)
 	{
-		float Distance = FVector::Distance(GetActorLocation(), AttackTarget->GetActorLocation());
-		
-		if (Distance <= UnitData.AttackRange)
+		return;
+	}
+
+	const AUnitBase* TargetUnit = Cast<AUnitBase>(AttackTarget);
+	if (!IsValid(AttackTarget) || (TargetUnit && !TargetUnit->IsAlive()))
+	{
+		// Target gone; a defensive unit walks back to where it was standing
+		const bool bReturn = bAutoTarget && CurrentStance == EUnitStance::Defensive;
+		SetAttackTarget(nullptr, false);
+		HaltMovement();
+		if (bReturn)
+		{
+			MoveToward(AutoEngageAnchor);
+		}
+		return;
+	}
+
+	// Skirmishers finish giving ground before turning to shoot
+	const bool bMoving = bKinematicMovement && Simulation.IsValid() ? Simulation->HasDestination(this) : bHasMoveCommand;
+	if (bFallingBack)
+	{
+		if (bMoving)
+		{
+			return;
+		}
+		bFallingBack = false;
+	}
+
+	const FVector TargetLocation = AttackTarget->GetActorLocation();
+	const float Distance = FVector::Dist2D(GetActorLocation(), TargetLocation);
+
+	if (Distance <= GetUnitData().AttackRange)
+	{
+		// In attack range - stop and attack
+		if (!IsRangedUnit())
 		{
-			// In attack range - stop and attack
-			CommandStop();
+			HaltMovement();
+			FaceTarget(AttackTarget);
 			PerformAttack();
+			return;
+		}
+
+		// Ranged units never swing from range; with no ballistic solution they keep closing below
+		FaceTarget(AttackTarget);
+		if (AttackCooldownRemaining > 0.0f || PerformRangedAttack(AttackTarget))
+		{
+			HaltMovement();
+			return;
+		}
+	}
+
+	if (bAutoTarget)
+	{
+		// Acquired targets are only pursued as far as the stance allows
+		const bool bBeyondLeash = CurrentStance == EUnitStance::Defensive
+			&& FVector::Dist2D(GetActorLocation(), AutoEngageAnchor) > DefensiveLeashDistance;
+		if (CurrentStance == EUnitStance::StandGround || bBeyondLeash)
+		{
+			SetAttackTarget(nullptr, false);
+			HaltMovement();
+			if (bBeyondLeash)
+			{
+				MoveToward(AutoEngageAnchor);
+			}
+			return;
 		}
 	}
+
+	// Chase; the destination is refreshed once the previous one is reached or the target has moved away from it
+	if (!bMoving || FVector::DistSquared2D(MoveDestination, TargetLocation) > FMath::Square(GetUnitData().AttackRange))
+	{
+		MoveToward(TargetLocation);
+	}
 }
 
 void AUnitBase::UpdateCombatCooldowns(float DeltaSeconds)
@@ -354,7 +854,7 @@ void AUnitBase::UpdateStamina(float DeltaSeconds)
 	if (!bIsBlocking && !bIsAttacking)
 	{
 		float RegenRate = 10.0f; // Stamina per second
-		CurrentStamina = FMath::Min(UnitData.BaseStats.Stamina, CurrentStamina + RegenRate * DeltaSeconds);
+		CurrentStamina = FMath::Min(GetStats().Stamina, CurrentStamina + RegenRate * DeltaSeconds);
 	}
 }
 
@@ -364,6 +864,25 @@ void AUnitBase::OnDeath()
 	
 	OnUnitDied.Broadcast(this);
 	
+	// Dead units shake nearby comrades, then leave the simulation so they stop moving and drop out of neighbour queries
+	if (AUnitSimulationManager* Sim = Simulation.Get())
+	{
+		Sim->NotifyUnitDied(this);
+		Sim->UnregisterUnit(this);
+	}
+	bKinematicMovement = false;
+
+	// Leave the selection now rather than at EndPlay, so no ring is drawn over the hidden body for its lifespan
+	if (bIsSelected)
+	{
+		OnSelectedUnitUpdated.Broadcast(this, true);
+	}
+	if (AUnitSelectionRenderer* Renderer = SelectionRenderer.Get())
+	{
+		Renderer->RemoveUnit(this);
+	}
+	bIsSelected = false;
+	
 	// TODO: Play death animation, spawn ragdoll
 	SetActorEnableCollision(false);
 	SetActorHiddenInGame(true);
@@ -5,11 +5,16 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "RomanEmpireGame/Units/UnitTypes.h"
+#include "RomanEmpireGame/Units/UnitStatModifiers.h"
+#include "RomanEmpireGame/Units/UnitTypeRegistry.h"
 #include "RomanEmpireGame/Faction/FactionData.h"
 #include "UnitBase.generated.h"
 
 class UCapsuleComponent;
 class USkeletalMeshComponent;
+class AUnitCrowdRenderer;
+class AUnitSelectionRenderer;
+class AUnitSimulationManager;
 
 /**
  * Base class for all military units in the game
@@ -24,15 +29,45 @@ public:
 	AUnitBase();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaSeconds) override;
 	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
+	virtual FVector GetVelocity() const override;
 
-	// Unit info
-	UFUNCTION(BlueprintPure, Category = "Unit")
-	FUnitData GetUnitData() const { return UnitData; }
+	// Unit info - shared by every unit of the type through the unit type registry
+	const FUnitData& GetUnitData() const { return FUnitTypeRegistry::Get().GetUnitData(UnitType); }
+
+	UFUNCTION(BlueprintPure, Category = "Unit", meta = (DisplayName = "Get Unit Data"))
+	FUnitData K2_GetUnitData() const { return GetUnitData(); }
 
 	UFUNCTION(BlueprintPure, Category = "Unit")
-	EUnitType GetUnitType() const { return UnitData.UnitType; }
+	EUnitType GetUnitType() const { return UnitType; }
+
+	// Base stats with every active modifier applied
+	const FUnitStats& GetStats() const { return StatModifiers.GetEffectiveStats(GetUnitData().BaseStats); }
+
+	UFUNCTION(BlueprintPure, Category = "Unit|Stats")
+	FUnitStats GetEffectiveStats() const { return GetStats(); }
+
+	// Stat modifiers - formation, stance, terrain, buildings and abilities; base data is never changed
+	UFUNCTION(BlueprintCallable, Category = "Unit|Stats")
+	void AddStatModifier(const FUnitStatModifier& Modifier);
+
+	UFUNCTION(BlueprintCallable, Category = "Unit|Stats")
+	void RemoveStatModifier(FName Id);
+
+	UFUNCTION(BlueprintCallable, Category = "Unit|Stats")
+	void RemoveStatModifiersFromSource(EStatModifierSource Source);
+
+	UFUNCTION(BlueprintPure, Category = "Unit|Stats")
+	bool HasStatModifier(FName Id) const { return StatModifiers.Contains(Id); }
+
+	// Applies one change to a whole regiment and rebuilds their stats in one batch
+	UFUNCTION(BlueprintCallable, Category = "Unit|Stats")
+	static void AddStatModifierToUnits(const TArray<AUnitBase*>& Units, const FUnitStatModifier& Modifier);
+
+	UFUNCTION(BlueprintCallable, Category = "Unit|Stats")
+	static void RemoveStatModifierFromUnits(const TArray<AUnitBase*>& Units, FName Id);
 
 	// Ownership
 	UFUNCTION(BlueprintPure, Category = "Unit")
@@ -45,9 +80,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Unit|Selection")
 	void SetSelected(bool bNewSelected);
 
+	// SetSelected with the ring renderer already resolved, for callers changing many units at once
+	void SetSelectedWithRenderer(bool bNewSelected, AUnitSelectionRenderer* Renderer);
+
 	UFUNCTION(BlueprintPure, Category = "Unit|Selection")
 	bool IsSelected() const { return bIsSelected; }
 
+	// Fired only for selected units whose health changes or that leave play, so selections stay current without polling
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnSelectedUnitUpdated, AUnitBase* /*Unit*/, bool /*bLeavingPlay*/);
+	static FOnSelectedUnitUpdated OnSelectedUnitUpdated;
+
 	// Commands (RTS mode)
 	UFUNCTION(BlueprintCallable, Category = "Unit|Commands")
 	void CommandMoveTo(const FVector& Destination);
@@ -61,6 +103,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Unit|Commands")
 	void CommandHold();
 
+	// Stance decides how far an idle unit looks for enemies and whether it chases them
+	UFUNCTION(BlueprintCallable, Category = "Unit|Commands")
+	void SetStance(EUnitStance NewStance);
+
+	UFUNCTION(BlueprintPure, Category = "Unit|Commands")
+	EUnitStance GetStance() const { return CurrentStance; }
+
+	UFUNCTION(BlueprintPure, Category = "Unit|Commands")
+	AActor* GetAttackTarget() const { return AttackTarget; }
+
+	// Called by the unit simulation when a batched move order reaches the unit
+	void ApplyMoveOrder(const FVector& Destination);
+
+	// Called by the unit simulation's target acquisition
+	void ApplyAcquiredTarget(AUnitBase* Target);
+	void ApplyFallBack(const FVector& Destination);
+
 	// FPS Mode input
 	UFUNCTION(BlueprintCallable, Category = "Unit|FPS")
 	void MoveInput(const FVector2D& InputVector);
@@ -71,6 +130,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Unit|FPS")
 	void PerformAttack();
 
+	// Looses this unit type's projectile at Target; returns false for melee units, on cooldown or out of reach
+	UFUNCTION(BlueprintCallable, Category = "Unit|Combat")
+	bool PerformRangedAttack(AActor* Target);
+
+	// Fights with projectiles rather than melee
+	UFUNCTION(BlueprintPure, Category = "Unit|Combat")
+	bool IsRangedUnit() const;
+
 	UFUNCTION(BlueprintCallable, Category = "Unit|FPS")
 	void StartBlocking();
 
@@ -85,14 +152,29 @@ public:
 	void TakeCombatDamage(float Damage, AActor* DamageSource, bool bIsRanged);
 
 	UFUNCTION(BlueprintPure, Category = "Unit|Health")
-	float GetHealthPercent() const { return (float)CurrentHealth / (float)UnitData.BaseStats.MaxHealth; }
+	float GetHealthPercent() const { return (float)CurrentHealth / (float)GetStats().MaxHealth; }
 
 	UFUNCTION(BlueprintPure, Category = "Unit|Health")
 	bool IsAlive() const { return CurrentHealth > 0; }
 
+	// Morale
+	UFUNCTION(BlueprintPure, Category = "Unit|Morale")
+	int32 GetMorale() const { return CurrentMorale; }
+
+	UFUNCTION(BlueprintPure, Category = "Unit|Morale")
+	float GetMoralePercent() const { return (float)CurrentMorale / (float)FMath::Max(1, GetStats().Morale); }
+
+	// Routing units flee and ignore commands until they rally
+	UFUNCTION(BlueprintPure, Category = "Unit|Morale")
+	bool IsRouting() const { return bIsRouting; }
+
+	// Called by the unit simulation's morale pass
+	void ApplyMorale(int32 NewMorale);
+	void ApplyRouting(bool bRouting);
+
 	// Stamina (FPS mode)
 	UFUNCTION(BlueprintPure, Category = "Unit|FPS")
-	float GetStaminaPercent() const { return CurrentStamina / UnitData.BaseStats.Stamina; }
+	float GetStaminaPercent() const { return CurrentStamina / GetStats().Stamina; }
 
 	// State
 	UFUNCTION(BlueprintPure, Category = "Unit")
@@ -101,10 +183,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Unit")
 	void SetPossessedByPlayer(bool bPossessed);
 
+	// Movement - AI-controlled units are moved by the unit simulation, possessed units by CharacterMovementComponent
+	UFUNCTION(BlueprintPure, Category = "Unit|Movement")
+	bool IsKinematicMovement() const { return bKinematicMovement; }
+
+	// Current top speed including blocking and formation penalties
+	UFUNCTION(BlueprintPure, Category = "Unit|Movement")
+	virtual float GetMovementSpeed() const;
+
+	// Called by the unit simulation with the result of its movement step
+	void ApplyKinematicMove(const FVector& Location, float Yaw, const FVector& Velocity);
+
+	// Crowd rendering - the skeletal mesh is hidden and the crowd renderer draws an instance instead
+	void SetCrowdRepresentation(bool bCrowd);
+
+	UFUNCTION(BlueprintPure, Category = "Unit|Rendering")
+	bool IsCrowdRepresented() const { return bIsCrowdRepresented; }
+
 protected:
-	// Unit data
+	// Index into the unit type registry; per-type data is never copied onto the unit
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Unit")
-	FUnitData UnitData;
+	EUnitType UnitType;
 
 	// State
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Unit|State")
@@ -119,6 +218,9 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Unit|State")
 	int32 CurrentMorale;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Unit|State")
+	bool bIsRouting;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Unit|State")
 	bool bIsSelected;
 
@@ -144,9 +246,17 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Unit|AI")
 	AActor* AttackTarget;
 
-	// Selection indicator
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
-	UDecalComponent* SelectionDecal;
+	// Target was picked by acquisition rather than ordered, so stance rules may drop it
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Unit|AI")
+	bool bAutoTarget;
+
+	// Where an auto-engagement started; defensive units return here
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Unit|AI")
+	FVector AutoEngageAnchor;
+
+	// How far a defensive unit pursues an acquired target from its anchor
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Unit|AI")
+	float DefensiveLeashDistance;
 
 	// Combat
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Unit|Combat")
@@ -158,6 +268,7 @@ protected:
 	// Events
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnUnitDamaged, AUnitBase*, Unit, float, Damage);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnUnitDied, AUnitBase*, Unit);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnUnitRoutChanged, AUnitBase*, Unit, bool, bRouting);
 
 	UPROPERTY(BlueprintAssignable, Category = "Unit|Events")
 	FOnUnitDamaged OnUnitDamaged;
@@ -165,10 +276,51 @@ protected:
 	UPROPERTY(BlueprintAssignable, Category = "Unit|Events")
 	FOnUnitDied OnUnitDied;
 
+	UPROPERTY(BlueprintAssignable, Category = "Unit|Events")
+	FOnUnitRoutChanged OnUnitRoutChanged;
+
 	// Internal
 	virtual void UpdateAIMovement(float DeltaSeconds);
 	virtual void UpdateCombatCooldowns(float DeltaSeconds);
 	virtual void UpdateStamina(float DeltaSeconds);
 	virtual void OnDeath();
-	float CalculateDamageReduction(float RawDamage, bool bIsRanged) const;
+	float CalculateDamageReduction(float RawDamage, const AActor* DamageSource, bool bIsRanged) const;
+
+	// Pushes GetMovementSpeed() to whichever movement model is active
+	void RefreshMovementSpeed();
+
+	// Follows up a change to the effective stats: clamps pools and refreshes speed
+	virtual void OnStatsChanged();
+
+private:
+	bool bIsCrowdRepresented;
+
+	bool bKinematicMovement;
+
+	FVector KinematicVelocity;
+
+	TWeakObjectPtr<AUnitSimulationManager> Simulation;
+
+	TWeakObjectPtr<AUnitCrowdRenderer> CrowdRenderer;
+
+	// Renderer drawing this unit's ring while it is selected
+	TWeakObjectPtr<AUnitSelectionRenderer> SelectionRenderer;
+
+	FUnitStatModifierStack StatModifiers;
+
+	static void RecomputeStats(const TArray<AUnitBase*>& Units);
+
+	// Skirmisher giving ground; it shoots again once it arrives
+	bool bFallingBack;
+
+	void SetKinematicMovement(bool bKinematic);
+	void SetAttackTarget(AActor* Target, bool bAuto);
+
+	// Moves without touching the attack target
+	void MoveToward(const FVector& Destination);
+
+	// Stops moving but keeps the attack target
+	void HaltMovement();
+
+	void FaceTarget(const AActor* Target);
 };
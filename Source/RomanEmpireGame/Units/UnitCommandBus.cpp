@@ -0,0 +1,446 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitCommandBus.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unit Command Dispatch"), STAT_UnitCommandDispatch, STATGROUP_RomanEmpire);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Command Latency (ms)"), STAT_UnitCommandLatency, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Commands Dispatched"), STAT_UnitCommandsDispatched, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Commanded Units"), STAT_CommandedUnits, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Waypoints"), STAT_QueuedWaypoints, STATGROUP_RomanEmpire);
+
+AUnitCommandBus::AUnitCommandBus()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	FormationSpacing = 150.0f;
+	LineWidth = 20;
+	ColumnWidth = 4;
+	MaxQueuedWaypoints = 16;
+	NextCommandId = 0;
+	LastOrderLatency = 0.0f;
+}
+
+void AUnitCommandBus::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Orders issued during input reach the simulation in the same frame's step
+	Simulation = AUnitSimulationManager::GetUnitSimulationManager(this);
+	if (AUnitSimulationManager* Sim = Simulation.Get())
+	{
+		Sim->AddTickPrerequisiteActor(this);
+	}
+}
+
+void AUnitCommandBus::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_UnitCommandDispatch);
+
+	int32 NumUnits = 0;
+	for (const FCommandRecord& Command : PendingCommands)
+	{
+		Dispatch(Command);
+		NumUnits += Command.Units.Num();
+	}
+
+	if (PendingCommands.Num() > 0)
+	{
+		LastOrderLatency = static_cast<float>(FPlatformTime::Seconds() - PendingCommands.Last().IssueTime);
+		SET_FLOAT_STAT(STAT_UnitCommandLatency, LastOrderLatency * 1000.0f);
+	}
+	SET_DWORD_STAT(STAT_UnitCommandsDispatched, PendingCommands.Num());
+	SET_DWORD_STAT(STAT_CommandedUnits, NumUnits);
+	PendingCommands.Reset();
+
+	AdvanceWaypoints();
+}
+
+AUnitCommandBus::FCommandRecord& AUnitCommandBus::AddCommand(EUnitCommandType Type, const TArray<AUnitBase*>& Units)
+{
+	FCommandRecord& Command = PendingCommands.AddDefaulted_GetRef();
+	Command.Id = NextCommandId++;
+	Command.Type = Type;
+	Command.Location = FVector::ZeroVector;
+	Command.Formation = EFormationType::None;
+	Command.bQueue = false;
+	Command.Stance = EUnitStance::Defensive;
+	Command.IssueTime = FPlatformTime::Seconds();
+
+	Command.Units.Reserve(Units.Num());
+	for (AUnitBase* Unit : Units)
+	{
+		if (Unit)
+		{
+			Command.Units.Add(Unit);
+		}
+	}
+	return Command;
+}
+
+int32 AUnitCommandBus::IssueMove(const TArray<AUnitBase*>& Units, const FVector& Destination, EFormationType Formation, bool bQueue)
+{
+	if (Units.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	FCommandRecord& Command = AddCommand(EUnitCommandType::Move, Units);
+	Command.Location = Destination;
+	Command.Formation = Formation;
+	Command.bQueue = bQueue;
+	return Command.Id;
+}
+
+int32 AUnitCommandBus::IssueAttack(const TArray<AUnitBase*>& Units, AActor* Target)
+{
+	if (Units.Num() == 0 || !Target)
+	{
+		return INDEX_NONE;
+	}
+
+	FCommandRecord& Command = AddCommand(EUnitCommandType::Attack, Units);
+	Command.Target = Target;
+	return Command.Id;
+}
+
+int32 AUnitCommandBus::IssueStop(const TArray<AUnitBase*>& Units)
+{
+	return Units.Num() > 0 ? AddCommand(EUnitCommandType::Stop, Units).Id : INDEX_NONE;
+}
+
+int32 AUnitCommandBus::IssueHold(const TArray<AUnitBase*>& Units)
+{
+	return Units.Num() > 0 ? AddCommand(EUnitCommandType::Hold, Units).Id : INDEX_NONE;
+}
+
+int32 AUnitCommandBus::IssueStance(const TArray<AUnitBase*>& Units, EUnitStance Stance)
+{
+	if (Units.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	FCommandRecord& Command = AddCommand(EUnitCommandType::Stance, Units);
+	Command.Stance = Stance;
+	return Command.Id;
+}
+
+int32 AUnitCommandBus::GetNumQueuedWaypoints(AUnitBase* Unit) const
+{
+	const TArray<FVector>* Queue = Waypoints.Find(Unit);
+	return Queue ? Queue->Num() : 0;
+}
+
+void AUnitCommandBus::Dispatch(const FCommandRecord& Command)
+{
+	// Dead and broken units are dropped from the order as it lands
+	CommandUnits.Reset();
+	for (const TWeakObjectPtr<AUnitBase>& Weak : Command.Units)
+	{
+		AUnitBase* Unit = Weak.Get();
+		if (Unit && Unit->IsAlive() && !Unit->IsRouting())
+		{
+			CommandUnits.Add(Unit);
+		}
+	}
+
+	switch (Command.Type)
+	{
+	case EUnitCommandType::Move:
+		DispatchMove(Command);
+		break;
+
+	case EUnitCommandType::Attack:
+		if (AActor* Target = Command.Target.Get())
+		{
+			for (AUnitBase* Unit : CommandUnits)
+			{
+				Waypoints.Remove(Unit);
+				Unit->CommandAttack(Target);
+			}
+		}
+		break;
+
+	case EUnitCommandType::Stop:
+		for (AUnitBase* Unit : CommandUnits)
+		{
+			Waypoints.Remove(Unit);
+			Unit->CommandStop();
+		}
+		break;
+
+	case EUnitCommandType::Hold:
+		for (AUnitBase* Unit : CommandUnits)
+		{
+			Waypoints.Remove(Unit);
+			Unit->CommandHold();
+		}
+		break;
+
+	case EUnitCommandType::Stance:
+		for (AUnitBase* Unit : CommandUnits)
+		{
+			Unit->SetStance(Command.Stance);
+		}
+		break;
+	}
+}
+
+void AUnitCommandBus::DispatchMove(const FCommandRecord& Command)
+{
+	if (CommandUnits.Num() == 0)
+	{
+		return;
+	}
+
+	ComputeFormationSlots(Command.Location, Command.Formation);
+
+	AUnitSimulationManager* Sim = Simulation.Get();
+	for (int32 Index = 0; Index < CommandUnits.Num(); ++Index)
+	{
+		AUnitBase* Unit = CommandUnits[Index];
+		const FVector& Slot = FormationSlots[Index];
+
+		if (Command.bQueue && Sim && Unit->IsKinematicMovement())
+		{
+			// Shift-click: walk there after whatever the unit is already doing
+			TArray<FVector>* Queue = Waypoints.Find(Unit);
+			if (Queue || Sim->HasDestination(Unit) || Unit->GetAttackTarget())
+			{
+				TArray<FVector>& Pending = Queue ? *Queue : Waypoints.Add(Unit);
+				if (Pending.Num() < MaxQueuedWaypoints)
+				{
+					Pending.Add(Slot);
+				}
+				continue;
+			}
+		}
+		else
+		{
+			Waypoints.Remove(Unit);
+		}
+
+		BatchUnits.Add(Unit);
+		BatchDestinations.Add(Slot);
+	}
+
+	FlushMoveBatch();
+}
+
+void AUnitCommandBus::AdvanceWaypoints()
+{
+	AUnitSimulationManager* Sim = Simulation.Get();
+	int32 NumQueued = 0;
+
+	for (auto It = Waypoints.CreateIterator(); It; ++It)
+	{
+		AUnitBase* Unit = It.Key().Get();
+		TArray<FVector>& Queue = It.Value();
+
+		// Queues die with their unit, or when it breaks or leaves AI control
+		if (!Unit || !Sim || !Unit->IsAlive() || Unit->IsRouting() || !Unit->IsKinematicMovement() || Queue.Num() == 0)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (!Sim->HasDestination(Unit) && !Unit->GetAttackTarget())
+		{
+			BatchUnits.Add(Unit);
+			BatchDestinations.Add(Queue[0]);
+			Queue.RemoveAt(0, 1, EAllowShrinking::No);
+		}
+
+		NumQueued += Queue.Num();
+	}
+
+	SET_DWORD_STAT(STAT_QueuedWaypoints, NumQueued);
+
+	FlushMoveBatch();
+}
+
+void AUnitCommandBus::FlushMoveBatch()
+{
+	if (BatchUnits.Num() == 0)
+	{
+		return;
+	}
+
+	AUnitSimulationManager* Sim = Simulation.Get();
+	if (Sim)
+	{
+		Sim->DispatchMoveOrders(BatchUnits, BatchDestinations);
+	}
+
+	// Units the simulation does not steer take the order themselves
+	for (int32 Index = 0; Index < BatchUnits.Num(); ++Index)
+	{
+		if (!Sim || !BatchUnits[Index]->IsKinematicMovement())
+		{
+			BatchUnits[Index]->CommandMoveTo(BatchDestinations[Index]);
+		}
+	}
+
+	BatchUnits.Reset();
+	BatchDestinations.Reset();
+}
+
+void AUnitCommandBus::ComputeFormationSlots(const FVector& Destination, EFormationType Formation)
+{
+	const TArray<AUnitBase*>& Units = CommandUnits;
+	const int32 NumUnits = Units.Num();
+	FormationSlots.SetNumUninitialized(NumUnits);
+
+	FVector Centroid = FVector::ZeroVector;
+	for (const AUnitBase* Unit : Units)
+	{
+		Centroid += Unit->GetActorLocation();
+	}
+	Centroid /= NumUnits;
+
+	// No formation keeps the group's current shape
+	if (Formation == EFormationType::None || NumUnits == 1)
+	{
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			FormationSlots[Index] = NumUnits == 1 ? Destination : Destination + (Units[Index]->GetActorLocation() - Centroid) * FVector(1.0f, 1.0f, 0.0f);
+		}
+		return;
+	}
+
+	// Face the direction of travel
+	FVector Forward = (Destination - Centroid).GetSafeNormal2D();
+	if (Forward.IsNearlyZero())
+	{
+		Forward = Units[0]->GetActorForwardVector().GetSafeNormal2D();
+	}
+	const FVector Right(-Forward.Y, Forward.X, 0.0f);
+
+	// Offsets in formation space: X forward, Y right, front rank first
+	TArray<FVector2D, TInlineAllocator<256>> Offsets;
+	Offsets.SetNumUninitialized(NumUnits);
+
+	float Spacing = FormationSpacing;
+	int32 Width = FMath::Max(1, LineWidth);
+	switch (Formation)
+	{
+	case EFormationType::Column:
+		Width = FMath::Max(1, ColumnWidth);
+		break;
+	case EFormationType::Square:
+		Width = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumUnits)));
+		break;
+	case EFormationType::Testudo:
+		// Shields locked together
+		Width = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumUnits)));
+		Spacing *= 0.6f;
+		break;
+	default:
+		break;
+	}
+
+	if (Formation == EFormationType::Circle)
+	{
+		const float Radius = FMath::Max(Spacing, NumUnits * Spacing / (2.0f * PI));
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			const float Angle = 2.0f * PI * Index / NumUnits;
+			Offsets[Index] = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Radius;
+		}
+	}
+	else if (Formation == EFormationType::Wedge)
+	{
+		// One more unit in each rank behind the point
+		int32 Rank = 0;
+		int32 InRank = 0;
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			if (InRank > Rank)
+			{
+				++Rank;
+				InRank = 0;
+			}
+			Offsets[Index] = FVector2D(-Rank * Spacing, (InRank - Rank * 0.5f) * Spacing);
+			++InRank;
+		}
+	}
+	else
+	{
+		const int32 NumRanks = FMath::DivideAndRoundUp(NumUnits, Width);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			const int32 Rank = Index / Width;
+			const int32 InRank = Rank < NumRanks - 1 ? Width : NumUnits - Rank * Width;
+			const int32 File = Index % Width;
+			Offsets[Index] = FVector2D(-Rank * Spacing, (File - (InRank - 1) * 0.5f) * Spacing);
+		}
+
+		// Centre the block on the destination
+		for (FVector2D& Offset : Offsets)
+		{
+			Offset.X += (NumRanks - 1) * Spacing * 0.5f;
+		}
+	}
+
+	// Units furthest forward take the front slots, left to right, so paths cross as little as possible
+	TArray<int32, TInlineAllocator<256>> Order;
+	Order.SetNumUninitialized(NumUnits);
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		Order[Index] = Index;
+	}
+
+	TArray<FVector2D, TInlineAllocator<256>> Local;
+	Local.SetNumUninitialized(NumUnits);
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		const FVector Relative = Units[Index]->GetActorLocation() - Centroid;
+		Local[Index] = FVector2D(Relative | Forward, Relative | Right);
+	}
+
+	Order.Sort([&Local](int32 A, int32 B) { return Local[A].X > Local[B].X; });
+
+	TArray<int32, TInlineAllocator<256>> SlotOrder;
+	SlotOrder.SetNumUninitialized(NumUnits);
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		SlotOrder[Index] = Index;
+	}
+	SlotOrder.Sort([&Offsets](int32 A, int32 B) { return Offsets[A].X > Offsets[B].X; });
+
+	// Within each band of equal depth, match by lateral position
+	int32 BandStart = 0;
+	while (BandStart < NumUnits)
+	{
+		int32 BandEnd = BandStart + 1;
+		while (BandEnd < NumUnits && FMath::IsNearlyEqual(Offsets[SlotOrder[BandEnd]].X, Offsets[SlotOrder[BandStart]].X, 1.0f))
+		{
+			++BandEnd;
+		}
+
+		TArrayView<int32> UnitBand(Order.GetData() + BandStart, BandEnd - BandStart);
+		TArrayView<int32> SlotBand(SlotOrder.GetData() + BandStart, BandEnd - BandStart);
+		UnitBand.Sort([&Local](int32 A, int32 B) { return Local[A].Y < Local[B].Y; });
+		SlotBand.Sort([&Offsets](int32 A, int32 B) { return Offsets[A].Y < Offsets[B].Y; });
+
+		for (int32 Index = BandStart; Index < BandEnd; ++Index)
+		{
+			const FVector2D& Offset = Offsets[SlotOrder[Index]];
+			FormationSlots[Order[Index]] = Destination + Forward * Offset.X + Right * Offset.Y;
+		}
+
+		BandStart = BandEnd;
+	}
+}
+
+AUnitCommandBus* AUnitCommandBus::GetUnitCommandBus(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AUnitCommandBus>(WorldContextObject);
+}
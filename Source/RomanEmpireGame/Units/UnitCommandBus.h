@@ -0,0 +1,123 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "UnitCommandBus.generated.h"
+
+class AUnitBase;
+class AUnitSimulationManager;
+
+/**
+ * Kind of order carried by a command record
+ */
+UENUM(BlueprintType)
+enum class EUnitCommandType : uint8
+{
+	Move		UMETA(DisplayName = "Move"),
+	Attack		UMETA(DisplayName = "Attack"),
+	Stop		UMETA(DisplayName = "Stop"),
+	Hold		UMETA(DisplayName = "Hold"),
+	Stance		UMETA(DisplayName = "Set Stance")
+};
+
+/**
+ * Turns player orders into command records and dispatches each one to the unit simulation in a single step.
+ * A move order is laid out in formation around its destination once, rather than each unit working out its own move.
+ * Queued orders become per-unit waypoints that are handed out as units arrive.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AUnitCommandBus : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AUnitCommandBus();
+
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Orders return an id for the record, or INDEX_NONE if there was nothing to order
+	UFUNCTION(BlueprintCallable, Category = "Units|Commands")
+	int32 IssueMove(const TArray<AUnitBase*>& Units, const FVector& Destination, EFormationType Formation, bool bQueue);
+
+	UFUNCTION(BlueprintCallable, Category = "Units|Commands")
+	int32 IssueAttack(const TArray<AUnitBase*>& Units, AActor* Target);
+
+	UFUNCTION(BlueprintCallable, Category = "Units|Commands")
+	int32 IssueStop(const TArray<AUnitBase*>& Units);
+
+	UFUNCTION(BlueprintCallable, Category = "Units|Commands")
+	int32 IssueHold(const TArray<AUnitBase*>& Units);
+
+	// Lands in order with the other commands issued this frame
+	UFUNCTION(BlueprintCallable, Category = "Units|Commands")
+	int32 IssueStance(const TArray<AUnitBase*>& Units, EUnitStance Stance);
+
+	UFUNCTION(BlueprintPure, Category = "Units|Commands")
+	int32 GetNumQueuedWaypoints(AUnitBase* Unit) const;
+
+	// Seconds between an order being issued and reaching the simulation, for the most recent order
+	UFUNCTION(BlueprintPure, Category = "Units|Commands")
+	float GetLastOrderLatency() const { return LastOrderLatency; }
+
+	// Returns the world's command bus, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Units|Commands", meta = (WorldContext = "WorldContextObject"))
+	static AUnitCommandBus* GetUnitCommandBus(UObject* WorldContextObject);
+
+protected:
+	// Distance between neighbouring units when an order is laid out
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Commands")
+	float FormationSpacing;
+
+	// Units per rank in a line formation
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Commands")
+	int32 LineWidth;
+
+	// Units per rank in a marching column
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Commands")
+	int32 ColumnWidth;
+
+	// Waypoints kept per unit; further queued orders are dropped
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Commands")
+	int32 MaxQueuedWaypoints;
+
+private:
+	struct FCommandRecord
+	{
+		int32 Id;
+		EUnitCommandType Type;
+		TArray<TWeakObjectPtr<AUnitBase>> Units;
+		FVector Location;
+		TWeakObjectPtr<AActor> Target;
+		EFormationType Formation;
+		bool bQueue;
+		EUnitStance Stance;
+		double IssueTime;
+	};
+
+	TArray<FCommandRecord> PendingCommands;
+	int32 NextCommandId;
+
+	// Waypoints still to be walked, per unit
+	TMap<TWeakObjectPtr<AUnitBase>, TArray<FVector>> Waypoints;
+
+	float LastOrderLatency;
+
+	TWeakObjectPtr<AUnitSimulationManager> Simulation;
+
+	// Scratch for one dispatch
+	TArray<AUnitBase*> CommandUnits;
+	TArray<AUnitBase*> BatchUnits;
+	TArray<FVector> BatchDestinations;
+	TArray<FVector> FormationSlots;
+
+	FCommandRecord& AddCommand(EUnitCommandType Type, const TArray<AUnitBase*>& Units);
+	void Dispatch(const FCommandRecord& Command);
+	void DispatchMove(const FCommandRecord& Command);
+	void AdvanceWaypoints();
+	void FlushMoveBatch();
+	void ComputeFormationSlots(const FVector& Destination, EFormationType Formation);
+};
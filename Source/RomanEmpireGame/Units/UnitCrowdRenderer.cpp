@@ -0,0 +1,247 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitCrowdRenderer.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Camera/SeamlessZoomCamera.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Unit Crowd"), STAT_UpdateUnitCrowd, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Units"), STAT_CrowdUnits, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Character Units"), STAT_CharacterUnits, STATGROUP_RomanEmpire);
+
+static TAutoConsoleVariable<int32> CVarCrowdForceMode(
+	TEXT("RomanEmpire.Crowd.ForceMode"),
+	0,
+	TEXT("0 = choose by camera distance and zoom, 1 = draw every unit as crowd, 2 = draw every unit as a character"),
+	ECVF_Cheat);
+
+static constexpr int32 CrowdCustomDataFloats = 3;
+
+AUnitCrowdRenderer::AUnitCrowdRenderer()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Runs after units have moved so instances match this frame's positions
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	RootScene = CreateDefaultSubobject<USceneComponent>(TEXT("RootScene"));
+	SetRootComponent(RootScene);
+
+	CrowdDistance = 8000.0f;
+	DistanceHysteresis = 0.1f;
+	CrowdZoomThreshold = RomanEmpireConstants::ZOOM_TERRITORY_MAX;
+	bCastCrowdShadows = false;
+	CrowdUnitCount = 0;
+}
+
+void AUnitCrowdRenderer::RegisterUnit(AUnitBase* Unit)
+{
+	if (!Unit || UnitIndices.Contains(Unit))
+	{
+		return;
+	}
+
+	UnitIndices.Add(Unit, Units.Add(Unit));
+}
+
+void AUnitCrowdRenderer::UnregisterUnit(AUnitBase* Unit)
+{
+	int32 Index;
+	if (!UnitIndices.RemoveAndCopyValue(Unit, Index))
+	{
+		return;
+	}
+
+	Units.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Units.IsValidIndex(Index))
+	{
+		UnitIndices.FindChecked(Units[Index]) = Index;
+	}
+}
+
+void AUnitCrowdRenderer::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UpdateUnitCrowd);
+
+	Super::Tick(DeltaSeconds);
+
+	FVector ViewLocation;
+	float ZoomLevel;
+	if (!GetViewState(ViewLocation, ZoomLevel))
+	{
+		return;
+	}
+
+	const bool bZoomedOut = ZoomLevel < CrowdZoomThreshold;
+
+	for (TPair<EUnitType, FCrowdBatch>& Pair : Batches)
+	{
+		Pair.Value.Transforms.Reset();
+		Pair.Value.CustomData.Reset();
+	}
+
+	CrowdUnitCount = 0;
+
+	for (AUnitBase* Unit : Units)
+	{
+		if (!IsValid(Unit) || !Unit->IsAlive())
+		{
+			continue;
+		}
+
+		const bool bCrowd = ShouldUseCrowd(Unit, ViewLocation, bZoomedOut);
+		if (bCrowd != Unit->IsCrowdRepresented())
+		{
+			Unit->SetCrowdRepresentation(bCrowd);
+		}
+
+		if (!bCrowd)
+		{
+			continue;
+		}
+
+		FCrowdBatch* Batch = FindOrCreateBatch(Unit->GetUnitType());
+		if (!Batch)
+		{
+			continue;
+		}
+
+		// The skeletal mesh transform carries the usual character offsets, so the swap does not pop
+		Batch->Transforms.Add(Unit->GetMesh()->GetComponentTransform());
+
+		const float BaseSpeed = FMath::Max(1.0f, Unit->GetUnitData().BaseStats.Speed);
+		const float TimeOffset = FMath::Frac(Unit->GetUniqueID() * 0.618034f) * Batch->AnimationLength;
+		Batch->CustomData.Add(TimeOffset);
+		Batch->CustomData.Add(Unit->GetVelocity().Size2D() / BaseSpeed);
+		Batch->CustomData.Add(static_cast<float>(Unit->GetOwnerFaction()));
+
+		++CrowdUnitCount;
+	}
+
+	for (TPair<EUnitType, FCrowdBatch>& Pair : Batches)
+	{
+		FlushBatch(Pair.Value);
+	}
+
+	SET_DWORD_STAT(STAT_CrowdUnits, CrowdUnitCount);
+	SET_DWORD_STAT(STAT_CharacterUnits, Units.Num() - CrowdUnitCount);
+}
+
+bool AUnitCrowdRenderer::GetViewState(FVector& OutViewLocation, float& OutZoomLevel) const
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
+	{
+		return false;
+	}
+
+	OutViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+
+	// Possessing a unit in first person counts as fully zoomed in
+	const ASeamlessZoomCamera* ZoomCamera = Cast<ASeamlessZoomCamera>(PlayerController->GetPawn());
+	OutZoomLevel = ZoomCamera ? ZoomCamera->GetZoomLevel() : RomanEmpireConstants::ZOOM_FPS_MAX;
+	return true;
+}
+
+bool AUnitCrowdRenderer::ShouldUseCrowd(const AUnitBase* Unit, const FVector& ViewLocation, bool bZoomedOut) const
+{
+	const int32 ForceMode = CVarCrowdForceMode.GetValueOnGameThread();
+	if (ForceMode != 0)
+	{
+		return ForceMode == 1;
+	}
+
+	// Units the player is looking at closely keep their character
+	if (Unit->IsSelected() || Unit->IsPossessedByPlayer())
+	{
+		return false;
+	}
+
+	if (bZoomedOut)
+	{
+		return true;
+	}
+
+	const float Threshold = Unit->IsCrowdRepresented() ? CrowdDistance * (1.0f - DistanceHysteresis) : CrowdDistance;
+	return FVector::DistSquared(Unit->GetActorLocation(), ViewLocation) > FMath::Square(Threshold);
+}
+
+AUnitCrowdRenderer::FCrowdBatch* AUnitCrowdRenderer::FindOrCreateBatch(EUnitType UnitType)
+{
+	if (FCrowdBatch* Existing = Batches.Find(UnitType))
+	{
+		return Existing->Component ? Existing : nullptr;
+	}
+
+	const FUnitCrowdVisual* Visual = CrowdVisuals.Find(UnitType);
+	if (!Visual || !Visual->Mesh)
+	{
+		Visual = &DefaultCrowdVisual;
+	}
+
+	FCrowdBatch& Batch = Batches.Add(UnitType);
+	Batch.Component = nullptr;
+	Batch.AnimationLength = FMath::Max(Visual->AnimationLength, KINDA_SMALL_NUMBER);
+
+	// Remember types without a mesh so they are not looked up again every frame
+	if (!Visual->Mesh)
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("No crowd mesh for unit type %d; distant units of this type will not be drawn"),
+			static_cast<int32>(UnitType));
+		return nullptr;
+	}
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(this);
+	Component->SetupAttachment(RootScene);
+	Component->SetStaticMesh(Visual->Mesh);
+	if (Visual->Material)
+	{
+		Component->SetMaterial(0, Visual->Material);
+	}
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetCastShadow(bCastCrowdShadows);
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->NumCustomDataFloats = CrowdCustomDataFloats;
+	Component->RegisterComponent();
+
+	BatchComponents.Add(Component);
+	Batch.Component = Component;
+	return &Batch;
+}
+
+void AUnitCrowdRenderer::FlushBatch(FCrowdBatch& Batch)
+{
+	if (!Batch.Component)
+	{
+		return;
+	}
+
+	const int32 Count = Batch.Transforms.Num();
+	if (Count != Batch.Component->GetInstanceCount())
+	{
+		Batch.Component->ClearInstances();
+		Batch.Component->AddInstances(Batch.Transforms, false, true);
+	}
+	else if (Count > 0)
+	{
+		Batch.Component->BatchUpdateInstancesTransforms(0, Batch.Transforms, true, false, true);
+	}
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const TArrayView<const float> InstanceData(Batch.CustomData.GetData() + Index * CrowdCustomDataFloats, CrowdCustomDataFloats);
+		Batch.Component->SetCustomData(Index, InstanceData, false);
+	}
+
+	Batch.Component->MarkRenderStateDirty();
+}
+
+AUnitCrowdRenderer* AUnitCrowdRenderer::GetUnitCrowdRenderer(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AUnitCrowdRenderer>(WorldContextObject);
+}
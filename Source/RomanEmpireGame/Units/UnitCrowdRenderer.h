@@ -0,0 +1,122 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "UnitCrowdRenderer.generated.h"
+
+class AUnitBase;
+class UStaticMesh;
+class UMaterialInterface;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Instanced stand-in for one unit type when seen from a distance.
+ * The material plays a baked vertex animation from per-instance custom data:
+ * 0 = animation time offset, 1 = play rate (0 when standing), 2 = owner faction index.
+ */
+USTRUCT(BlueprintType)
+struct FUnitCrowdVisual
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd")
+	UStaticMesh* Mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd")
+	UMaterialInterface* Material;
+
+	// Length of the baked walk cycle in seconds, used to spread time offsets
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd")
+	float AnimationLength;
+
+	FUnitCrowdVisual()
+		: Mesh(nullptr)
+		, Material(nullptr)
+		, AnimationLength(1.0f)
+	{}
+};
+
+/**
+ * Draws distant units as instanced meshes instead of skeletal characters.
+ * Units beyond CrowdDistance, or every unit once the camera is zoomed out past the city view,
+ * hide their skeletal mesh and stop animating; they return to full characters as the camera approaches.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AUnitCrowdRenderer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AUnitCrowdRenderer();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	void RegisterUnit(AUnitBase* Unit);
+	void UnregisterUnit(AUnitBase* Unit);
+
+	UFUNCTION(BlueprintPure, Category = "Crowd")
+	int32 GetCrowdUnitCount() const { return CrowdUnitCount; }
+
+	UFUNCTION(BlueprintPure, Category = "Crowd")
+	int32 GetRegisteredUnitCount() const { return Units.Num(); }
+
+	// Returns the world's crowd renderer, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Crowd", meta = (WorldContext = "WorldContextObject"))
+	static AUnitCrowdRenderer* GetUnitCrowdRenderer(UObject* WorldContextObject);
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USceneComponent* RootScene;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crowd")
+	TMap<EUnitType, FUnitCrowdVisual> CrowdVisuals;
+
+	// Used for unit types without an entry in CrowdVisuals
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crowd")
+	FUnitCrowdVisual DefaultCrowdVisual;
+
+	// Camera distance beyond which a unit switches to its crowd representation
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crowd")
+	float CrowdDistance;
+
+	// Fraction of CrowdDistance a unit must come back inside before it swaps to a character again
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crowd", meta = (ClampMin = "0.0", ClampMax = "0.5"))
+	float DistanceHysteresis;
+
+	// Below this camera zoom level every unit is drawn as crowd
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crowd")
+	float CrowdZoomThreshold;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crowd")
+	bool bCastCrowdShadows;
+
+private:
+	struct FCrowdBatch
+	{
+		UInstancedStaticMeshComponent* Component;
+		float AnimationLength;
+		TArray<FTransform> Transforms;
+		TArray<float> CustomData;
+	};
+
+	UPROPERTY()
+	TArray<AUnitBase*> Units;
+
+	TMap<const AUnitBase*, int32> UnitIndices;
+
+	TMap<EUnitType, FCrowdBatch> Batches;
+
+	// Keeps the batch components alive for the garbage collector
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> BatchComponents;
+
+	int32 CrowdUnitCount;
+
+	bool GetViewState(FVector& OutViewLocation, float& OutZoomLevel) const;
+	bool ShouldUseCrowd(const AUnitBase* Unit, const FVector& ViewLocation, bool bZoomedOut) const;
+	FCrowdBatch* FindOrCreateBatch(EUnitType UnitType);
+	void FlushBatch(FCrowdBatch& Batch);
+};
@@ -0,0 +1,112 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitDamageTable.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+
+void FUnitDamageTable::SetTypeStats(EUnitType Type, EUnitCategory Category, const FUnitStats& Stats)
+{
+	FTypeInfo& Info = TypeInfos[TypeSlot(Type)];
+	Info.Category = Category;
+	Info.Stats = Stats;
+	Info.bKnown = true;
+	bDirty = true;
+}
+
+void FUnitDamageTable::SetFactionBonuses(EFactionID Faction, float InfantryBonus, float CavalryBonus)
+{
+	FFactionBonuses& Bonuses = FactionBonuses[FactionSlot(Faction)];
+	if (Bonuses.Infantry != InfantryBonus || Bonuses.Cavalry != CavalryBonus)
+	{
+		Bonuses.Infantry = InfantryBonus;
+		Bonuses.Cavalry = CavalryBonus;
+		bDirty = true;
+	}
+}
+
+bool FUnitDamageTable::MatchesTypeDefense(EUnitType Type, const FUnitStats& Stats) const
+{
+	const FTypeInfo& Info = TypeInfos[TypeSlot(Type)];
+	return Info.bKnown
+		&& Info.Stats.MeleeDefense == Stats.MeleeDefense
+		&& Info.Stats.RangedDefense == Stats.RangedDefense
+		&& Info.Stats.Armor == Stats.Armor
+		&& Info.Stats.BlockStrength == Stats.BlockStrength;
+}
+
+float FUnitDamageTable::GetAttackBonus(EFactionID Faction, EUnitType AttackerType) const
+{
+	const FTypeInfo& Info = TypeInfos[TypeSlot(AttackerType)];
+	if (!Info.bKnown)
+	{
+		return 1.0f;
+	}
+
+	const FFactionBonuses& Bonuses = FactionBonuses[FactionSlot(Faction)];
+	switch (Info.Category)
+	{
+	case EUnitCategory::Infantry:
+		return Bonuses.Infantry;
+	case EUnitCategory::Cavalry:
+		return Bonuses.Cavalry;
+	default:
+		return 1.0f;
+	}
+}
+
+float FUnitDamageTable::ComputeScale(float AttackBonus, const FUnitStats& DefenderStats, uint8 HitKind)
+{
+	const bool bRanged = (HitKind & HitRanged) != 0;
+	float Defense = bRanged ? DefenderStats.RangedDefense : DefenderStats.MeleeDefense;
+
+	// Blocking reduces damage significantly
+	if ((HitKind & HitBlocking) && !bRanged)
+	{
+		Defense += 20 * DefenderStats.BlockStrength;
+	}
+
+	return AttackBonus * (100.0f / (100.0f + Defense));
+}
+
+float FUnitDamageTable::ComputeDamage(float RawDamage, float AttackBonus, const FUnitStats& DefenderStats, uint8 HitKind)
+{
+	// Minimum 1 damage
+	return FMath::Max(1.0f, RawDamage * ComputeScale(AttackBonus, DefenderStats, HitKind) - DefenderStats.Armor);
+}
+
+void FUnitDamageTable::RebuildIfDirty()
+{
+	if (!bDirty)
+	{
+		return;
+	}
+	bDirty = false;
+
+	Entries.SetNum(MaxFactions * NumUnitTypes * NumUnitTypes * NumHitKinds);
+
+	for (int32 Faction = 0; Faction < MaxFactions; ++Faction)
+	{
+		for (int32 Attacker = 0; Attacker < NumUnitTypes; ++Attacker)
+		{
+			const float AttackBonus = GetAttackBonus(static_cast<EFactionID>(Faction), static_cast<EUnitType>(Attacker));
+
+			for (int32 Defender = 0; Defender < NumUnitTypes; ++Defender)
+			{
+				// Unknown defenders are never looked up; MatchesTypeDefense sends them to the formula
+				const FTypeInfo& DefenderInfo = TypeInfos[Defender];
+				if (!DefenderInfo.bKnown)
+				{
+					continue;
+				}
+
+				for (uint8 HitKind = 0; HitKind < NumHitKinds; ++HitKind)
+				{
+					FEntry& Entry = Entries[EntryIndex(static_cast<EFactionID>(Faction), static_cast<EUnitType>(Attacker), static_cast<EUnitType>(Defender), HitKind)];
+					Entry.Scale = ComputeScale(AttackBonus, DefenderInfo.Stats, HitKind);
+					Entry.Armor = DefenderInfo.Stats.Armor;
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogRomanEmpire, Verbose, TEXT("Rebuilt unit damage table (%d entries)"), Entries.Num());
+}
@@ -0,0 +1,82 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+
+/**
+ * Precomputed hit resolution for every attacker faction, attacker type, defender type and hit kind.
+ * Each entry folds the attacker's faction bonus and the defender's defence into one scale, so a hit costs
+ * one multiply and one subtract. The table is rebuilt only when a type's stats or a faction's bonuses change.
+ */
+struct ROMANEMPIREGAME_API FUnitDamageTable
+{
+public:
+	static constexpr int32 MaxFactions = 8;
+	static constexpr int32 NumUnitTypes = static_cast<int32>(EUnitType::Ram) + 1;
+
+	// Hit kinds; blocking only counts against melee
+	static constexpr uint8 HitRanged = 1 << 0;
+	static constexpr uint8 HitBlocking = 1 << 1;
+	static constexpr int32 NumHitKinds = 4;
+
+	// Records the stats units of a type are built with; changes take effect on the next rebuild
+	void SetTypeStats(EUnitType Type, EUnitCategory Category, const FUnitStats& Stats);
+	bool HasTypeStats(EUnitType Type) const { return TypeInfos[TypeSlot(Type)].bKnown; }
+
+	void SetFactionBonuses(EFactionID Faction, float InfantryBonus, float CavalryBonus);
+
+	void RebuildIfDirty();
+
+	// True while a unit's defensive stats are still those of its type, so the table applies to it
+	bool MatchesTypeDefense(EUnitType Type, const FUnitStats& Stats) const;
+
+	float GetAttackBonus(EFactionID Faction, EUnitType AttackerType) const;
+
+	float Lookup(EFactionID AttackerFaction, EUnitType AttackerType, EUnitType DefenderType, uint8 HitKind, float RawDamage) const
+	{
+		const FEntry& Entry = Entries[EntryIndex(AttackerFaction, AttackerType, DefenderType, HitKind)];
+		return FMath::Max(1.0f, RawDamage * Entry.Scale - Entry.Armor);
+	}
+
+	// The formula the table caches; also used directly for units whose stats differ from their type's
+	static float ComputeDamage(float RawDamage, float AttackBonus, const FUnitStats& DefenderStats, uint8 HitKind);
+
+private:
+	struct FEntry
+	{
+		float Scale = 1.0f;
+		float Armor = 0.0f;
+	};
+
+	struct FTypeInfo
+	{
+		EUnitCategory Category = EUnitCategory::Infantry;
+		FUnitStats Stats;
+		bool bKnown = false;
+	};
+
+	struct FFactionBonuses
+	{
+		float Infantry = 1.0f;
+		float Cavalry = 1.0f;
+	};
+
+	FTypeInfo TypeInfos[NumUnitTypes];
+	FFactionBonuses FactionBonuses[MaxFactions];
+	TArray<FEntry> Entries;
+	bool bDirty = true;
+
+	static int32 TypeSlot(EUnitType Type) { return FMath::Min(static_cast<int32>(Type), NumUnitTypes - 1); }
+	static int32 FactionSlot(EFactionID Faction) { return static_cast<uint8>(Faction) & (MaxFactions - 1); }
+
+	static int32 EntryIndex(EFactionID AttackerFaction, EUnitType AttackerType, EUnitType DefenderType, uint8 HitKind)
+	{
+		return ((FactionSlot(AttackerFaction) * NumUnitTypes + TypeSlot(AttackerType)) * NumUnitTypes + TypeSlot(DefenderType)) * NumHitKinds
+			+ (HitKind & (NumHitKinds - 1));
+	}
+
+	static float ComputeScale(float AttackBonus, const FUnitStats& DefenderStats, uint8 HitKind);
+};
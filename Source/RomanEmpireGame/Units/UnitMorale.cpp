@@ -0,0 +1,211 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitMorale.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// Per-unit outcome of the parallel pass
+	constexpr uint8 RoutRequestNone = 0;
+	constexpr uint8 RoutRequestFlee = 1;	// Break, or keep running
+	constexpr uint8 RoutRequestRally = 2;
+
+	// Enemies further than about 100 degrees from a unit's facing are on its flank or rear
+	constexpr float FlankDot = -0.2f;
+
+	constexpr int32 MaxFlankers = 3;
+
+	// Longest time a single pass may cover after a hitch
+	constexpr float MaxMoraleStep = 1.0f;
+}
+
+void FUnitMoraleSystem::AddDeath(const FVector& Location, EFactionID Faction)
+{
+	PendingDeaths.Add({ FVector2D(Location), Faction });
+}
+
+void FUnitMoraleSystem::Update(float DeltaSeconds, FUnitSimulationData& Data, const FUnitSpatialGrid& Grid, const FFactionRelationCache& Relations,
+	const FUnitMoraleSettings& Settings, TArray<int32>& OutMoraleChanged, TArray<FRoutChange>& OutRoutChanges)
+{
+	Accumulator += DeltaSeconds;
+	if (Accumulator < Settings.StepInterval)
+	{
+		return;
+	}
+
+	const float StepSeconds = FMath::Min(Accumulator, MaxMoraleStep);
+	Accumulator = 0.0f;
+
+	const int32 NumUnits = Data.Num();
+	if (NumUnits == 0)
+	{
+		PendingDeaths.Reset();
+		return;
+	}
+
+	Shocks.Reset();
+	Shocks.SetNumZeroed(NumUnits);
+	LeaderNearby.Reset();
+	LeaderNearby.SetNumZeroed(NumUnits);
+	NextMorale.SetNumUninitialized(NumUnits);
+	MoraleChanged.SetNumUninitialized(NumUnits);
+	RoutRequests.SetNumUninitialized(NumUnits);
+	FleeDirections.SetNumUninitialized(NumUnits);
+
+	// Deaths and leaders are rare next to the unit count, so scatter their effect instead of every unit searching for them
+	if (Settings.DeathShockRadius > 0.0f)
+	{
+		for (const FDeath& Death : PendingDeaths)
+		{
+			Grid.ForEachInRadius(Death.Location, Settings.DeathShockRadius, [&](int32 Index, float DistanceSquared)
+			{
+				if (Data.Factions[Index] == Death.Faction)
+				{
+					Shocks[Index] += Settings.DeathShock * (1.0f - FMath::Sqrt(DistanceSquared) / Settings.DeathShockRadius);
+				}
+			});
+		}
+	}
+	PendingDeaths.Reset();
+
+	for (int32 Leader = 0; Leader < NumUnits; ++Leader)
+	{
+		if (Data.UnitTypes[Leader] != EUnitType::Centurion
+			|| EnumHasAnyFlags(Data.Flags[Leader], EUnitSimFlags::Routing | EUnitSimFlags::PendingRemoval))
+		{
+			continue;
+		}
+
+		const EFactionID Faction = Data.Factions[Leader];
+		Grid.ForEachInRadius(FVector2D(Data.Positions[Leader]), Settings.LeaderRadius, [&](int32 Index, float)
+		{
+			if (Data.Factions[Index] == Faction)
+			{
+				LeaderNearby[Index] = 1;
+			}
+		});
+	}
+
+	ParallelFor(NumUnits, [&](int32 Index)
+	{
+		const float Morale = Data.Morale[Index];
+		const EUnitSimFlags Flags = Data.Flags[Index];
+
+		NextMorale[Index] = Morale;
+		MoraleChanged[Index] = 0;
+		RoutRequests[Index] = RoutRequestNone;
+
+		if (EnumHasAnyFlags(Flags, EUnitSimFlags::PendingRemoval))
+		{
+			return;
+		}
+
+		const FVector2D Position(Data.Positions[Index]);
+		const float YawRadians = FMath::DegreesToRadians(Data.Yaws[Index]);
+		const FVector2D Forward(FMath::Cos(YawRadians), FMath::Sin(YawRadians));
+		const EFactionID Faction = Data.Factions[Index];
+
+		int32 Enemies = 0;
+		int32 Friends = 0;
+		int32 Flankers = 0;
+		FVector2D Threat = FVector2D::ZeroVector;
+
+		Grid.ForEachInRadius(Position, Settings.ThreatRadius, [&](int32 Other, float DistanceSquared)
+		{
+			if (Other == Index || EnumHasAnyFlags(Data.Flags[Other], EUnitSimFlags::PendingRemoval))
+			{
+				return;
+			}
+
+			if (Data.Factions[Other] == Faction)
+			{
+				++Friends;
+				return;
+			}
+
+			if (!Relations.AreHostile(Faction, Data.Factions[Other]))
+			{
+				return;
+			}
+
+			++Enemies;
+			const FVector2D ToEnemy = FVector2D(Data.Positions[Other]) - Position;
+			const float Distance = FMath::Sqrt(DistanceSquared);
+			if (Distance > KINDA_SMALL_NUMBER)
+			{
+				Threat += ToEnemy / Distance;
+				if ((ToEnemy | Forward) < FlankDot * Distance)
+				{
+					++Flankers;
+				}
+			}
+		});
+
+		// Faction bonus hardens against losses and speeds up gains
+		const float Bonus = FMath::Max(Relations.GetMoraleBonus(Faction), 0.1f);
+		float Loss = Shocks[Index];
+		float Gain = 0.0f;
+
+		Loss += Settings.FlankPenaltyPerSecond * FMath::Min(Flankers, MaxFlankers) * StepSeconds;
+		if (Enemies > Friends + 1)
+		{
+			Loss += Settings.OutnumberedPenaltyPerSecond * StepSeconds;
+		}
+		if (Enemies == 0)
+		{
+			Gain += Settings.RecoveryPerSecond * StepSeconds;
+		}
+		if (LeaderNearby[Index])
+		{
+			Gain += Settings.LeaderBonusPerSecond * StepSeconds;
+		}
+
+		const float BaseMorale = Data.BaseMorale[Index];
+		const float Next = FMath::Clamp(Morale - Loss / Bonus + Gain * Bonus, 0.0f, BaseMorale);
+		NextMorale[Index] = Next;
+		MoraleChanged[Index] = FMath::RoundToInt(Next) != FMath::RoundToInt(Morale) ? 1 : 0;
+
+		// Only units the simulation steers can be made to run
+		if (!EnumHasAnyFlags(Flags, EUnitSimFlags::Kinematic))
+		{
+			return;
+		}
+
+		const bool bRouting = EnumHasAnyFlags(Flags, EUnitSimFlags::Routing);
+		if (bRouting && Next >= BaseMorale * Settings.RallyThreshold)
+		{
+			RoutRequests[Index] = RoutRequestRally;
+		}
+		else if ((!bRouting && Next < BaseMorale * Settings.RoutThreshold)
+			|| (bRouting && Enemies > 0 && !EnumHasAnyFlags(Flags, EUnitSimFlags::HasDestination)))
+		{
+			// Run directly away from the enemy, or back the way the unit faces when broken by shock alone
+			RoutRequests[Index] = RoutRequestFlee;
+			FleeDirections[Index] = Enemies > 0 && !Threat.IsNearlyZero() ? -Threat.GetSafeNormal() : -Forward;
+		}
+	});
+
+	Swap(Data.Morale, NextMorale);
+
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		if (MoraleChanged[Index])
+		{
+			OutMoraleChanged.Add(Index);
+		}
+
+		if (RoutRequests[Index] != RoutRequestNone)
+		{
+			FRoutChange& Change = OutRoutChanges.AddDefaulted_GetRef();
+			Change.Index = Index;
+			Change.bRouting = RoutRequests[Index] == RoutRequestFlee;
+			Change.FleeDestination = Data.Positions[Index];
+			if (Change.bRouting)
+			{
+				Change.FleeDestination += FVector(FleeDirections[Index] * Settings.FleeDistance, 0.0f);
+			}
+		}
+	}
+}
@@ -0,0 +1,124 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "UnitMorale.generated.h"
+
+struct FUnitSimulationData;
+struct FUnitSpatialGrid;
+struct FFactionRelationCache;
+
+/**
+ * Tuning for the morale pass
+ */
+USTRUCT(BlueprintType)
+struct FUnitMoraleSettings
+{
+	GENERATED_BODY()
+
+	// Seconds between morale passes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float StepInterval;
+
+	// Morale lost by friendlies standing next to a unit that dies, fading to nothing at DeathShockRadius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float DeathShock;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float DeathShockRadius;
+
+	// Radius in which enemies count as engaging a unit
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float ThreatRadius;
+
+	// Morale lost per second for each enemy on a unit's flank or rear, up to three
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float FlankPenaltyPerSecond;
+
+	// Morale lost per second while nearby enemies outnumber nearby friends
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float OutnumberedPenaltyPerSecond;
+
+	// Centurions steady friendlies within this radius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float LeaderRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float LeaderBonusPerSecond;
+
+	// Morale regained per second with no enemy in ThreatRadius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float RecoveryPerSecond;
+
+	// Fractions of base morale at which a unit breaks and rallies
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float RoutThreshold;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float RallyThreshold;
+
+	// How far a routing unit runs before reconsidering
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Morale")
+	float FleeDistance;
+
+	FUnitMoraleSettings()
+		: StepInterval(0.25f)
+		, DeathShock(8.0f)
+		, DeathShockRadius(600.0f)
+		, ThreatRadius(500.0f)
+		, FlankPenaltyPerSecond(2.0f)
+		, OutnumberedPenaltyPerSecond(1.5f)
+		, LeaderRadius(1500.0f)
+		, LeaderBonusPerSecond(1.5f)
+		, RecoveryPerSecond(2.0f)
+		, RoutThreshold(0.2f)
+		, RallyThreshold(0.5f)
+		, FleeDistance(2000.0f)
+	{}
+};
+
+/**
+ * Morale for every simulated unit, advanced in one batched pass over the shared unit grid.
+ * Shocks from deaths are scattered once per death rather than gathered per unit.
+ */
+struct FUnitMoraleSystem
+{
+public:
+	struct FRoutChange
+	{
+		int32 Index;
+		bool bRouting;
+		FVector FleeDestination;
+	};
+
+	// Queues a death to shock nearby friendlies on the next pass
+	void AddDeath(const FVector& Location, EFactionID Faction);
+
+	// Runs a pass once StepInterval has elapsed. Reports units whose whole-number morale changed and units that broke or rallied;
+	// a routing unit that has stopped running while still threatened is reported again with a fresh flee destination.
+	void Update(float DeltaSeconds, FUnitSimulationData& Data, const FUnitSpatialGrid& Grid, const FFactionRelationCache& Relations,
+		const FUnitMoraleSettings& Settings, TArray<int32>& OutMoraleChanged, TArray<FRoutChange>& OutRoutChanges);
+
+	// Whether Update with this delta will run a pass
+	bool IsStepDue(float DeltaSeconds, const FUnitMoraleSettings& Settings) const { return Accumulator + DeltaSeconds >= Settings.StepInterval; }
+
+private:
+	struct FDeath
+	{
+		FVector2D Location;
+		EFactionID Faction;
+	};
+
+	TArray<FDeath> PendingDeaths;
+	float Accumulator = 0.0f;
+
+	// Scratch, sized to the unit count each pass
+	TArray<float> Shocks;
+	TArray<uint8> LeaderNearby;
+	TArray<float> NextMorale;
+	TArray<uint8> MoraleChanged;
+	TArray<uint8> RoutRequests;
+	TArray<FVector2D> FleeDirections;
+};
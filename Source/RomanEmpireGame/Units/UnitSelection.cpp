@@ -0,0 +1,253 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitSelection.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+
+bool FUnitSelection::Select(const TArray<AUnitBase*>& NewUnits, FUnitSelectionDiff& OutDiff)
+{
+	if (++SelectGeneration == 0)
+	{
+		// Wrapped; clear old stamps so none matches by accident
+		FMemory::Memzero(Marks.GetData(), Marks.Num() * sizeof(uint32));
+		SelectGeneration = 1;
+	}
+
+	bool bChanged = false;
+	for (AUnitBase* Unit : NewUnits)
+	{
+		if (const int32* Index = Indices.Find(Unit))
+		{
+			Marks[*Index] = SelectGeneration;
+		}
+		else if (AddUnit(Unit))
+		{
+			Marks.Last() = SelectGeneration;
+			OutDiff.Added.Add(Unit);
+			bChanged = true;
+		}
+	}
+
+	// Walk backwards so the member swapped into a freed slot has already been checked
+	for (int32 Index = Units.Num() - 1; Index >= 0; --Index)
+	{
+		if (Marks[Index] != SelectGeneration)
+		{
+			OutDiff.Removed.Add(Units[Index]);
+			RemoveAt(Index);
+			bChanged = true;
+		}
+	}
+
+	UpdateAverageHealth();
+	return bChanged;
+}
+
+bool FUnitSelection::Add(const TArray<AUnitBase*>& NewUnits, FUnitSelectionDiff& OutDiff)
+{
+	bool bChanged = false;
+	for (AUnitBase* Unit : NewUnits)
+	{
+		if (!Indices.Contains(Unit) && AddUnit(Unit))
+		{
+			OutDiff.Added.Add(Unit);
+			bChanged = true;
+		}
+	}
+
+	UpdateAverageHealth();
+	return bChanged;
+}
+
+bool FUnitSelection::Remove(const TArray<AUnitBase*>& OldUnits, FUnitSelectionDiff& OutDiff)
+{
+	bool bChanged = false;
+	for (AUnitBase* Unit : OldUnits)
+	{
+		if (const int32* Index = Indices.Find(Unit))
+		{
+			OutDiff.Removed.Add(Unit);
+			RemoveAt(*Index);
+			bChanged = true;
+		}
+	}
+
+	UpdateAverageHealth();
+	return bChanged;
+}
+
+bool FUnitSelection::Clear(FUnitSelectionDiff& OutDiff)
+{
+	if (Units.Num() == 0)
+	{
+		return false;
+	}
+
+	OutDiff.Removed.Append(Units);
+
+	Units.Reset();
+	HealthPercents.Reset();
+	Marks.Reset();
+	Indices.Reset();
+	Summary = FUnitSelectionSummary();
+	return true;
+}
+
+bool FUnitSelection::UpdateUnit(AUnitBase* Unit, bool bLeavingPlay, FUnitSelectionDiff& OutDiff)
+{
+	const int32* Found = Indices.Find(Unit);
+	if (!Found)
+	{
+		return false;
+	}
+
+	const int32 Index = *Found;
+	if (bLeavingPlay || !Unit->IsAlive())
+	{
+		OutDiff.Removed.Add(Unit);
+		RemoveAt(Index);
+	}
+	else
+	{
+		const float HealthPercent = Unit->GetHealthPercent();
+		Summary.HealthPercentSum += HealthPercent - HealthPercents[Index];
+		HealthPercents[Index] = HealthPercent;
+	}
+
+	UpdateAverageHealth();
+	return true;
+}
+
+void FUnitSelection::AssignGroup(int32 Group)
+{
+	if (!IsValidGroup(Group))
+	{
+		return;
+	}
+
+	TArray<TWeakObjectPtr<AUnitBase>>& Handles = Groups[Group];
+	Handles.Reset(Units.Num());
+	for (AUnitBase* Unit : Units)
+	{
+		Handles.Add(Unit);
+	}
+}
+
+void FUnitSelection::AddSelectionToGroup(int32 Group)
+{
+	if (!IsValidGroup(Group))
+	{
+		return;
+	}
+
+	TArray<TWeakObjectPtr<AUnitBase>>& Handles = Groups[Group];
+
+	TSet<const AUnitBase*> Existing;
+	Existing.Reserve(Handles.Num());
+	for (const TWeakObjectPtr<AUnitBase>& Handle : Handles)
+	{
+		Existing.Add(Handle.Get());
+	}
+
+	for (AUnitBase* Unit : Units)
+	{
+		if (!Existing.Contains(Unit))
+		{
+			Handles.Add(Unit);
+		}
+	}
+}
+
+bool FUnitSelection::RecallGroup(int32 Group, FUnitSelectionDiff& OutDiff)
+{
+	if (!IsValidGroup(Group))
+	{
+		return false;
+	}
+
+	// Drop handles to units that have since died or been destroyed
+	TArray<TWeakObjectPtr<AUnitBase>>& Handles = Groups[Group];
+	GroupUnits.Reset(Handles.Num());
+	for (int32 Index = Handles.Num() - 1; Index >= 0; --Index)
+	{
+		AUnitBase* Unit = Handles[Index].Get();
+		if (Unit && Unit->IsAlive())
+		{
+			GroupUnits.Add(Unit);
+		}
+		else
+		{
+			Handles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		}
+	}
+
+	if (GroupUnits.Num() == 0)
+	{
+		return false;
+	}
+
+	return Select(GroupUnits, OutDiff);
+}
+
+int32 FUnitSelection::GetGroupSize(int32 Group) const
+{
+	return IsValidGroup(Group) ? Groups[Group].Num() : 0;
+}
+
+bool FUnitSelection::AddUnit(AUnitBase* Unit)
+{
+	if (!Unit || !Unit->IsAlive())
+	{
+		return false;
+	}
+
+	const float HealthPercent = Unit->GetHealthPercent();
+
+	Indices.Add(Unit, Units.Num());
+	Units.Add(Unit);
+	HealthPercents.Add(HealthPercent);
+	Marks.Add(0);
+
+	++Summary.NumUnits;
+	++Summary.UnitTypeCounts.FindOrAdd(Unit->GetUnitType());
+	Summary.HealthPercentSum += HealthPercent;
+	return true;
+}
+
+void FUnitSelection::RemoveAt(int32 Index)
+{
+	AUnitBase* Unit = Units[Index];
+
+	--Summary.NumUnits;
+	Summary.HealthPercentSum -= HealthPercents[Index];
+
+	const EUnitType Type = Unit->GetUnitType();
+	int32& TypeCount = Summary.UnitTypeCounts.FindChecked(Type);
+	if (--TypeCount == 0)
+	{
+		Summary.UnitTypeCounts.Remove(Type);
+	}
+
+	Indices.Remove(Unit);
+	Units.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	HealthPercents.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Marks.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	if (Index < Units.Num())
+	{
+		Indices[Units[Index]] = Index;
+	}
+}
+
+void FUnitSelection::UpdateAverageHealth()
+{
+	if (Summary.NumUnits == 0)
+	{
+		// Reset so rounding from many updates does not linger
+		Summary.HealthPercentSum = 0.0;
+		Summary.AverageHealthPercent = 0.0f;
+		return;
+	}
+
+	Summary.AverageHealthPercent = static_cast<float>(Summary.HealthPercentSum / Summary.NumUnits);
+}
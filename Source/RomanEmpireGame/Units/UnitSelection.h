@@ -0,0 +1,99 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "UnitSelection.generated.h"
+
+class AUnitBase;
+
+/**
+ * Aggregate view of a selection for the HUD, kept up to date as units join, leave or take damage
+ */
+USTRUCT(BlueprintType)
+struct FUnitSelectionSummary
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Selection")
+	int32 NumUnits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Selection")
+	TMap<EUnitType, int32> UnitTypeCounts;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Selection")
+	float AverageHealthPercent = 0.0f;
+
+	// Sum of member health percents, so the average changes in O(1) per update
+	double HealthPercentSum = 0.0;
+};
+
+/**
+ * Units that entered and left a selection in one change; only these need their selection visuals touched
+ */
+struct FUnitSelectionDiff
+{
+	TArray<AUnitBase*> Added;
+	TArray<AUnitBase*> Removed;
+
+	bool IsEmpty() const { return Added.Num() == 0 && Removed.Num() == 0; }
+
+	void Reset()
+	{
+		Added.Reset();
+		Removed.Reset();
+	}
+};
+
+/**
+ * The player's selection and numbered control groups.
+ * Members are stored densely with an index map, so membership tests and removals are O(1) and every change
+ * reports a diff instead of rebuilding. Control groups keep weak handles and are compacted when recalled.
+ */
+class ROMANEMPIREGAME_API FUnitSelection
+{
+public:
+	static constexpr int32 NumControlGroups = 10;
+
+	const TArray<AUnitBase*>& GetUnits() const { return Units; }
+	const FUnitSelectionSummary& GetSummary() const { return Summary; }
+	int32 Num() const { return Units.Num(); }
+	bool Contains(const AUnitBase* Unit) const { return Indices.Contains(Unit); }
+
+	// Each change appends to OutDiff and returns whether the selection changed
+	bool Select(const TArray<AUnitBase*>& NewUnits, FUnitSelectionDiff& OutDiff);
+	bool Add(const TArray<AUnitBase*>& NewUnits, FUnitSelectionDiff& OutDiff);
+	bool Remove(const TArray<AUnitBase*>& OldUnits, FUnitSelectionDiff& OutDiff);
+	bool Clear(FUnitSelectionDiff& OutDiff);
+
+	// Re-reads a member's health; units that died or are leaving play drop out of the selection and every group
+	bool UpdateUnit(AUnitBase* Unit, bool bLeavingPlay, FUnitSelectionDiff& OutDiff);
+
+	// Control groups
+	void AssignGroup(int32 Group);
+	void AddSelectionToGroup(int32 Group);
+	bool RecallGroup(int32 Group, FUnitSelectionDiff& OutDiff);
+	int32 GetGroupSize(int32 Group) const;
+
+private:
+	TArray<AUnitBase*> Units;
+	TArray<float> HealthPercents;
+	TMap<const AUnitBase*, int32> Indices;
+
+	// Stamped with SelectGeneration for members kept by a Select, so the rest are found in one pass
+	TArray<uint32> Marks;
+	uint32 SelectGeneration = 0;
+
+	FUnitSelectionSummary Summary;
+
+	TArray<TWeakObjectPtr<AUnitBase>> Groups[NumControlGroups];
+
+	// Scratch for recalling a group
+	TArray<AUnitBase*> GroupUnits;
+
+	bool AddUnit(AUnitBase* Unit);
+	void RemoveAt(int32 Index);
+	void UpdateAverageHealth();
+	static bool IsValidGroup(int32 Group) { return Group >= 0 && Group < NumControlGroups; }
+};
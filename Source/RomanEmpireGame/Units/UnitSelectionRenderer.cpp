@@ -0,0 +1,179 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitSelectionRenderer.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Selection Rings"), STAT_UpdateSelectionRings, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selection Rings"), STAT_SelectionRings, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selection Rings Updated"), STAT_SelectionRingsUpdated, STATGROUP_RomanEmpire);
+
+AUnitSelectionRenderer::AUnitSelectionRenderer()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Runs after units have moved so rings match this frame's positions
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	RingInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("RingInstances"));
+	SetRootComponent(RingInstances);
+	RingInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RingInstances->SetCanEverAffectNavigation(false);
+	RingInstances->SetCastShadow(false);
+	RingInstances->SetMobility(EComponentMobility::Movable);
+	RingInstances->NumCustomDataFloats = 1;
+
+	RingMesh = nullptr;
+	RingMaterial = nullptr;
+	RingMeshRadius = 50.0f;
+	RingScale = 1.5f;
+	RingHeightOffset = 2.0f;
+	MoveTolerance = 1.0f;
+	bMembershipDirty = false;
+}
+
+void AUnitSelectionRenderer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!RingMesh)
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("No selection ring mesh set; selected units will not show a ring"));
+		return;
+	}
+
+	RingInstances->SetStaticMesh(RingMesh);
+	if (RingMaterial)
+	{
+		RingInstances->SetMaterial(0, RingMaterial);
+	}
+}
+
+void AUnitSelectionRenderer::AddUnit(AUnitBase* Unit)
+{
+	if (!Unit || UnitIndices.Contains(Unit))
+	{
+		return;
+	}
+
+	UnitIndices.Add(Unit, Units.Add(Unit));
+
+	FTransform Ring;
+	ComputeRing(Unit, Ring);
+	Transforms.Add(Ring);
+	CustomData.Add(static_cast<float>(Unit->GetOwnerFaction()));
+
+	bMembershipDirty = true;
+}
+
+void AUnitSelectionRenderer::RemoveUnit(AUnitBase* Unit)
+{
+	int32 Index;
+	if (!UnitIndices.RemoveAndCopyValue(Unit, Index))
+	{
+		return;
+	}
+
+	Units.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Transforms.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	CustomData.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Units.IsValidIndex(Index))
+	{
+		UnitIndices.FindChecked(Units[Index]) = Index;
+	}
+
+	bMembershipDirty = true;
+}
+
+void AUnitSelectionRenderer::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UpdateSelectionRings);
+
+	Super::Tick(DeltaSeconds);
+
+	const int32 Count = Units.Num();
+	SET_DWORD_STAT(STAT_SelectionRings, Count);
+
+	bool bTransformsDirty = bMembershipDirty;
+	bool bCustomDataDirty = bMembershipDirty;
+	int32 NumUpdated = 0;
+
+	// Compare against what was last drawn; a stationary selection costs no instance upload
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const AUnitBase* Unit = Units[Index];
+		FTransform Ring;
+		if (!IsValid(Unit) || !ComputeRing(Unit, Ring))
+		{
+			continue;
+		}
+
+		if (!Ring.GetLocation().Equals(Transforms[Index].GetLocation(), MoveTolerance)
+			|| !Ring.GetScale3D().Equals(Transforms[Index].GetScale3D()))
+		{
+			Transforms[Index] = Ring;
+			bTransformsDirty = true;
+			++NumUpdated;
+		}
+
+		const float Faction = static_cast<float>(Unit->GetOwnerFaction());
+		if (CustomData[Index] != Faction)
+		{
+			CustomData[Index] = Faction;
+			bCustomDataDirty = true;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_SelectionRingsUpdated, NumUpdated);
+
+	if (bTransformsDirty)
+	{
+		if (Count != RingInstances->GetInstanceCount())
+		{
+			RingInstances->ClearInstances();
+			RingInstances->AddInstances(Transforms, false, true);
+		}
+		else if (Count > 0)
+		{
+			RingInstances->BatchUpdateInstancesTransforms(0, Transforms, true, false, true);
+		}
+	}
+
+	if (bCustomDataDirty)
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			RingInstances->SetCustomDataValue(Index, 0, CustomData[Index], false);
+		}
+	}
+
+	if (bTransformsDirty || bCustomDataDirty)
+	{
+		RingInstances->MarkRenderStateDirty();
+	}
+
+	bMembershipDirty = false;
+}
+
+bool AUnitSelectionRenderer::ComputeRing(const AUnitBase* Unit, FTransform& OutTransform) const
+{
+	const UCapsuleComponent* Capsule = Unit->GetCapsuleComponent();
+	if (!Capsule)
+	{
+		return false;
+	}
+
+	// Flat on the ground at the unit's feet, sized to its capsule
+	const FVector Feet = Unit->GetActorLocation() - FVector(0.0f, 0.0f, Capsule->GetScaledCapsuleHalfHeight() - RingHeightOffset);
+	const float Scale = Capsule->GetScaledCapsuleRadius() * RingScale / FMath::Max(RingMeshRadius, KINDA_SMALL_NUMBER);
+
+	OutTransform = FTransform(FQuat::Identity, Feet, FVector(Scale, Scale, 1.0f));
+	return true;
+}
+
+AUnitSelectionRenderer* AUnitSelectionRenderer::GetUnitSelectionRenderer(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AUnitSelectionRenderer>(WorldContextObject);
+}
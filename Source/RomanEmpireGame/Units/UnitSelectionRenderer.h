@@ -0,0 +1,81 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "UnitSelectionRenderer.generated.h"
+
+class AUnitBase;
+class UStaticMesh;
+class UMaterialInterface;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Draws the selection ring under every selected unit as one instanced mesh.
+ * Units join and leave as their selection changes; instances are only rewritten on frames where
+ * the set changed or a selected unit moved. Per-instance custom data 0 is the owner faction index.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AUnitSelectionRenderer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AUnitSelectionRenderer();
+
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	void AddUnit(AUnitBase* Unit);
+	void RemoveUnit(AUnitBase* Unit);
+
+	UFUNCTION(BlueprintPure, Category = "Selection")
+	int32 GetRingCount() const { return Units.Num(); }
+
+	// Returns the world's selection renderer, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Selection", meta = (WorldContext = "WorldContextObject"))
+	static AUnitSelectionRenderer* GetUnitSelectionRenderer(UObject* WorldContextObject);
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UInstancedStaticMeshComponent* RingInstances;
+
+	// Flat ring lying in the XY plane
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Selection")
+	UStaticMesh* RingMesh;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Selection")
+	UMaterialInterface* RingMaterial;
+
+	// Radius of RingMesh in its own units, so rings can be scaled to each unit's capsule
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Selection")
+	float RingMeshRadius;
+
+	// Ring radius as a multiple of the unit's capsule radius
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Selection")
+	float RingScale;
+
+	// Lift above the unit's feet so the ring does not z-fight the ground
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Selection")
+	float RingHeightOffset;
+
+	// Movement below this distance leaves the ring where it was drawn
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Selection")
+	float MoveTolerance;
+
+private:
+	UPROPERTY()
+	TArray<AUnitBase*> Units;
+
+	TMap<const AUnitBase*, int32> UnitIndices;
+
+	// What was last written to the instances, per unit
+	TArray<FTransform> Transforms;
+	TArray<float> CustomData;
+
+	// Set when the set of units changed, so instances are rebuilt rather than updated
+	bool bMembershipDirty;
+
+	bool ComputeRing(const AUnitBase* Unit, FTransform& OutTransform) const;
+};
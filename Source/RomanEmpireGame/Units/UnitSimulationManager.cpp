@@ -0,0 +1,931 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitSimulationManager.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "RomanEmpireGame/Units/UnitAvoidance.h"
+#include "RomanEmpireGame/Core/RomanEmpireGameMode.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "RomanEmpireGame/Core/RomanEmpireWorldSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation"), STAT_UnitSimulation, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation - Grid"), STAT_UnitSimulationGrid, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation - Ground"), STAT_UnitSimulationGround, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation - Integrate"), STAT_UnitSimulationIntegrate, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation - Apply"), STAT_UnitSimulationApply, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation - Morale"), STAT_UnitSimulationMorale, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation - Targeting"), STAT_UnitSimulationTargeting, STATGROUP_RomanEmpire);
+DECLARE_CYCLE_STAT(TEXT("Unit Simulation - Screen Query"), STAT_UnitSimulationScreenQuery, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Simulated Units"), STAT_SimulatedUnits, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Routing Units"), STAT_RoutingUnits, STATGROUP_RomanEmpire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targets Acquired"), STAT_TargetsAcquired, STATGROUP_RomanEmpire);
+
+int32 FUnitSimulationData::Add()
+{
+	Positions.AddZeroed();
+	Velocities.AddZeroed();
+	Destinations.AddZeroed();
+	Yaws.AddZeroed();
+	MaxSpeeds.AddZeroed();
+	Radii.AddZeroed();
+	HalfHeights.AddZeroed();
+	GroundHeights.AddZeroed();
+	Factions.Add(EFactionID::None);
+	UnitTypes.Add(EUnitType::None);
+	Morale.AddZeroed();
+	BaseMorale.AddZeroed();
+	Stances.Add(EUnitStance::Defensive);
+	AttackRanges.AddZeroed();
+	return Flags.Add(EUnitSimFlags::None);
+}
+
+void FUnitSimulationData::RemoveAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Destinations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Yaws.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	MaxSpeeds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Radii.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	HalfHeights.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	GroundHeights.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Factions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	UnitTypes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Morale.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	BaseMorale.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Stances.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AttackRanges.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Flags.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+AUnitSimulationManager::AUnitSimulationManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	GridCellSize = 200.0f;
+	ArrivalRadius = 50.0f;
+	SlowingRadius = 200.0f;
+	SeparationRange = 1.5f;
+	SeparationWeight = 1.0f;
+	MaxNeighbours = 12;
+	TurnRate = 540.0f;
+	GroundSamplesPerFrame = 512;
+	GroundChannel = ECC_WorldStatic;
+	MaxStepSeconds = 0.1f;
+	AvoidanceMode = EUnitAvoidanceMode::Reciprocal;
+	AvoidanceTimeHorizon = 1.5f;
+	ObstacleTimeHorizon = 0.5f;
+	AvoidanceNeighbourDistance = 600.0f;
+	GroundSampleCursor = 0;
+	MaxObstacleRadius = 0.0f;
+	bObstaclesDirty = false;
+	bFactionRelationsValid = false;
+}
+
+void AUnitSimulationManager::RegisterUnit(AUnitBase* Unit)
+{
+	if (!Unit || UnitIndices.Contains(Unit))
+	{
+		return;
+	}
+
+	const int32 Index = Data.Add();
+	Units.Add(Unit);
+	UnitIndices.Add(Unit, Index);
+
+	const UCapsuleComponent* Capsule = Unit->GetCapsuleComponent();
+	const FVector Location = Unit->GetActorLocation();
+
+	Data.Positions[Index] = Location;
+	Data.Destinations[Index] = Location;
+	Data.Yaws[Index] = Unit->GetActorRotation().Yaw;
+	Data.MaxSpeeds[Index] = Unit->GetMovementSpeed();
+	Data.Radii[Index] = Capsule ? Capsule->GetScaledCapsuleRadius() : 42.0f;
+	Data.HalfHeights[Index] = Capsule ? Capsule->GetScaledCapsuleHalfHeight() : 96.0f;
+	Data.GroundHeights[Index] = Location.Z - Data.HalfHeights[Index];
+	Data.Factions[Index] = Unit->GetOwnerFaction();
+	Data.UnitTypes[Index] = Unit->GetUnitType();
+	Data.BaseMorale[Index] = FMath::Max(1, Unit->GetStats().Morale);
+	Data.Morale[Index] = FMath::Clamp(static_cast<float>(Unit->GetMorale()), 0.0f, Data.BaseMorale[Index]);
+	Data.Stances[Index] = Unit->GetStance();
+	Data.AttackRanges[Index] = Unit->GetUnitData().AttackRange;
+
+	// The first unit of a type seeds its row of the damage table
+	if (!DamageTable.HasTypeStats(Unit->GetUnitType()))
+	{
+		RefreshUnitTypeStats(Unit->GetUnitData());
+	}
+}
+
+void AUnitSimulationManager::UnregisterUnit(AUnitBase* Unit)
+{
+	int32 Index;
+	if (!UnitIndices.RemoveAndCopyValue(Unit, Index))
+	{
+		return;
+	}
+
+	// Indices stay stable until the next step so passes and grid queries in flight remain valid
+	Units[Index] = nullptr;
+	Data.Flags[Index] = EUnitSimFlags::PendingRemoval;
+	PendingRemovals.Add(Index);
+}
+
+void AUnitSimulationManager::CompactRemovedUnits()
+{
+	if (PendingRemovals.Num() == 0)
+	{
+		return;
+	}
+
+	// Highest first, so swapping in the last unit never moves another pending slot
+	PendingRemovals.Sort(TGreater<int32>());
+
+	for (const int32 Index : PendingRemovals)
+	{
+		Data.RemoveAtSwap(Index);
+		Units.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+		if (Units.IsValidIndex(Index) && Units[Index])
+		{
+			UnitIndices.FindChecked(Units[Index]) = Index;
+		}
+	}
+
+	PendingRemovals.Reset();
+}
+
+void AUnitSimulationManager::SetKinematic(AUnitBase* Unit, bool bKinematic)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (bKinematic)
+	{
+		// Pick up wherever character movement left the unit
+		const FVector Location = Unit->GetActorLocation();
+		Data.Positions[Index] = Location;
+		Data.GroundHeights[Index] = Location.Z - Data.HalfHeights[Index];
+		Data.Yaws[Index] = Unit->GetActorRotation().Yaw;
+		Data.Velocities[Index] = FVector::ZeroVector;
+		Data.Flags[Index] |= EUnitSimFlags::Kinematic;
+	}
+	else
+	{
+		// A routing unit taken over by the player is under control again
+		const bool bWasRouting = EnumHasAnyFlags(Data.Flags[Index], EUnitSimFlags::Routing);
+		Data.Flags[Index] &= ~(EUnitSimFlags::Kinematic | EUnitSimFlags::HasDestination | EUnitSimFlags::Moved | EUnitSimFlags::Routing);
+		if (bWasRouting)
+		{
+			Unit->ApplyRouting(false);
+		}
+	}
+}
+
+void AUnitSimulationManager::SetDestination(AUnitBase* Unit, const FVector& Destination)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index != INDEX_NONE)
+	{
+		Data.Destinations[Index] = Destination;
+		Data.Flags[Index] |= EUnitSimFlags::HasDestination;
+	}
+}
+
+void AUnitSimulationManager::ClearDestination(AUnitBase* Unit)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index != INDEX_NONE)
+	{
+		Data.Flags[Index] &= ~EUnitSimFlags::HasDestination;
+	}
+}
+
+void AUnitSimulationManager::DispatchMoveOrders(const TArray<AUnitBase*>& InUnits, const TArray<FVector>& Destinations)
+{
+	check(InUnits.Num() == Destinations.Num());
+
+	for (int32 Order = 0; Order < InUnits.Num(); ++Order)
+	{
+		AUnitBase* Unit = InUnits[Order];
+		const int32 Index = GetUnitIndex(Unit);
+		if (Index == INDEX_NONE)
+		{
+			continue;
+		}
+
+		EUnitSimFlags& Flags = Data.Flags[Index];
+		if (!EnumHasAnyFlags(Flags, EUnitSimFlags::Kinematic) || EnumHasAnyFlags(Flags, EUnitSimFlags::Routing))
+		{
+			continue;
+		}
+
+		// A move order replaces any attack, commanded or acquired
+		Data.Destinations[Index] = Destinations[Order];
+		Flags = (Flags | EUnitSimFlags::HasDestination) & ~EUnitSimFlags::HasTarget;
+		Unit->ApplyMoveOrder(Destinations[Order]);
+	}
+}
+
+void AUnitSimulationManager::SetMaxSpeed(AUnitBase* Unit, float MaxSpeed)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index != INDEX_NONE)
+	{
+		Data.MaxSpeeds[Index] = FMath::Max(0.0f, MaxSpeed);
+	}
+}
+
+void AUnitSimulationManager::SetBaseMorale(AUnitBase* Unit, int32 BaseMorale)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index != INDEX_NONE)
+	{
+		Data.BaseMorale[Index] = FMath::Max(1, BaseMorale);
+		Data.Morale[Index] = FMath::Min(Data.Morale[Index], Data.BaseMorale[Index]);
+	}
+}
+
+void AUnitSimulationManager::SetFaction(AUnitBase* Unit, EFactionID Faction)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index != INDEX_NONE)
+	{
+		Data.Factions[Index] = Faction;
+	}
+}
+
+void AUnitSimulationManager::SetStance(AUnitBase* Unit, EUnitStance Stance)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index != INDEX_NONE)
+	{
+		Data.Stances[Index] = Stance;
+	}
+}
+
+void AUnitSimulationManager::SetHasTarget(AUnitBase* Unit, bool bHasTarget)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (bHasTarget)
+	{
+		Data.Flags[Index] |= EUnitSimFlags::HasTarget;
+	}
+	else
+	{
+		Data.Flags[Index] &= ~EUnitSimFlags::HasTarget;
+	}
+}
+
+void AUnitSimulationManager::SetYaw(AUnitBase* Unit, float Yaw)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index != INDEX_NONE)
+	{
+		Data.Yaws[Index] = Yaw;
+	}
+}
+
+bool AUnitSimulationManager::HasDestination(const AUnitBase* Unit) const
+{
+	const int32 Index = GetUnitIndex(Unit);
+	return Index != INDEX_NONE && EnumHasAnyFlags(Data.Flags[Index], EUnitSimFlags::HasDestination);
+}
+
+bool AUnitSimulationManager::ApplyMoraleDelta(AUnitBase* Unit, float Delta)
+{
+	const int32 Index = GetUnitIndex(Unit);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Breaking is left to the next morale pass so every rout goes through the same path
+	float& Morale = Data.Morale[Index];
+	Morale = FMath::Clamp(Morale + Delta, 0.0f, Data.BaseMorale[Index]);
+	Unit->ApplyMorale(FMath::RoundToInt(Morale));
+	return true;
+}
+
+void AUnitSimulationManager::NotifyUnitDied(const AUnitBase* Unit)
+{
+	if (Unit)
+	{
+		MoraleSystem.AddDeath(Unit->GetActorLocation(), Unit->GetOwnerFaction());
+	}
+}
+
+bool AUnitSimulationManager::IsRouting(const AUnitBase* Unit) const
+{
+	const int32 Index = GetUnitIndex(Unit);
+	return Index != INDEX_NONE && EnumHasAnyFlags(Data.Flags[Index], EUnitSimFlags::Routing);
+}
+
+float AUnitSimulationManager::ResolveDamage(const AUnitBase* Attacker, const AUnitBase* Defender, float RawDamage, bool bRanged, bool bBlocking)
+{
+	DamageTable.RebuildIfDirty();
+
+	const EUnitType AttackerType = Attacker ? Attacker->GetUnitType() : EUnitType::None;
+	const EFactionID AttackerFaction = Attacker ? Attacker->GetOwnerFaction() : EFactionID::None;
+	const uint8 HitKind = (bRanged ? FUnitDamageTable::HitRanged : 0) | (bBlocking ? FUnitDamageTable::HitBlocking : 0);
+	const EUnitType DefenderType = Defender->GetUnitType();
+	const FUnitStats& DefenderStats = Defender->GetStats();
+
+	if (DamageTable.MatchesTypeDefense(DefenderType, DefenderStats))
+	{
+		return DamageTable.Lookup(AttackerFaction, AttackerType, DefenderType, HitKind, RawDamage);
+	}
+
+	// Modifiers such as a formation changed this unit's defences
+	return FUnitDamageTable::ComputeDamage(RawDamage, DamageTable.GetAttackBonus(AttackerFaction, AttackerType), DefenderStats, HitKind);
+}
+
+void AUnitSimulationManager::RefreshUnitTypeStats(const FUnitData& UnitData)
+{
+	DamageTable.SetTypeStats(UnitData.UnitType, UnitData.Category, UnitData.BaseStats);
+}
+
+int32 AUnitSimulationManager::GetUnitIndex(const AUnitBase* Unit) const
+{
+	const int32* Index = UnitIndices.Find(Unit);
+	return Index ? *Index : INDEX_NONE;
+}
+
+TArray<AUnitBase*> AUnitSimulationManager::GetUnitsInRadius(const FVector& Center, float Radius) const
+{
+	TArray<AUnitBase*> Result;
+	SpatialGrid.ForEachInRadius(FVector2D(Center), Radius, [this, &Result](int32 Index, float)
+	{
+		if (AUnitBase* Unit = Units[Index])
+		{
+			Result.Add(Unit);
+		}
+	});
+	return Result;
+}
+
+void AUnitSimulationManager::GetUnitsInScreenRect(const FMatrix& ViewProjection, const FIntRect& ViewRect, const FBox2D& ScreenRect, EFactionID Faction, TArray<AUnitBase*>& OutUnits) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitSimulationScreenQuery);
+
+	const int32 NumUnits = Units.Num();
+	if (NumUnits == 0 || ViewRect.Width() <= 0 || ViewRect.Height() <= 0)
+	{
+		return;
+	}
+
+	// Bring the rectangle into normalized device coordinates once; screen Y points down, NDC Y up
+	const double InvWidth = 2.0 / ViewRect.Width();
+	const double InvHeight = 2.0 / ViewRect.Height();
+	const double MinX = (ScreenRect.Min.X - ViewRect.Min.X) * InvWidth - 1.0;
+	const double MaxX = (ScreenRect.Max.X - ViewRect.Min.X) * InvWidth - 1.0;
+	const double MinY = 1.0 - (ScreenRect.Max.Y - ViewRect.Min.Y) * InvHeight;
+	const double MaxY = 1.0 - (ScreenRect.Min.Y - ViewRect.Min.Y) * InvHeight;
+
+	// Only clip X, Y and W are needed; a point is inside when Min * W <= Clip <= Max * W, which avoids a divide per unit
+	const FVector4 ColumnX(ViewProjection.M[0][0], ViewProjection.M[1][0], ViewProjection.M[2][0], ViewProjection.M[3][0]);
+	const FVector4 ColumnY(ViewProjection.M[0][1], ViewProjection.M[1][1], ViewProjection.M[2][1], ViewProjection.M[3][1]);
+	const FVector4 ColumnW(ViewProjection.M[0][3], ViewProjection.M[1][3], ViewProjection.M[2][3], ViewProjection.M[3][3]);
+
+	TArray<uint8> Inside;
+	Inside.SetNumUninitialized(NumUnits);
+
+	// Chunked so each task projects a contiguous run of positions
+	constexpr int32 ChunkSize = 1024;
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumUnits, ChunkSize);
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		const int32 First = Chunk * ChunkSize;
+		const int32 Last = FMath::Min(First + ChunkSize, NumUnits);
+		for (int32 Index = First; Index < Last; ++Index)
+		{
+			const FVector& P = Data.Positions[Index];
+			const double ClipX = P.X * ColumnX.X + P.Y * ColumnX.Y + P.Z * ColumnX.Z + ColumnX.W;
+			const double ClipY = P.X * ColumnY.X + P.Y * ColumnY.Y + P.Z * ColumnY.Z + ColumnY.W;
+			const double ClipW = P.X * ColumnW.X + P.Y * ColumnW.Y + P.Z * ColumnW.Z + ColumnW.W;
+
+			const bool bFactionMatches = Faction == EFactionID::None || Data.Factions[Index] == Faction;
+			Inside[Index] = bFactionMatches
+				&& !EnumHasAnyFlags(Data.Flags[Index], EUnitSimFlags::PendingRemoval)
+				&& ClipW > UE_KINDA_SMALL_NUMBER
+				&& ClipX >= MinX * ClipW && ClipX <= MaxX * ClipW
+				&& ClipY >= MinY * ClipW && ClipY <= MaxY * ClipW;
+		}
+	});
+
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		AUnitBase* Unit = Units[Index];
+		if (Inside[Index] && Unit && Unit->IsAlive())
+		{
+			OutUnits.Add(Unit);
+		}
+	}
+}
+
+void AUnitSimulationManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitSimulation);
+
+	Super::Tick(DeltaSeconds);
+
+	CompactRemovedUnits();
+
+	SET_DWORD_STAT(STAT_SimulatedUnits, Units.Num());
+
+	if (Units.Num() == 0)
+	{
+		return;
+	}
+
+	const float StepSeconds = FMath::Min(DeltaSeconds, MaxStepSeconds);
+
+	SyncCharacterUnits();
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_UnitSimulationGrid);
+		SpatialGrid.Build(Data.Positions, GridCellSize);
+		RebuildObstacles();
+	}
+
+	SampleGroundHeights();
+	UpdateMorale(DeltaSeconds);
+	AcquireTargets(DeltaSeconds);
+	IntegrateMovement(StepSeconds);
+	ApplyToActors();
+}
+
+void AUnitSimulationManager::SyncCharacterUnits()
+{
+	// Possessed units move themselves; mirror them so neighbours still steer around them
+	for (int32 Index = 0; Index < Units.Num(); ++Index)
+	{
+		const AUnitBase* Unit = Units[Index];
+		if (!Unit || EnumHasAnyFlags(Data.Flags[Index], EUnitSimFlags::Kinematic))
+		{
+			continue;
+		}
+
+		Data.Positions[Index] = Unit->GetActorLocation();
+		Data.Velocities[Index] = Unit->GetVelocity();
+		Data.Yaws[Index] = Unit->GetActorRotation().Yaw;
+	}
+}
+
+void AUnitSimulationManager::SampleGroundHeights()
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitSimulationGround);
+
+	const int32 NumUnits = Units.Num();
+	int32 Samples = 0;
+
+	// Only moving units can change ground height; walk them round-robin within the trace budget
+	for (int32 Checked = 0; Checked < NumUnits && Samples < GroundSamplesPerFrame; ++Checked)
+	{
+		GroundSampleCursor = (GroundSampleCursor + 1) % NumUnits;
+		const int32 Index = GroundSampleCursor;
+
+		const EUnitSimFlags Flags = Data.Flags[Index];
+		if (!EnumHasAnyFlags(Flags, EUnitSimFlags::Kinematic) || Data.Velocities[Index].IsNearlyZero())
+		{
+			continue;
+		}
+
+		float GroundHeight;
+		if (TraceGround(Data.Positions[Index], GroundHeight))
+		{
+			Data.GroundHeights[Index] = GroundHeight;
+		}
+		++Samples;
+	}
+}
+
+bool AUnitSimulationManager::TraceGround(const FVector& Location, float& OutHeight) const
+{
+	const FVector Start = Location + FVector(0.0f, 0.0f, 500.0f);
+	const FVector End = Location - FVector(0.0f, 0.0f, 2000.0f);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(UnitGroundTrace), false);
+	FHitResult Hit;
+	if (GetWorld()->LineTraceSingleByObjectType(Hit, Start, End, FCollisionObjectQueryParams(GroundChannel), Params))
+	{
+		OutHeight = Hit.ImpactPoint.Z;
+		return true;
+	}
+	return false;
+}
+
+void AUnitSimulationManager::RefreshFactionRelations()
+{
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	const AFactionManager* FactionManager = GameMode ? GameMode->GetFactionManager() : nullptr;
+
+	for (int32 A = 0; A < FFactionRelationCache::MaxFactions; ++A)
+	{
+		const EFactionID FactionA = static_cast<EFactionID>(A);
+		uint8 HostileMask = 0;
+		uint8 FriendlyMask = 1 << A;
+
+		for (int32 B = 0; B < FFactionRelationCache::MaxFactions; ++B)
+		{
+			const EFactionID FactionB = static_cast<EFactionID>(B);
+			if (A == B || FactionA == EFactionID::None || FactionB == EFactionID::None)
+			{
+				continue;
+			}
+
+			// Without diplomacy every other faction is an enemy, as in melee
+			const EDiplomaticStatus Status = FactionManager ? FactionManager->GetDiplomaticStatus(FactionA, FactionB) : EDiplomaticStatus::War;
+			if (Status == EDiplomaticStatus::War || Status == EDiplomaticStatus::Hostile)
+			{
+				HostileMask |= 1 << B;
+			}
+			else if (Status == EDiplomaticStatus::Friendly || Status == EDiplomaticStatus::Allied)
+			{
+				FriendlyMask |= 1 << B;
+			}
+		}
+
+		FactionRelations.HostileMasks[A] = HostileMask;
+		FactionRelations.FriendlyMasks[A] = FriendlyMask;
+
+		const FFactionInfo* Info = FactionManager ? FactionManager->FindFactionInfo(FactionA) : nullptr;
+		FactionRelations.MoraleBonuses[A] = Info ? Info->MoraleBonus : 1.0f;
+
+		// Only marks the damage table dirty when a bonus actually changed
+		DamageTable.SetFactionBonuses(FactionA, Info ? Info->InfantryBonus : 1.0f, Info ? Info->CavalryBonus : 1.0f);
+	}
+}
+
+void AUnitSimulationManager::UpdateMorale(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitSimulationMorale);
+
+	// Diplomacy rarely changes mid-battle; re-reading it on morale steps keeps the per-frame cost off the hot path
+	if (!bFactionRelationsValid || MoraleSystem.IsStepDue(DeltaSeconds, MoraleSettings))
+	{
+		RefreshFactionRelations();
+		bFactionRelationsValid = true;
+	}
+
+	MoraleChanges.Reset();
+	RoutChanges.Reset();
+	MoraleSystem.Update(DeltaSeconds, Data, SpatialGrid, FactionRelations, MoraleSettings, MoraleChanges, RoutChanges);
+
+	for (const int32 Index : MoraleChanges)
+	{
+		if (AUnitBase* Unit = Units[Index])
+		{
+			Unit->ApplyMorale(FMath::RoundToInt(Data.Morale[Index]));
+		}
+	}
+
+	for (const FUnitMoraleSystem::FRoutChange& Change : RoutChanges)
+	{
+		AUnitBase* Unit = Units[Change.Index];
+		if (!Unit)
+		{
+			continue;
+		}
+
+		EUnitSimFlags& Flags = Data.Flags[Change.Index];
+		const bool bWasRouting = EnumHasAnyFlags(Flags, EUnitSimFlags::Routing);
+
+		if (Change.bRouting)
+		{
+			Flags |= EUnitSimFlags::Routing | EUnitSimFlags::HasDestination;
+			Data.Destinations[Change.Index] = Change.FleeDestination;
+		}
+		else
+		{
+			// Rallied units hold where they stopped
+			Flags &= ~(EUnitSimFlags::Routing | EUnitSimFlags::HasDestination);
+		}
+
+		if (bWasRouting != Change.bRouting)
+		{
+			Unit->ApplyRouting(Change.bRouting);
+		}
+	}
+
+	if (RoutChanges.Num() > 0)
+	{
+		int32 NumRouting = 0;
+		for (const EUnitSimFlags Flags : Data.Flags)
+		{
+			NumRouting += EnumHasAnyFlags(Flags, EUnitSimFlags::Routing) ? 1 : 0;
+		}
+		SET_DWORD_STAT(STAT_RoutingUnits, NumRouting);
+	}
+}
+
+void AUnitSimulationManager::AcquireTargets(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitSimulationTargeting);
+
+	TargetAssignments.Reset();
+	TargetAcquisition.Update(DeltaSeconds, Data, SpatialGrid, FactionRelations, TargetingSettings, TargetAssignments);
+
+	int32 NumAcquired = 0;
+	for (const FUnitTargetAcquisition::FAssignment& Assignment : TargetAssignments)
+	{
+		AUnitBase* Unit = Units[Assignment.Index];
+		if (!Unit)
+		{
+			continue;
+		}
+
+		if (Assignment.Target != INDEX_NONE)
+		{
+			if (AUnitBase* Target = Units[Assignment.Target])
+			{
+				Unit->ApplyAcquiredTarget(Target);
+				++NumAcquired;
+			}
+		}
+
+		if (Assignment.bFallBack)
+		{
+			Unit->ApplyFallBack(Assignment.FallBackDestination);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_TargetsAcquired, NumAcquired);
+}
+
+void AUnitSimulationManager::IntegrateMovement(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitSimulationIntegrate);
+
+	const int32 NumUnits = Data.Num();
+	NextPositions.SetNumUninitialized(NumUnits);
+	NextVelocities.SetNumUninitialized(NumUnits);
+	NextFlags.SetNumUninitialized(NumUnits);
+
+	// Neighbours read each other's flags, so every write goes to the scratch arrays
+	ParallelFor(NumUnits, [this, DeltaSeconds](int32 Index)
+	{
+		const FVector& Position = Data.Positions[Index];
+		EUnitSimFlags Flags = Data.Flags[Index];
+
+		if (!EnumHasAnyFlags(Flags, EUnitSimFlags::Kinematic))
+		{
+			NextPositions[Index] = Position;
+			NextVelocities[Index] = Data.Velocities[Index];
+			NextFlags[Index] = Flags;
+			return;
+		}
+
+		const FVector2D Position2D(Position);
+		const float MaxSpeed = Data.MaxSpeeds[Index];
+		FVector2D Desired = FVector2D::ZeroVector;
+
+		// Arrive: full speed until the slowing radius, then ease in
+		if (EnumHasAnyFlags(Flags, EUnitSimFlags::HasDestination))
+		{
+			const FVector2D ToGoal = FVector2D(Data.Destinations[Index]) - Position2D;
+			const float Distance = ToGoal.Size();
+			if (Distance <= ArrivalRadius)
+			{
+				Flags &= ~EUnitSimFlags::HasDestination;
+			}
+			else
+			{
+				const float Speed = MaxSpeed * FMath::Min(1.0f, Distance / FMath::Max(SlowingRadius, 1.0f));
+				Desired = ToGoal * (Speed / Distance);
+			}
+		}
+
+		Desired = AvoidanceMode == EUnitAvoidanceMode::Reciprocal
+			? ComputeAvoidanceVelocity(Index, Desired, DeltaSeconds)
+			: ComputeSeparationVelocity(Index, Desired);
+
+		// Drop imperceptible drift so settled formations stop writing transforms
+		if (Desired.SizeSquared() < 1.0f)
+		{
+			Desired = FVector2D::ZeroVector;
+		}
+
+		const FVector Velocity(Desired.X, Desired.Y, 0.0f);
+		FVector Next = Position + Velocity * DeltaSeconds;
+		Next.Z = Data.GroundHeights[Index] + Data.HalfHeights[Index];
+
+		if (!Velocity.IsZero())
+		{
+			const float TargetYaw = FMath::RadiansToDegrees(FMath::Atan2(Velocity.Y, Velocity.X));
+			Data.Yaws[Index] = FMath::FixedTurn(Data.Yaws[Index], TargetYaw, TurnRate * DeltaSeconds);
+		}
+
+		if (!Velocity.IsZero() || !Data.Velocities[Index].IsZero() || !FMath::IsNearlyEqual(Next.Z, Position.Z, 0.5f))
+		{
+			Flags |= EUnitSimFlags::Moved;
+		}
+
+		NextPositions[Index] = Next;
+		NextVelocities[Index] = Velocity;
+		NextFlags[Index] = Flags;
+	});
+
+	Swap(Data.Positions, NextPositions);
+	Swap(Data.Velocities, NextVelocities);
+	Swap(Data.Flags, NextFlags);
+}
+
+FVector2D AUnitSimulationManager::ComputeSeparationVelocity(int32 Index, const FVector2D& Preferred) const
+{
+	const FVector2D Position(Data.Positions[Index]);
+	const float Radius = Data.Radii[Index];
+	const float MaxSpeed = Data.MaxSpeeds[Index];
+	FVector2D Push = FVector2D::ZeroVector;
+	int32 Neighbours = 0;
+
+	SpatialGrid.ForEachInRadius(Position, 2.0f * Radius * SeparationRange, [&](int32 Other, float DistanceSquared)
+	{
+		if (Other == Index || Neighbours >= MaxNeighbours)
+		{
+			return;
+		}
+
+		const float Range = (Radius + Data.Radii[Other]) * SeparationRange;
+		if (DistanceSquared >= Range * Range)
+		{
+			return;
+		}
+
+		const float Distance = FMath::Sqrt(DistanceSquared);
+		FVector2D Away = Position - FVector2D(Data.Positions[Other]);
+		if (Distance > KINDA_SMALL_NUMBER)
+		{
+			Away /= Distance;
+		}
+		else
+		{
+			// Stacked exactly on top of each other; split them along a stable direction
+			const float Angle = FMath::Frac((Index + Other) * 0.618034f) * UE_TWO_PI;
+			Away = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * (Index < Other ? 1.0f : -1.0f);
+		}
+
+		Push += Away * (1.0f - Distance / Range);
+		++Neighbours;
+	});
+
+	return (Preferred + Push * (MaxSpeed * SeparationWeight)).GetClampedToMaxSize(MaxSpeed);
+}
+
+FVector2D AUnitSimulationManager::ComputeAvoidanceVelocity(int32 Index, const FVector2D& Preferred, float DeltaSeconds) const
+{
+	UnitAvoidance::FAgent Agent;
+	Agent.Position = FVector2D(Data.Positions[Index]);
+	Agent.Velocity = FVector2D(Data.Velocities[Index]);
+	Agent.PreferredVelocity = Preferred;
+	Agent.Radius = Data.Radii[Index];
+	Agent.MaxSpeed = Data.MaxSpeeds[Index];
+
+	UnitAvoidance::FParams Params;
+	Params.TimeHorizon = AvoidanceTimeHorizon;
+	Params.ObstacleTimeHorizon = ObstacleTimeHorizon;
+	Params.TimeStep = FMath::Max(DeltaSeconds, KINDA_SMALL_NUMBER);
+
+	// Nearest neighbours only; a unit deep inside a formation cannot reach the far side within the horizon anyway
+	TArray<TPair<float, int32>, TInlineAllocator<32>> Candidates;
+	const float QueryRadius = Agent.Radius * 2.0f + Agent.MaxSpeed * AvoidanceTimeHorizon;
+	SpatialGrid.ForEachInRadius(Agent.Position, FMath::Min(QueryRadius, AvoidanceNeighbourDistance), [&](int32 Other, float DistanceSquared)
+	{
+		if (Other != Index && !EnumHasAnyFlags(Data.Flags[Other], EUnitSimFlags::PendingRemoval))
+		{
+			Candidates.Emplace(DistanceSquared, Other);
+		}
+	});
+
+	if (Candidates.Num() > MaxNeighbours)
+	{
+		Algo::Sort(Candidates, [](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+		Candidates.SetNum(MaxNeighbours, EAllowShrinking::No);
+	}
+
+	TArray<UnitAvoidance::FNeighbour, TInlineAllocator<32>> Neighbours;
+	for (const TPair<float, int32>& Candidate : Candidates)
+	{
+		const int32 Other = Candidate.Value;
+
+		UnitAvoidance::FNeighbour& Neighbour = Neighbours.AddDefaulted_GetRef();
+		Neighbour.Position = FVector2D(Data.Positions[Other]);
+		Neighbour.Velocity = FVector2D(Data.Velocities[Other]);
+		Neighbour.Radius = Data.Radii[Other];
+
+		// Player-driven units will not yield, so take the whole manoeuvre
+		Neighbour.Responsibility = EnumHasAnyFlags(Data.Flags[Other], EUnitSimFlags::Kinematic) ? 0.5f : 1.0f;
+	}
+
+	TArray<UnitAvoidance::FObstacle, TInlineAllocator<8>> Obstacles;
+	if (ObstacleGrid.Num() > 0)
+	{
+		const float ObstacleQuery = Agent.Radius + MaxObstacleRadius + Agent.MaxSpeed * ObstacleTimeHorizon;
+		ObstacleGrid.ForEachInRadius(Agent.Position, ObstacleQuery, [&](int32 Obstacle, float)
+		{
+			Obstacles.Add({ FVector2D(ObstacleCenters[Obstacle]), ObstacleRadii[Obstacle] });
+		});
+	}
+
+	return UnitAvoidance::ComputeVelocity(Agent, Obstacles, Neighbours, Params);
+}
+
+void AUnitSimulationManager::RegisterObstacle(AActor* Owner, const FVector& Center, float Radius)
+{
+	if (!Owner)
+	{
+		return;
+	}
+
+	if (const int32* Existing = ObstacleIndices.Find(Owner))
+	{
+		ObstacleCenters[*Existing] = Center;
+		ObstacleRadii[*Existing] = Radius;
+	}
+	else
+	{
+		ObstacleIndices.Add(Owner, ObstacleCenters.Add(Center));
+		ObstacleRadii.Add(Radius);
+		ObstacleOwners.Add(Owner);
+	}
+
+	bObstaclesDirty = true;
+}
+
+void AUnitSimulationManager::UnregisterObstacle(const AActor* Owner)
+{
+	int32 Index;
+	if (!ObstacleIndices.RemoveAndCopyValue(Owner, Index))
+	{
+		return;
+	}
+
+	ObstacleCenters.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ObstacleRadii.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ObstacleOwners.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	if (ObstacleOwners.IsValidIndex(Index))
+	{
+		ObstacleIndices.FindChecked(ObstacleOwners[Index]) = Index;
+	}
+
+	bObstaclesDirty = true;
+}
+
+void AUnitSimulationManager::RebuildObstacles()
+{
+	if (!bObstaclesDirty)
+	{
+		return;
+	}
+
+	bObstaclesDirty = false;
+	MaxObstacleRadius = 0.0f;
+	for (const float Radius : ObstacleRadii)
+	{
+		MaxObstacleRadius = FMath::Max(MaxObstacleRadius, Radius);
+	}
+
+	ObstacleGrid.Build(ObstacleCenters, GridCellSize);
+}
+
+const FUnitSpatialGrid& AUnitSimulationManager::GetObstacleGrid()
+{
+	RebuildObstacles();
+	return ObstacleGrid;
+}
+
+void AUnitSimulationManager::ApplyToActors()
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnitSimulationApply);
+
+	for (int32 Index = 0; Index < Units.Num(); ++Index)
+	{
+		EUnitSimFlags& Flags = Data.Flags[Index];
+		if (!EnumHasAllFlags(Flags, EUnitSimFlags::Kinematic | EUnitSimFlags::Moved))
+		{
+			continue;
+		}
+
+		Flags &= ~EUnitSimFlags::Moved;
+		Units[Index]->ApplyKinematicMove(Data.Positions[Index], Data.Yaws[Index], Data.Velocities[Index]);
+	}
+}
+
+AUnitSimulationManager* AUnitSimulationManager::GetUnitSimulationManager(UObject* WorldContextObject)
+{
+	return URomanEmpireWorldSubsystem::FindOrSpawnManager<AUnitSimulationManager>(WorldContextObject);
+}
@@ -0,0 +1,295 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "RomanEmpireGame/Units/UnitMorale.h"
+#include "RomanEmpireGame/Units/UnitTargeting.h"
+#include "RomanEmpireGame/Units/UnitDamageTable.h"
+#include "RomanEmpireGame/Units/UnitSpatialGrid.h"
+#include "UnitSimulationManager.generated.h"
+
+class AUnitBase;
+
+/**
+ * How kinematic units keep clear of each other
+ */
+UENUM(BlueprintType)
+enum class EUnitAvoidanceMode : uint8
+{
+	Separation	UMETA(DisplayName = "Separation"),	// Push apart from overlapping neighbours
+	Reciprocal	UMETA(DisplayName = "Reciprocal")	// ORCA velocity obstacles; units anticipate and share avoidance
+};
+
+/**
+ * Per-unit simulation flags
+ */
+enum class EUnitSimFlags : uint8
+{
+	None			= 0,
+	Kinematic		= 1 << 0,	// Moved by the simulation rather than CharacterMovementComponent
+	HasDestination	= 1 << 1,
+	Moved			= 1 << 2,	// Position changed this step and must be written back to the actor
+	PendingRemoval	= 1 << 3,	// Unregistered; the slot is compacted away at the start of the next step
+	Routing			= 1 << 4,	// Morale broke; the unit runs from the enemy and ignores orders until it rallies
+	HasTarget		= 1 << 5	// Engaging a commanded or acquired target; idle units are the ones that look for one
+};
+ENUM_CLASS_FLAGS(EUnitSimFlags);
+
+/**
+ * Hot per-unit data stored as parallel arrays so batch passes touch only what they read.
+ * Index i in every array refers to the same unit; removal swaps the last unit into the hole.
+ */
+struct FUnitSimulationData
+{
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<FVector> Destinations;
+	TArray<float> Yaws;
+	TArray<float> MaxSpeeds;
+	TArray<float> Radii;
+	TArray<float> HalfHeights;
+	TArray<float> GroundHeights;
+	TArray<EFactionID> Factions;
+	TArray<EUnitType> UnitTypes;
+	TArray<float> Morale;
+	TArray<float> BaseMorale;
+	TArray<EUnitStance> Stances;
+	TArray<float> AttackRanges;
+	TArray<EUnitSimFlags> Flags;
+
+	int32 Num() const { return Positions.Num(); }
+
+	int32 Add();
+	void RemoveAtSwap(int32 Index);
+};
+
+/**
+ * Hostility and morale bonus per faction, refreshed from the faction manager so batch passes never touch it
+ */
+struct FFactionRelationCache
+{
+	static constexpr int32 MaxFactions = 8;
+
+	uint8 HostileMasks[MaxFactions] = {};
+
+	// Same faction, friends and allies
+	uint8 FriendlyMasks[MaxFactions] = {};
+
+	float MoraleBonuses[MaxFactions] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+	bool AreHostile(EFactionID A, EFactionID B) const
+	{
+		return (HostileMasks[static_cast<uint8>(A) & (MaxFactions - 1)] >> (static_cast<uint8>(B) & (MaxFactions - 1))) & 1;
+	}
+
+	bool AreFriendly(EFactionID A, EFactionID B) const
+	{
+		return (FriendlyMasks[static_cast<uint8>(A) & (MaxFactions - 1)] >> (static_cast<uint8>(B) & (MaxFactions - 1))) & 1;
+	}
+
+	float GetMoraleBonus(EFactionID Faction) const
+	{
+		return MoraleBonuses[static_cast<uint8>(Faction) & (MaxFactions - 1)];
+	}
+};
+
+/**
+ * Runs movement for every AI-controlled unit in one parallel pass.
+ * Units not possessed by the player skip CharacterMovementComponent entirely: the simulation steers them
+ * towards their destination, avoids neighbours found through a shared spatial grid and registered obstacles,
+ * keeps them on the ground with budgeted height traces, and writes the result back to the actors.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AUnitSimulationManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AUnitSimulationManager();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Registration
+	void RegisterUnit(AUnitBase* Unit);
+	void UnregisterUnit(AUnitBase* Unit);
+
+	// Switches a unit between simulation-driven and character movement
+	void SetKinematic(AUnitBase* Unit, bool bKinematic);
+
+	// Commands
+	void SetDestination(AUnitBase* Unit, const FVector& Destination);
+	void ClearDestination(AUnitBase* Unit);
+
+	// Moves many units in one step; Destinations[i] is for Units[i]. Units not steered by the simulation are skipped.
+	void DispatchMoveOrders(const TArray<AUnitBase*>& Units, const TArray<FVector>& Destinations);
+	void SetMaxSpeed(AUnitBase* Unit, float MaxSpeed);
+	void SetBaseMorale(AUnitBase* Unit, int32 BaseMorale);
+	void SetFaction(AUnitBase* Unit, EFactionID Faction);
+	void SetStance(AUnitBase* Unit, EUnitStance Stance);
+	void SetHasTarget(AUnitBase* Unit, bool bHasTarget);
+	void SetYaw(AUnitBase* Unit, float Yaw);
+
+	bool HasDestination(const AUnitBase* Unit) const;
+
+	// Morale - adjusted by combat, advanced for every unit by the batched morale pass
+	// Returns false if the unit is not simulated
+	bool ApplyMoraleDelta(AUnitBase* Unit, float Delta);
+	void NotifyUnitDied(const AUnitBase* Unit);
+	bool IsRouting(const AUnitBase* Unit) const;
+
+	const FFactionRelationCache& GetFactionRelations() const { return FactionRelations; }
+
+	// Damage a hit deals after the attacker's faction bonus and the defender's defence; Attacker may be null
+	float ResolveDamage(const AUnitBase* Attacker, const AUnitBase* Defender, float RawDamage, bool bRanged, bool bBlocking);
+
+	// Call when a unit type's stats change, e.g. from an upgrade, so cached damage is rebuilt
+	void RefreshUnitTypeStats(const FUnitData& UnitData);
+
+	// Static circular obstacles units steer around, such as buildings; registering again moves the obstacle
+	void RegisterObstacle(AActor* Owner, const FVector& Center, float Radius);
+	void UnregisterObstacle(const AActor* Owner);
+
+	// Obstacle queries for other systems that collide with buildings; the grid is brought up to date first
+	const FUnitSpatialGrid& GetObstacleGrid();
+	const FVector& GetObstacleCenter(int32 Index) const { return ObstacleCenters[Index]; }
+	float GetObstacleRadius(int32 Index) const { return ObstacleRadii[Index]; }
+	AActor* GetObstacleOwner(int32 Index) const { return ObstacleOwners[Index]; }
+	float GetMaxObstacleRadius() const { return MaxObstacleRadius; }
+
+	// Queries; an index may refer to a unit unregistered this frame, in which case GetUnit returns null
+	int32 GetUnitIndex(const AUnitBase* Unit) const;
+	AUnitBase* GetUnit(int32 Index) const { return Units.IsValidIndex(Index) ? Units[Index] : nullptr; }
+
+	const FUnitSimulationData& GetData() const { return Data; }
+	const FUnitSpatialGrid& GetSpatialGrid() const { return SpatialGrid; }
+
+	// Slot count, including slots freed this frame
+	UFUNCTION(BlueprintPure, Category = "Units|Simulation")
+	int32 GetNumUnits() const { return Units.Num(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Units|Simulation")
+	TArray<AUnitBase*> GetUnitsInRadius(const FVector& Center, float Radius) const;
+
+	// Appends units of Faction (any faction for None) whose position projects inside ScreenRect, given in pixels within ViewRect.
+	// Positions are tested in clip space in one parallel pass, so nothing is deprojected per unit.
+	void GetUnitsInScreenRect(const FMatrix& ViewProjection, const FIntRect& ViewRect, const FBox2D& ScreenRect, EFactionID Faction, TArray<AUnitBase*>& OutUnits) const;
+
+	// Returns the world's unit simulation, spawning one on first use
+	UFUNCTION(BlueprintCallable, Category = "Units|Simulation", meta = (WorldContext = "WorldContextObject"))
+	static AUnitSimulationManager* GetUnitSimulationManager(UObject* WorldContextObject);
+
+protected:
+	// Base spatial grid cell size; roughly the largest neighbour query radius used per frame
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	float GridCellSize;
+
+	// Distance at which a unit counts as arrived
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	float ArrivalRadius;
+
+	// Distance over which units slow down before the destination
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	float SlowingRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Units|Simulation|Avoidance")
+	EUnitAvoidanceMode AvoidanceMode;
+
+	// Seconds ahead that collisions with other units are anticipated
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation|Avoidance")
+	float AvoidanceTimeHorizon;
+
+	// Seconds ahead that collisions with obstacles are anticipated
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation|Avoidance")
+	float ObstacleTimeHorizon;
+
+	// Upper bound on the neighbour search radius for avoidance
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation|Avoidance")
+	float AvoidanceNeighbourDistance;
+
+	// Separation applies while two units are closer than this many combined radii
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	float SeparationRange;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	float SeparationWeight;
+
+	// Neighbours considered per unit; bounds the cost inside dense formations
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	int32 MaxNeighbours;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	float TurnRate;
+
+	// Ground traces per frame, shared round-robin across moving units
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	int32 GroundSamplesPerFrame;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	TEnumAsByte<ECollisionChannel> GroundChannel;
+
+	// Longest step simulated at once, so a hitch does not fling units through each other
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Units|Simulation")
+	float MaxStepSeconds;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Units|Simulation|Morale")
+	FUnitMoraleSettings MoraleSettings;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Units|Simulation|Targeting")
+	FUnitTargetingSettings TargetingSettings;
+
+private:
+	UPROPERTY()
+	TArray<AUnitBase*> Units;
+
+	TMap<const AUnitBase*, int32> UnitIndices;
+
+	FUnitSimulationData Data;
+	FUnitSpatialGrid SpatialGrid;
+
+	// Scratch output of the parallel pass
+	TArray<FVector> NextPositions;
+	TArray<FVector> NextVelocities;
+	TArray<EUnitSimFlags> NextFlags;
+
+	TArray<int32> PendingRemovals;
+
+	// Static obstacles, rebuilt into their own grid only when one is added or removed
+	TArray<FVector> ObstacleCenters;
+	TArray<float> ObstacleRadii;
+	TArray<AActor*> ObstacleOwners;
+	TMap<const AActor*, int32> ObstacleIndices;
+	FUnitSpatialGrid ObstacleGrid;
+	float MaxObstacleRadius;
+	bool bObstaclesDirty;
+
+	int32 GroundSampleCursor;
+
+	FUnitMoraleSystem MoraleSystem;
+	FFactionRelationCache FactionRelations;
+
+	// Relations are re-read from diplomacy on morale steps only; false until the first read
+	bool bFactionRelationsValid;
+	FUnitDamageTable DamageTable;
+	TArray<int32> MoraleChanges;
+	TArray<FUnitMoraleSystem::FRoutChange> RoutChanges;
+
+	FUnitTargetAcquisition TargetAcquisition;
+	TArray<FUnitTargetAcquisition::FAssignment> TargetAssignments;
+
+	void CompactRemovedUnits();
+	void SyncCharacterUnits();
+	void SampleGroundHeights();
+	void RefreshFactionRelations();
+	void UpdateMorale(float DeltaSeconds);
+	void AcquireTargets(float DeltaSeconds);
+	void IntegrateMovement(float DeltaSeconds);
+	FVector2D ComputeSeparationVelocity(int32 Index, const FVector2D& Preferred) const;
+	FVector2D ComputeAvoidanceVelocity(int32 Index, const FVector2D& Preferred, float DeltaSeconds) const;
+	void RebuildObstacles();
+	void ApplyToActors();
+	bool TraceGround(const FVector& Location, float& OutHeight) const;
+};
@@ -0,0 +1,96 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitSpatialGrid.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+
+// Upper bound on cells per point before the cell size is grown
+static constexpr int32 MaxCellsPerPoint = 4;
+
+void FUnitSpatialGrid::Build(const TArray<FVector>& Positions, float BaseCellSize)
+{
+	const int32 NumPoints = Positions.Num();
+	if (NumPoints == 0)
+	{
+		Reset();
+		return;
+	}
+
+	FBox2D Bounds(ForceInit);
+	for (const FVector& Position : Positions)
+	{
+		Bounds += FVector2D(Position);
+	}
+
+	// Keep the grid proportional to the unit count when armies are far apart
+	const FVector2D Extent = Bounds.GetSize();
+	const float MinCellSize = FMath::Sqrt((Extent.X * Extent.Y) / static_cast<float>(NumPoints * MaxCellsPerPoint));
+	CellSize = FMath::Max3(BaseCellSize, MinCellSize, 1.0f);
+	InvCellSize = 1.0f / CellSize;
+
+	Origin = Bounds.Min;
+	Width = FMath::FloorToInt(Extent.X * InvCellSize) + 1;
+	Height = FMath::FloorToInt(Extent.Y * InvCellSize) + 1;
+
+	const int32 NumCells = Width * Height;
+	CellStart.Reset();
+	CellStart.SetNumZeroed(NumCells + 1);
+	PointCells.SetNumUninitialized(NumPoints);
+
+	// Counting sort: histogram, prefix sum, scatter
+	for (int32 Index = 0; Index < NumPoints; ++Index)
+	{
+		const FIntPoint Cell = GetCell(FVector2D(Positions[Index]));
+		const int32 CellIndex = Cell.Y * Width + Cell.X;
+		PointCells[Index] = CellIndex;
+		++CellStart[CellIndex + 1];
+	}
+
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		CellStart[Cell + 1] += CellStart[Cell];
+	}
+
+	SortedIndices.SetNumUninitialized(NumPoints);
+	SortedPoints.SetNumUninitialized(NumPoints);
+
+	TArray<int32> Cursor(CellStart.GetData(), NumCells);
+	for (int32 Index = 0; Index < NumPoints; ++Index)
+	{
+		const int32 Slot = Cursor[PointCells[Index]]++;
+		SortedIndices[Slot] = Index;
+		SortedPoints[Slot] = FVector2D(Positions[Index]);
+	}
+}
+
+void FUnitSpatialGrid::Reset()
+{
+	Width = 0;
+	Height = 0;
+	CellStart.Reset();
+	SortedIndices.Reset();
+	SortedPoints.Reset();
+	PointCells.Reset();
+}
+
+void FUnitSpatialGrid::GatherInRadius(const FVector2D& Center, float Radius, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+	ForEachInRadius(Center, Radius, [&OutIndices](int32 Index, float)
+	{
+		OutIndices.Add(Index);
+	});
+}
+
+FIntPoint FUnitSpatialGrid::GetCell(const FVector2D& Point) const
+{
+	return FIntPoint(
+		FMath::Clamp(FMath::FloorToInt((Point.X - Origin.X) * InvCellSize), 0, Width - 1),
+		FMath::Clamp(FMath::FloorToInt((Point.Y - Origin.Y) * InvCellSize), 0, Height - 1));
+}
+
+FIntRect FUnitSpatialGrid::GetCellRange(const FVector2D& Min, const FVector2D& Max) const
+{
+	const FIntPoint MinCell = GetCell(Min);
+	const FIntPoint MaxCell = GetCell(Max);
+	return FIntRect(MinCell, MaxCell);
+}
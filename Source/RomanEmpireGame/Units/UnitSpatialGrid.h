@@ -0,0 +1,98 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform 2D grid over unit positions, rebuilt from scratch each simulation step.
+ * Points are counting-sorted by cell so a query walks contiguous memory and never visits a point twice.
+ */
+struct ROMANEMPIREGAME_API FUnitSpatialGrid
+{
+public:
+	// Cell size used when units are packed closely; grows when they spread out so cell count stays bounded
+	void Build(const TArray<FVector>& Positions, float BaseCellSize);
+
+	void Reset();
+
+	int32 Num() const { return SortedIndices.Num(); }
+
+	float GetCellSize() const { return CellSize; }
+
+	// Calls Func(int32 Index, float DistanceSquared) for every point within Radius of Center in the XY plane
+	template<typename FunctionType>
+	void ForEachInRadius(const FVector2D& Center, float Radius, FunctionType&& Func) const
+	{
+		if (SortedIndices.Num() == 0)
+		{
+			return;
+		}
+
+		const FIntRect Cells = GetCellRange(Center - FVector2D(Radius), Center + FVector2D(Radius));
+		const float RadiusSquared = Radius * Radius;
+
+		for (int32 Y = Cells.Min.Y; Y <= Cells.Max.Y; ++Y)
+		{
+			for (int32 X = Cells.Min.X; X <= Cells.Max.X; ++X)
+			{
+				const int32 Cell = Y * Width + X;
+				for (int32 Slot = CellStart[Cell]; Slot < CellStart[Cell + 1]; ++Slot)
+				{
+					const float DistanceSquared = FVector2D::DistSquared(SortedPoints[Slot], Center);
+					if (DistanceSquared <= RadiusSquared)
+					{
+						Func(SortedIndices[Slot], DistanceSquared);
+					}
+				}
+			}
+		}
+	}
+
+	// Calls Func(int32 Index) for every point inside Box in the XY plane
+	template<typename FunctionType>
+	void ForEachInBox(const FBox2D& Box, FunctionType&& Func) const
+	{
+		if (SortedIndices.Num() == 0)
+		{
+			return;
+		}
+
+		const FIntRect Cells = GetCellRange(Box.Min, Box.Max);
+
+		for (int32 Y = Cells.Min.Y; Y <= Cells.Max.Y; ++Y)
+		{
+			for (int32 X = Cells.Min.X; X <= Cells.Max.X; ++X)
+			{
+				const int32 Cell = Y * Width + X;
+				for (int32 Slot = CellStart[Cell]; Slot < CellStart[Cell + 1]; ++Slot)
+				{
+					if (Box.IsInside(SortedPoints[Slot]))
+					{
+						Func(SortedIndices[Slot]);
+					}
+				}
+			}
+		}
+	}
+
+	void GatherInRadius(const FVector2D& Center, float Radius, TArray<int32>& OutIndices) const;
+
+private:
+	FVector2D Origin = FVector2D::ZeroVector;
+	float CellSize = 100.0f;
+	float InvCellSize = 0.01f;
+	int32 Width = 0;
+	int32 Height = 0;
+
+	// Prefix offsets into SortedIndices, one past the end for the last cell
+	TArray<int32> CellStart;
+	TArray<int32> SortedIndices;
+	TArray<FVector2D> SortedPoints;
+	TArray<int32> PointCells;
+
+	FIntPoint GetCell(const FVector2D& Point) const;
+
+	// Inclusive cell range covering the given area, clamped to the grid
+	FIntRect GetCellRange(const FVector2D& Min, const FVector2D& Max) const;
+};
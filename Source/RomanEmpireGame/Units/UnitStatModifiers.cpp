@@ -0,0 +1,137 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitStatModifiers.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+
+namespace
+{
+	constexpr int32 NumStats = static_cast<int32>(EUnitStat::DodgeSpeed) + 1;
+
+	float GetStat(const FUnitStats& Stats, EUnitStat Stat)
+	{
+		switch (Stat)
+		{
+		case EUnitStat::MaxHealth:		return Stats.MaxHealth;
+		case EUnitStat::MeleeAttack:	return Stats.MeleeAttack;
+		case EUnitStat::RangedAttack:	return Stats.RangedAttack;
+		case EUnitStat::MeleeDefense:	return Stats.MeleeDefense;
+		case EUnitStat::RangedDefense:	return Stats.RangedDefense;
+		case EUnitStat::Armor:			return Stats.Armor;
+		case EUnitStat::Speed:			return Stats.Speed;
+		case EUnitStat::Morale:			return Stats.Morale;
+		case EUnitStat::Stamina:		return Stats.Stamina;
+		case EUnitStat::AttackSpeed:	return Stats.AttackSpeed;
+		case EUnitStat::BlockStrength:	return Stats.BlockStrength;
+		case EUnitStat::DodgeSpeed:		return Stats.DodgeSpeed;
+		default:						return 0.0f;
+		}
+	}
+
+	// Whole-number stats are rounded so the damage table and UI see the same values as before
+	void SetStat(FUnitStats& Stats, EUnitStat Stat, float Value)
+	{
+		switch (Stat)
+		{
+		case EUnitStat::MaxHealth:		Stats.MaxHealth = FMath::Max(1, FMath::RoundToInt(Value)); break;
+		case EUnitStat::MeleeAttack:	Stats.MeleeAttack = FMath::RoundToInt(Value); break;
+		case EUnitStat::RangedAttack:	Stats.RangedAttack = FMath::RoundToInt(Value); break;
+		case EUnitStat::MeleeDefense:	Stats.MeleeDefense = FMath::RoundToInt(Value); break;
+		case EUnitStat::RangedDefense:	Stats.RangedDefense = FMath::RoundToInt(Value); break;
+		case EUnitStat::Armor:			Stats.Armor = FMath::RoundToInt(Value); break;
+		case EUnitStat::Speed:			Stats.Speed = FMath::Max(0.0f, Value); break;
+		case EUnitStat::Morale:			Stats.Morale = FMath::Max(1, FMath::RoundToInt(Value)); break;
+		case EUnitStat::Stamina:		Stats.Stamina = FMath::Max(1.0f, Value); break;
+		case EUnitStat::AttackSpeed:	Stats.AttackSpeed = FMath::Max(0.01f, Value); break;
+		case EUnitStat::BlockStrength:	Stats.BlockStrength = Value; break;
+		case EUnitStat::DodgeSpeed:		Stats.DodgeSpeed = Value; break;
+		default:						break;
+		}
+	}
+}
+
+bool FUnitStatModifierStack::Add(const FUnitStatModifier& Modifier)
+{
+	FUnitStatModifier* Existing = Modifiers.FindByPredicate([&Modifier](const FUnitStatModifier& Other) { return Other.Id == Modifier.Id; });
+	if (Existing)
+	{
+		if (Existing->Source == Modifier.Source && Existing->Stat == Modifier.Stat
+			&& Existing->Additive == Modifier.Additive && Existing->Multiplier == Modifier.Multiplier)
+		{
+			return false;
+		}
+		*Existing = Modifier;
+	}
+	else
+	{
+		Modifiers.Add(Modifier);
+	}
+
+	bDirty = true;
+	return true;
+}
+
+bool FUnitStatModifierStack::Remove(FName Id)
+{
+	if (Modifiers.RemoveAll([Id](const FUnitStatModifier& Modifier) { return Modifier.Id == Id; }) == 0)
+	{
+		return false;
+	}
+
+	bDirty = true;
+	return true;
+}
+
+bool FUnitStatModifierStack::RemoveAllFromSource(EStatModifierSource Source)
+{
+	if (Modifiers.RemoveAll([Source](const FUnitStatModifier& Modifier) { return Modifier.Source == Source; }) == 0)
+	{
+		return false;
+	}
+
+	bDirty = true;
+	return true;
+}
+
+bool FUnitStatModifierStack::Contains(FName Id) const
+{
+	return Modifiers.ContainsByPredicate([Id](const FUnitStatModifier& Modifier) { return Modifier.Id == Id; });
+}
+
+void FUnitStatModifierStack::Recompute(const FUnitStats& BaseStats) const
+{
+	EffectiveStats = BaseStats;
+	bDirty = false;
+
+	if (Modifiers.Num() == 0)
+	{
+		return;
+	}
+
+	float Additives[NumStats] = {};
+	float Multipliers[NumStats];
+	uint8 Touched[NumStats] = {};
+	for (int32 Stat = 0; Stat < NumStats; ++Stat)
+	{
+		Multipliers[Stat] = 1.0f;
+	}
+
+	for (const FUnitStatModifier& Modifier : Modifiers)
+	{
+		const int32 Stat = static_cast<int32>(Modifier.Stat);
+		if (Stat < NumStats)
+		{
+			Additives[Stat] += Modifier.Additive;
+			Multipliers[Stat] *= Modifier.Multiplier;
+			Touched[Stat] = 1;
+		}
+	}
+
+	for (int32 Stat = 0; Stat < NumStats; ++Stat)
+	{
+		if (Touched[Stat])
+		{
+			const EUnitStat UnitStat = static_cast<EUnitStat>(Stat);
+			SetStat(EffectiveStats, UnitStat, (GetStat(BaseStats, UnitStat) + Additives[Stat]) * Multipliers[Stat]);
+		}
+	}
+}
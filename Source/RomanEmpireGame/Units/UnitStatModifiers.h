@@ -0,0 +1,116 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "UnitStatModifiers.generated.h"
+
+/**
+ * Stat a modifier changes
+ */
+UENUM(BlueprintType)
+enum class EUnitStat : uint8
+{
+	MaxHealth		UMETA(DisplayName = "Max Health"),
+	MeleeAttack		UMETA(DisplayName = "Melee Attack"),
+	RangedAttack	UMETA(DisplayName = "Ranged Attack"),
+	MeleeDefense	UMETA(DisplayName = "Melee Defense"),
+	RangedDefense	UMETA(DisplayName = "Ranged Defense"),
+	Armor			UMETA(DisplayName = "Armor"),
+	Speed			UMETA(DisplayName = "Speed"),
+	Morale			UMETA(DisplayName = "Morale"),
+	Stamina			UMETA(DisplayName = "Stamina"),
+	AttackSpeed		UMETA(DisplayName = "Attack Speed"),
+	BlockStrength	UMETA(DisplayName = "Block Strength"),
+	DodgeSpeed		UMETA(DisplayName = "Dodge Speed")
+};
+
+/**
+ * Where a modifier comes from, so everything from one source can be lifted at once
+ */
+UENUM(BlueprintType)
+enum class EStatModifierSource : uint8
+{
+	Formation	UMETA(DisplayName = "Formation"),
+	Stance		UMETA(DisplayName = "Stance"),
+	Terrain		UMETA(DisplayName = "Terrain"),
+	Building	UMETA(DisplayName = "Building"),	// Upgrades such as the Armory
+	Faction		UMETA(DisplayName = "Faction"),
+	Ability		UMETA(DisplayName = "Ability")
+};
+
+/**
+ * One change to one stat; the effective value is (base + all additions) * all multipliers
+ */
+USTRUCT(BlueprintType)
+struct FUnitStatModifier
+{
+	GENERATED_BODY()
+
+	// Adding a modifier with an Id already on the unit replaces it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	FName Id;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	EStatModifierSource Source;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	EUnitStat Stat;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	float Additive;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	float Multiplier;
+
+	FUnitStatModifier()
+		: Source(EStatModifierSource::Ability)
+		, Stat(EUnitStat::MeleeAttack)
+		, Additive(0.0f)
+		, Multiplier(1.0f)
+	{}
+
+	FUnitStatModifier(FName InId, EStatModifierSource InSource, EUnitStat InStat, float InAdditive, float InMultiplier = 1.0f)
+		: Id(InId)
+		, Source(InSource)
+		, Stat(InStat)
+		, Additive(InAdditive)
+		, Multiplier(InMultiplier)
+	{}
+};
+
+/**
+ * Modifiers active on one unit and the stats they produce.
+ * Base stats are never touched; the effective stats are rebuilt only the first time they are read after the modifier set changed.
+ */
+struct ROMANEMPIREGAME_API FUnitStatModifierStack
+{
+public:
+	// Returns true if the modifier set changed
+	bool Add(const FUnitStatModifier& Modifier);
+	bool Remove(FName Id);
+	bool RemoveAllFromSource(EStatModifierSource Source);
+
+	bool Contains(FName Id) const;
+	int32 Num() const { return Modifiers.Num(); }
+	bool IsDirty() const { return bDirty; }
+	void MarkDirty() { bDirty = true; }
+
+	const FUnitStats& GetEffectiveStats(const FUnitStats& BaseStats) const
+	{
+		if (bDirty)
+		{
+			Recompute(BaseStats);
+		}
+		return EffectiveStats;
+	}
+
+	void Recompute(const FUnitStats& BaseStats) const;
+
+private:
+	TArray<FUnitStatModifier, TInlineAllocator<4>> Modifiers;
+
+	mutable FUnitStats EffectiveStats;
+	mutable bool bDirty = true;
+};
@@ -0,0 +1,149 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitTargeting.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Units/UnitSimulationManager.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// Search radius for a stance; a unit always sees at least as far as it can strike
+	float GetAcquisitionRange(EUnitStance Stance, float AttackRange, const FUnitTargetingSettings& Settings)
+	{
+		switch (Stance)
+		{
+		case EUnitStance::Aggressive:
+			return FMath::Max(Settings.AggressiveRange, AttackRange);
+		case EUnitStance::Defensive:
+			return FMath::Max(Settings.DefensiveRange, AttackRange);
+		case EUnitStance::Skirmish:
+			return FMath::Max(Settings.SkirmishRange, AttackRange);
+		default:
+			return AttackRange;
+		}
+	}
+}
+
+void FUnitTargetAcquisition::Update(float DeltaSeconds, const FUnitSimulationData& Data, const FUnitSpatialGrid& Grid, const FFactionRelationCache& Relations,
+	const FUnitTargetingSettings& Settings, TArray<FAssignment>& OutAssignments)
+{
+	const int32 NumUnits = Data.Num();
+	if (NumUnits == 0 || Settings.AcquisitionInterval <= 0.0f)
+	{
+		return;
+	}
+
+	// Visit the share of units due this frame, carrying the remainder so small armies still progress
+	Carry += NumUnits * FMath::Min(DeltaSeconds / Settings.AcquisitionInterval, 1.0f);
+	const int32 Budget = FMath::Min(FMath::FloorToInt(Carry), NumUnits);
+	Carry -= Budget;
+
+	Slice.Reset();
+	for (int32 Visited = 0; Visited < Budget; ++Visited)
+	{
+		Cursor = (Cursor + 1) % NumUnits;
+
+		// Only idle AI units look for work; skirmishers that are already shooting still watch for enemies closing in
+		const EUnitSimFlags Flags = Data.Flags[Cursor];
+		if (!EnumHasAnyFlags(Flags, EUnitSimFlags::Kinematic)
+			|| EnumHasAnyFlags(Flags, EUnitSimFlags::Routing | EUnitSimFlags::PendingRemoval | EUnitSimFlags::HasDestination)
+			|| (EnumHasAnyFlags(Flags, EUnitSimFlags::HasTarget) && Data.Stances[Cursor] != EUnitStance::Skirmish))
+		{
+			continue;
+		}
+
+		Slice.Add(Cursor);
+	}
+
+	if (Slice.Num() == 0)
+	{
+		return;
+	}
+
+	Results.SetNumUninitialized(Slice.Num());
+
+	ParallelFor(Slice.Num(), [&](int32 SliceIndex)
+	{
+		const int32 Index = Slice[SliceIndex];
+		const FVector2D Position(Data.Positions[Index]);
+		const EFactionID Faction = Data.Factions[Index];
+		const EUnitStance Stance = Data.Stances[Index];
+		const float Radius = Data.Radii[Index];
+		const float AttackRange = Data.AttackRanges[Index];
+		const bool bHasTarget = EnumHasAnyFlags(Data.Flags[Index], EUnitSimFlags::HasTarget);
+
+		FAssignment& Result = Results[SliceIndex];
+		Result.Index = Index;
+		Result.Target = INDEX_NONE;
+		Result.bFallBack = false;
+
+		float BestScore = TNumericLimits<float>::Max();
+		float NearestDistanceSquared = TNumericLimits<float>::Max();
+		int32 Nearest = INDEX_NONE;
+
+		Grid.ForEachInRadius(Position, GetAcquisitionRange(Stance, AttackRange, Settings), [&](int32 Other, float DistanceSquared)
+		{
+			const EUnitSimFlags OtherFlags = Data.Flags[Other];
+			if (Other == Index
+				|| EnumHasAnyFlags(OtherFlags, EUnitSimFlags::PendingRemoval)
+				|| !Relations.AreHostile(Faction, Data.Factions[Other]))
+			{
+				return;
+			}
+
+			if (DistanceSquared < NearestDistanceSquared)
+			{
+				NearestDistanceSquared = DistanceSquared;
+				Nearest = Other;
+			}
+
+			// Only aggressive units run down a broken enemy
+			if (EnumHasAnyFlags(OtherFlags, EUnitSimFlags::Routing) && Stance != EUnitStance::Aggressive)
+			{
+				return;
+			}
+
+			const float Distance = FMath::Sqrt(DistanceSquared);
+			const float Reach = Radius + Data.Radii[Other];
+			if (Stance == EUnitStance::StandGround && Distance > AttackRange + Reach)
+			{
+				return;
+			}
+
+			// Enemies that can already strike this unit come first
+			const float Score = Distance <= Data.AttackRanges[Other] + Reach ? Distance - Settings.ThreatBonus : Distance;
+			if (Score < BestScore)
+			{
+				BestScore = Score;
+				Result.Target = Other;
+			}
+		});
+
+		if (Stance == EUnitStance::Skirmish
+			&& Nearest != INDEX_NONE
+			&& NearestDistanceSquared < FMath::Square(Settings.SkirmishMinDistance))
+		{
+			// Give ground rather than be caught in melee, then shoot again from the new spot
+			const FVector2D Away = (Position - FVector2D(Data.Positions[Nearest])).GetSafeNormal();
+			if (!Away.IsNearlyZero())
+			{
+				Result.bFallBack = true;
+				Result.FallBackDestination = Data.Positions[Index] + FVector(Away * Settings.SkirmishFallBackDistance, 0.0f);
+			}
+		}
+
+		// A skirmisher that already has a target only reports when it must fall back
+		if (bHasTarget)
+		{
+			Result.Target = INDEX_NONE;
+		}
+	});
+
+	for (const FAssignment& Result : Results)
+	{
+		if (Result.Target != INDEX_NONE || Result.bFallBack)
+		{
+			OutAssignments.Add(Result);
+		}
+	}
+}
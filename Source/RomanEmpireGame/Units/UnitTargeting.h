@@ -0,0 +1,82 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UnitTargeting.generated.h"
+
+struct FUnitSimulationData;
+struct FUnitSpatialGrid;
+struct FFactionRelationCache;
+
+/**
+ * Tuning for automatic target acquisition
+ */
+USTRUCT(BlueprintType)
+struct FUnitTargetingSettings
+{
+	GENERATED_BODY()
+
+	// Seconds for the staggered evaluation to visit every unit once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float AcquisitionInterval;
+
+	// How far each stance looks for enemies; Stand Ground only uses the unit's own attack range
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float AggressiveRange;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float DefensiveRange;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float SkirmishRange;
+
+	// Skirmishers fall back when an enemy comes this close
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float SkirmishMinDistance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float SkirmishFallBackDistance;
+
+	// Distance credited to enemies already close enough to strike the unit, so immediate threats are answered first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float ThreatBonus;
+
+	FUnitTargetingSettings()
+		: AcquisitionInterval(0.5f)
+		, AggressiveRange(3000.0f)
+		, DefensiveRange(1200.0f)
+		, SkirmishRange(2500.0f)
+		, SkirmishMinDistance(600.0f)
+		, SkirmishFallBackDistance(800.0f)
+		, ThreatBonus(400.0f)
+	{}
+};
+
+/**
+ * Finds targets for idle AI units according to their stance.
+ * Each step evaluates only the share of units due this frame, so every unit is revisited once per
+ * AcquisitionInterval and the cost of a large army is spread evenly across frames.
+ */
+struct FUnitTargetAcquisition
+{
+public:
+	struct FAssignment
+	{
+		int32 Index;
+		int32 Target;			// Unit index to attack, or INDEX_NONE
+		bool bFallBack;			// Skirmisher stepping away from an enemy that closed in
+		FVector FallBackDestination;
+	};
+
+	void Update(float DeltaSeconds, const FUnitSimulationData& Data, const FUnitSpatialGrid& Grid, const FFactionRelationCache& Relations,
+		const FUnitTargetingSettings& Settings, TArray<FAssignment>& OutAssignments);
+
+private:
+	int32 Cursor = 0;
+	float Carry = 0.0f;
+
+	// Scratch for the slice evaluated this step
+	TArray<int32> Slice;
+	TArray<FAssignment> Results;
+};
@@ -0,0 +1,138 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "UnitTypeRegistry.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+
+namespace
+{
+	struct FBuiltInUnitType
+	{
+		EUnitType Type;
+		EUnitCategory Category;
+		const TCHAR* DisplayName;
+		const TCHAR* Description;
+		int32 MaxHealth;
+		int32 MeleeAttack;
+		int32 RangedAttack;
+		int32 MeleeDefense;
+		int32 RangedDefense;
+		int32 Armor;
+		float Speed;
+		int32 Morale;
+		float BlockStrength;
+		int32 GoldCost;
+		int32 FoodCost;
+		float TrainingTime;
+		float AttackRange;
+		bool bCanUseRanged;
+		bool bHasShield;
+		const TCHAR* PrimaryWeapon;
+		const TCHAR* SecondaryWeapon;
+	};
+
+	// Stats used when no unit type data table row replaces them
+	const FBuiltInUnitType BuiltInUnitTypes[] =
+	{
+		{ EUnitType::Legionary, EUnitCategory::Infantry, TEXT("Legionary"), TEXT("The disciplined backbone of the Roman army. Armed with gladius, pilum, and scutum."),
+			120, 12, 8, 10, 8, 5, 280.0f, 60, 1.2f, 150, 50, 15.0f, 150.0f, true, true, TEXT("Gladius"), TEXT("Pilum") },
+		{ EUnitType::Centurion, EUnitCategory::Infantry, TEXT("Centurion"), TEXT("Veteran officer who commands a century and steadies the men around him."),
+			180, 16, 6, 14, 10, 7, 280.0f, 90, 1.3f, 400, 80, 30.0f, 150.0f, false, true, TEXT("Gladius"), nullptr },
+		{ EUnitType::Velites, EUnitCategory::Infantry, TEXT("Velites"), TEXT("Light skirmishers who harass the enemy with javelins before the lines meet."),
+			80, 8, 10, 6, 6, 2, 330.0f, 40, 1.0f, 80, 40, 10.0f, 1800.0f, true, true, TEXT("Javelin"), TEXT("Gladius") },
+		{ EUnitType::Triarii, EUnitCategory::Infantry, TEXT("Triarii"), TEXT("Seasoned spearmen held in the third line as a last reserve."),
+			140, 11, 0, 14, 10, 6, 260.0f, 75, 1.3f, 200, 60, 20.0f, 200.0f, false, true, TEXT("Hasta"), nullptr },
+		{ EUnitType::Praetorian, EUnitCategory::Infantry, TEXT("Praetorian"), TEXT("Elite guard of the general, better armoured and paid than any legionary."),
+			160, 15, 8, 14, 10, 7, 280.0f, 85, 1.3f, 350, 70, 25.0f, 150.0f, true, true, TEXT("Gladius"), TEXT("Pilum") },
+		{ EUnitType::Sagittarii, EUnitCategory::Ranged, TEXT("Sagittarii"), TEXT("Auxiliary archers with composite bows."),
+			70, 6, 12, 4, 4, 1, 300.0f, 40, 1.0f, 120, 40, 14.0f, 2500.0f, true, false, TEXT("Bow"), TEXT("Pugio") },
+		{ EUnitType::Javelinmen, EUnitCategory::Ranged, TEXT("Javelinmen"), TEXT("Auxiliaries who throw heavy javelins at short range."),
+			80, 7, 11, 5, 5, 2, 320.0f, 40, 1.0f, 100, 40, 12.0f, 1800.0f, true, false, TEXT("Javelin"), nullptr },
+		{ EUnitType::Slingers, EUnitCategory::Ranged, TEXT("Slingers"), TEXT("Balearic slingers whose stones outrange most bows."),
+			65, 5, 9, 4, 5, 1, 320.0f, 35, 1.0f, 70, 30, 10.0f, 2200.0f, true, false, TEXT("Sling"), nullptr },
+		{ EUnitType::Equites, EUnitCategory::Cavalry, TEXT("Equites"), TEXT("Roman horsemen who scout, pursue and strike the flanks."),
+			150, 14, 0, 8, 6, 4, 600.0f, 60, 1.0f, 300, 80, 25.0f, 200.0f, false, true, TEXT("Spatha"), nullptr },
+		{ EUnitType::CavalryArcher, EUnitCategory::Cavalry, TEXT("Cavalry Archer"), TEXT("Mounted archers who shoot on the move and avoid melee."),
+			120, 8, 12, 6, 6, 3, 620.0f, 55, 1.0f, 350, 80, 28.0f, 2500.0f, true, false, TEXT("Bow"), TEXT("Spatha") },
+		{ EUnitType::Onager, EUnitCategory::Siege, TEXT("Onager"), TEXT("Torsion catapult that hurls stones over walls and into formations."),
+			200, 0, 40, 2, 10, 4, 120.0f, 40, 1.0f, 500, 60, 40.0f, 6000.0f, true, false, nullptr, nullptr },
+		{ EUnitType::Ballista, EUnitCategory::Siege, TEXT("Ballista"), TEXT("Bolt thrower that picks off men and machines at long range."),
+			150, 0, 30, 2, 8, 3, 140.0f, 40, 1.0f, 400, 50, 35.0f, 4500.0f, true, false, nullptr, nullptr },
+		{ EUnitType::Ram, EUnitCategory::Siege, TEXT("Battering Ram"), TEXT("Covered ram for breaking gates and walls."),
+			400, 60, 0, 4, 20, 10, 100.0f, 50, 1.0f, 300, 50, 30.0f, 200.0f, false, false, nullptr, nullptr },
+	};
+}
+
+FUnitTypeRegistry::FUnitTypeRegistry()
+{
+	for (const FBuiltInUnitType& BuiltIn : BuiltInUnitTypes)
+	{
+		FUnitData Data;
+		Data.UnitType = BuiltIn.Type;
+		Data.Category = BuiltIn.Category;
+		Data.DisplayName = FText::FromString(BuiltIn.DisplayName);
+		Data.Description = FText::FromString(BuiltIn.Description);
+
+		Data.BaseStats.MaxHealth = BuiltIn.MaxHealth;
+		Data.BaseStats.MeleeAttack = BuiltIn.MeleeAttack;
+		Data.BaseStats.RangedAttack = BuiltIn.RangedAttack;
+		Data.BaseStats.MeleeDefense = BuiltIn.MeleeDefense;
+		Data.BaseStats.RangedDefense = BuiltIn.RangedDefense;
+		Data.BaseStats.Armor = BuiltIn.Armor;
+		Data.BaseStats.Speed = BuiltIn.Speed;
+		Data.BaseStats.Morale = BuiltIn.Morale;
+		Data.BaseStats.BlockStrength = BuiltIn.BlockStrength;
+
+		Data.GoldCost = BuiltIn.GoldCost;
+		Data.FoodCost = BuiltIn.FoodCost;
+		Data.TrainingTime = BuiltIn.TrainingTime;
+		Data.AttackRange = BuiltIn.AttackRange;
+		Data.bCanUseRanged = BuiltIn.bCanUseRanged;
+		Data.bHasShield = BuiltIn.bHasShield;
+		Data.PrimaryWeapon = BuiltIn.PrimaryWeapon ? FName(BuiltIn.PrimaryWeapon) : NAME_None;
+		Data.SecondaryWeapon = BuiltIn.SecondaryWeapon ? FName(BuiltIn.SecondaryWeapon) : NAME_None;
+
+		const int32 Index = Slot(BuiltIn.Type);
+		Defaults[Index] = Data;
+		Types[Index] = MoveTemp(Data);
+	}
+}
+
+FUnitTypeRegistry& FUnitTypeRegistry::Get()
+{
+	// Constructed on first use, which may be while the module loads and class default objects are built
+	static FUnitTypeRegistry Registry;
+	return Registry;
+}
+
+int32 FUnitTypeRegistry::LoadFromDataTable(const UDataTable* Table)
+{
+	// Drop rows from a previous session, whose table may have been edited or may not apply to this map
+	for (int32 Index = 0; Index < NumUnitTypes; ++Index)
+	{
+		Types[Index] = Defaults[Index];
+		bOverridden[Index] = false;
+	}
+
+	if (!Table)
+	{
+		return 0;
+	}
+
+	int32 NumLoaded = 0;
+	Table->ForeachRow<FUnitTypeRow>(TEXT("FUnitTypeRegistry::LoadFromDataTable"), [this, &NumLoaded](const FName& RowName, const FUnitTypeRow& Row)
+	{
+		if (Row.Data.UnitType == EUnitType::None)
+		{
+			UE_LOG(LogRomanEmpire, Warning, TEXT("Unit type row %s has no unit type, skipped"), *RowName.ToString());
+			return;
+		}
+
+		const int32 Index = Slot(Row.Data.UnitType);
+		Types[Index] = Row.Data;
+		bOverridden[Index] = true;
+		++NumLoaded;
+	});
+
+	UE_LOG(LogRomanEmpire, Log, TEXT("Loaded %d unit types from %s"), NumLoaded, *Table->GetName());
+	return NumLoaded;
+}
@@ -0,0 +1,51 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "UnitTypeRegistry.generated.h"
+
+/**
+ * Data table row describing one unit type; the table can be authored in the editor or imported from JSON/CSV
+ */
+USTRUCT(BlueprintType)
+struct FUnitTypeRow : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unit")
+	FUnitData Data;
+};
+
+/**
+ * Immutable per-type unit data shared by every instance of the type.
+ * Every type starts from the built-in definition in UnitTypeRegistry.cpp; rows loaded from a data table replace it until the next load.
+ * Entries live in a fixed array indexed by EUnitType, so references handed out stay valid for the lifetime of the game.
+ */
+class ROMANEMPIREGAME_API FUnitTypeRegistry
+{
+public:
+	static constexpr int32 NumUnitTypes = static_cast<int32>(EUnitType::Ram) + 1;
+
+	static FUnitTypeRegistry& Get();
+
+	// Restores every built-in definition, then applies the rows in Table if there is one; returns the number of rows loaded.
+	// The registry outlives a play session, so each session must load its own table, or none, through here.
+	int32 LoadFromDataTable(const UDataTable* Table);
+
+	// Whether the type's definition came from a data table row
+	bool IsOverridden(EUnitType Type) const { return bOverridden[Slot(Type)]; }
+
+	const FUnitData& GetUnitData(EUnitType Type) const { return Types[Slot(Type)]; }
+
+private:
+	FUnitTypeRegistry();
+
+	FUnitData Defaults[NumUnitTypes];
+	FUnitData Types[NumUnitTypes];
+	bool bOverridden[NumUnitTypes] = {};
+
+	static int32 Slot(EUnitType Type) { return FMath::Min(static_cast<int32>(Type), NumUnitTypes - 1); }
+};
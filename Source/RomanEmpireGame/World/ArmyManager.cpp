@@ -0,0 +1,437 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "ArmyManager.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "RomanEmpireGame/World/WorldMapManager.h"
+#include "RomanEmpireGame/World/TerritoryRegion.h"
+#include "RomanEmpireGame/Units/UnitBase.h"
+#include "Kismet/GameplayStatics.h"
+
+AArmyManager::AArmyManager()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	MovesPerTurn = 2;
+	MaxPathLength = 32;
+	FormationSpacing = 150.0f;
+	FormationWidth = 20;
+
+	WorldMapManager = nullptr;
+	FactionManager = nullptr;
+	NextArmyID = 1;
+}
+
+void AArmyManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Find managers
+	TArray<AActor*> FoundActors;
+
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AFactionManager::StaticClass(), FoundActors);
+	if (FoundActors.Num() > 0)
+	{
+		FactionManager = Cast<AFactionManager>(FoundActors[0]);
+	}
+
+	FoundActors.Empty();
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AWorldMapManager::StaticClass(), FoundActors);
+	if (FoundActors.Num() > 0)
+	{
+		WorldMapManager = Cast<AWorldMapManager>(FoundActors[0]);
+	}
+}
+
+int32 AArmyManager::CreateArmy(EFactionID OwnerFaction, ATerritoryRegion* Location, const TArray<FRegimentStack>& Regiments)
+{
+	if (!Location || Location->GetMapIndex() == INDEX_NONE || OwnerFaction == EFactionID::None)
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("Cannot create army without an owner and a map territory"));
+		return INDEX_NONE;
+	}
+
+	FArmyStack& Army = Armies.AddDefaulted_GetRef();
+	Army.ArmyID = NextArmyID++;
+	Army.OwnerFaction = OwnerFaction;
+	Army.Regiments = Regiments;
+
+	ArmySlots.Add(Army.ArmyID, Armies.Num() - 1);
+	SetArmyLocation(Army, Location->GetMapIndex());
+
+	UE_LOG(LogRomanEmpire, Log, TEXT("Army %d raised for faction %d in %s with %d soldiers"),
+		Army.ArmyID, static_cast<int32>(OwnerFaction), *Location->GetTerritoryID().ToString(), Army.GetSoldierCount());
+
+	return Army.ArmyID;
+}
+
+void AArmyManager::DisbandArmy(int32 ArmyID)
+{
+	const int32* Slot = ArmySlots.Find(ArmyID);
+	if (!Slot)
+	{
+		return;
+	}
+
+	if (FExpandedArmy* Expanded = ExpandedArmies.Find(ArmyID))
+	{
+		for (const TWeakObjectPtr<AUnitBase>& Unit : Expanded->Units)
+		{
+			if (Unit.IsValid())
+			{
+				Unit->Destroy();
+			}
+		}
+		ExpandedArmies.Remove(ArmyID);
+	}
+
+	const int32 Index = *Slot;
+	ArmiesByTerritory.RemoveSingle(Armies[Index].LocationIndex, ArmyID);
+	ArmySlots.Remove(ArmyID);
+
+	// Swap the last army into the hole and repoint its slot
+	Armies.RemoveAtSwap(Index);
+	if (Armies.IsValidIndex(Index))
+	{
+		ArmySlots.Add(Armies[Index].ArmyID, Index);
+	}
+}
+
+bool AArmyManager::AddSoldiers(int32 ArmyID, EUnitType UnitType, int32 Count, uint8 Experience)
+{
+	FArmyStack* Army = FindArmy(ArmyID);
+	if (!Army || UnitType == EUnitType::None || Count <= 0 || IsArmyExpanded(ArmyID))
+	{
+		return false;
+	}
+
+	// Clamp before matching so over-cap experience merges into the regiment it would have created
+	const uint8 ClampedExperience = FMath::Min(Experience, FRegimentStack::MaxExperience);
+	for (FRegimentStack& Regiment : Army->Regiments)
+	{
+		if (Regiment.UnitType == UnitType && Regiment.Experience == ClampedExperience)
+		{
+			Regiment.Count += Count;
+			return true;
+		}
+	}
+
+	Army->Regiments.Emplace(UnitType, Count, ClampedExperience);
+	return true;
+}
+
+bool AArmyManager::GetArmy(int32 ArmyID, FArmyStack& OutArmy) const
+{
+	if (const FArmyStack* Army = FindArmy(ArmyID))
+	{
+		OutArmy = *Army;
+		return true;
+	}
+	return false;
+}
+
+TArray<int32> AArmyManager::GetArmiesInTerritory(ATerritoryRegion* Territory) const
+{
+	TArray<int32> Result;
+	if (Territory)
+	{
+		ArmiesByTerritory.MultiFind(Territory->GetMapIndex(), Result);
+	}
+	return Result;
+}
+
+int32 AArmyManager::GetFactionSoldierCount(EFactionID FactionID) const
+{
+	int32 Total = 0;
+	for (const FArmyStack& Army : Armies)
+	{
+		if (Army.OwnerFaction == FactionID)
+		{
+			Total += Army.GetSoldierCount();
+		}
+	}
+	return Total;
+}
+
+bool AArmyManager::OrderArmyMove(int32 ArmyID, ATerritoryRegion* Destination)
+{
+	FArmyStack* Army = FindArmy(ArmyID);
+	if (!Army || !Destination || IsArmyExpanded(ArmyID))
+	{
+		return false;
+	}
+
+	TArray<int32> Path;
+	if (!FindPath(Army->LocationIndex, Destination->GetMapIndex(), Path))
+	{
+		UE_LOG(LogRomanEmpire, Warning, TEXT("Army %d has no route to %s"), ArmyID, *Destination->GetTerritoryID().ToString());
+		return false;
+	}
+
+	Army->MovePath = MoveTemp(Path);
+	return true;
+}
+
+void AArmyManager::ProcessArmyMovement()
+{
+	if (!WorldMapManager)
+	{
+		return;
+	}
+
+	// Events are broadcast after the loop, so handlers may create or disband armies
+	struct FMoveEvent
+	{
+		int32 ArmyID;
+		int32 DefenderID;
+		ATerritoryRegion* Territory;
+	};
+	TArray<FMoveEvent> Events;
+
+	for (FArmyStack& Army : Armies)
+	{
+		if (Army.MovePath.Num() == 0 || IsArmyExpanded(Army.ArmyID))
+		{
+			continue;
+		}
+
+		for (int32 Step = 0; Step < MovesPerTurn && Army.MovePath.Num() > 0; ++Step)
+		{
+			const int32 NextLocation = Army.MovePath.Pop(EAllowShrinking::No);
+			SetArmyLocation(Army, NextLocation);
+
+			ATerritoryRegion* Territory = WorldMapManager->GetTerritoryByIndex(NextLocation);
+
+			// Marching into an enemy army ends the move; the battle decides what happens next
+			const int32 DefenderID = FindHostileArmyAt(Army, NextLocation);
+			Events.Add({ Army.ArmyID, DefenderID, Territory });
+			if (DefenderID != INDEX_NONE)
+			{
+				Army.MovePath.Reset();
+
+				UE_LOG(LogRomanEmpire, Log, TEXT("Army %d engages army %d in %s"),
+					Army.ArmyID, DefenderID, Territory ? *Territory->GetTerritoryID().ToString() : TEXT("?"));
+			}
+		}
+	}
+
+	for (const FMoveEvent& Event : Events)
+	{
+		OnArmyMoved.Broadcast(Event.ArmyID, Event.Territory);
+		if (Event.DefenderID != INDEX_NONE)
+		{
+			OnArmiesEngaged.Broadcast(Event.ArmyID, Event.DefenderID, Event.Territory);
+		}
+	}
+}
+
+TArray<AUnitBase*> AArmyManager::ExpandArmy(int32 ArmyID, const FVector& Origin, const FRotator& Facing)
+{
+	TArray<AUnitBase*> Spawned;
+
+	const FArmyStack* Army = FindArmy(ArmyID);
+	UWorld* World = GetWorld();
+	if (!Army || !World || IsArmyExpanded(ArmyID))
+	{
+		return Spawned;
+	}
+
+	FExpandedArmy& Expanded = ExpandedArmies.Add(ArmyID);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	const FQuat Rotation = Facing.Quaternion();
+	const int32 Width = FMath::Max(1, FormationWidth);
+	int32 Rank = 0;
+
+	// Regiments form up one block behind the other
+	for (int32 RegimentIndex = 0; RegimentIndex < Army->Regiments.Num(); ++RegimentIndex)
+	{
+		const FRegimentStack& Regiment = Army->Regiments[RegimentIndex];
+		const TSubclassOf<AUnitBase>* UnitClass = UnitClasses.Find(Regiment.UnitType);
+		if (!UnitClass || !*UnitClass)
+		{
+			UE_LOG(LogRomanEmpire, Warning, TEXT("No unit class for type %d, regiment stays off the field"),
+				static_cast<int32>(Regiment.UnitType));
+			continue;
+		}
+
+		for (int32 Soldier = 0; Soldier < Regiment.Count; ++Soldier)
+		{
+			const int32 File = Soldier % Width;
+			const int32 SoldierRank = Rank + Soldier / Width;
+			const FVector Offset(-SoldierRank * FormationSpacing, (File - (Width - 1) * 0.5f) * FormationSpacing, 0.0f);
+			const FTransform SpawnTransform(Rotation, Origin + Rotation.RotateVector(Offset));
+
+			AUnitBase* Unit = World->SpawnActor<AUnitBase>(*UnitClass, SpawnTransform, SpawnParams);
+			if (Unit)
+			{
+				Unit->SetOwnerFaction(Army->OwnerFaction);
+				Expanded.Units.Add(Unit);
+				Expanded.RegimentIndices.Add(RegimentIndex);
+				Spawned.Add(Unit);
+			}
+		}
+
+		Rank += FMath::DivideAndRoundUp(Regiment.Count, Width) + 1;
+	}
+
+	UE_LOG(LogRomanEmpire, Log, TEXT("Army %d expanded into %d units"), ArmyID, Spawned.Num());
+
+	return Spawned;
+}
+
+void AArmyManager::CollapseArmy(int32 ArmyID)
+{
+	FArmyStack* Army = FindArmy(ArmyID);
+	FExpandedArmy Expanded;
+	if (!Army || !ExpandedArmies.RemoveAndCopyValue(ArmyID, Expanded))
+	{
+		return;
+	}
+
+	TArray<int32> Fielded;
+	TArray<int32> Survivors;
+	Fielded.SetNumZeroed(Army->Regiments.Num());
+	Survivors.SetNumZeroed(Army->Regiments.Num());
+
+	for (int32 Index = 0; Index < Expanded.Units.Num(); ++Index)
+	{
+		const int32 RegimentIndex = Expanded.RegimentIndices[Index];
+		++Fielded[RegimentIndex];
+
+		AUnitBase* Unit = Expanded.Units[Index].Get();
+		if (Unit)
+		{
+			if (Unit->IsAlive())
+			{
+				++Survivors[RegimentIndex];
+			}
+			Unit->Destroy();
+		}
+	}
+
+	// Regiments that never took the field keep their full strength
+	for (int32 RegimentIndex = Army->Regiments.Num() - 1; RegimentIndex >= 0; --RegimentIndex)
+	{
+		FRegimentStack& Regiment = Army->Regiments[RegimentIndex];
+		Regiment.Count -= Fielded[RegimentIndex] - Survivors[RegimentIndex];
+
+		if (Survivors[RegimentIndex] > 0 && Regiment.Experience < FRegimentStack::MaxExperience)
+		{
+			++Regiment.Experience;
+		}
+
+		if (Regiment.Count <= 0)
+		{
+			Army->Regiments.RemoveAt(RegimentIndex);
+		}
+	}
+
+	if (Army->Regiments.Num() == 0)
+	{
+		UE_LOG(LogRomanEmpire, Log, TEXT("Army %d was destroyed"), ArmyID);
+		DisbandArmy(ArmyID);
+	}
+}
+
+FArmyStack* AArmyManager::FindArmy(int32 ArmyID)
+{
+	const int32* Slot = ArmySlots.Find(ArmyID);
+	return Slot ? &Armies[*Slot] : nullptr;
+}
+
+const FArmyStack* AArmyManager::FindArmy(int32 ArmyID) const
+{
+	const int32* Slot = ArmySlots.Find(ArmyID);
+	return Slot ? &Armies[*Slot] : nullptr;
+}
+
+void AArmyManager::SetArmyLocation(FArmyStack& Army, int32 NewLocation)
+{
+	if (Army.LocationIndex != INDEX_NONE)
+	{
+		ArmiesByTerritory.RemoveSingle(Army.LocationIndex, Army.ArmyID);
+	}
+
+	Army.LocationIndex = NewLocation;
+	ArmiesByTerritory.Add(NewLocation, Army.ArmyID);
+}
+
+int32 AArmyManager::FindHostileArmyAt(const FArmyStack& Army, int32 TerritoryIndex) const
+{
+	TArray<int32> Present;
+	ArmiesByTerritory.MultiFind(TerritoryIndex, Present);
+
+	for (int32 OtherID : Present)
+	{
+		const FArmyStack* Other = FindArmy(OtherID);
+		if (!Other || Other->OwnerFaction == Army.OwnerFaction)
+		{
+			continue;
+		}
+
+		if (!FactionManager || FactionManager->AreAtWar(Army.OwnerFaction, Other->OwnerFaction))
+		{
+			return OtherID;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+bool AArmyManager::FindPath(int32 From, int32 To, TArray<int32>& OutPath) const
+{
+	OutPath.Reset();
+
+	if (!WorldMapManager || From == INDEX_NONE || To == INDEX_NONE || From == To)
+	{
+		return false;
+	}
+
+	TMap<int32, int32> Parents;
+	TArray<int32> Frontier;
+	Parents.Add(From, INDEX_NONE);
+	Frontier.Add(From);
+
+	int32 LayerEnd = Frontier.Num();
+	int32 Depth = 0;
+
+	for (int32 Cursor = 0; Cursor < Frontier.Num(); ++Cursor)
+	{
+		if (Cursor == LayerEnd)
+		{
+			LayerEnd = Frontier.Num();
+			if (++Depth >= MaxPathLength)
+			{
+				return false;
+			}
+		}
+
+		const int32 Current = Frontier[Cursor];
+		for (int32 Neighbour : WorldMapManager->GetAdjacentIndices(Current))
+		{
+			if (Parents.Contains(Neighbour))
+			{
+				continue;
+			}
+
+			Parents.Add(Neighbour, Current);
+
+			if (Neighbour == To)
+			{
+				// Walking back from the goal leaves the path reversed, which is how MovePath is consumed
+				for (int32 Step = To; Step != From; Step = Parents[Step])
+				{
+					OutPath.Add(Step);
+				}
+				return true;
+			}
+
+			Frontier.Add(Neighbour);
+		}
+	}
+
+	return false;
+}
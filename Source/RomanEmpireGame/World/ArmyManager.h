@@ -0,0 +1,129 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/World/ArmyTypes.h"
+#include "ArmyManager.generated.h"
+
+class ATerritoryRegion;
+class AWorldMapManager;
+class AFactionManager;
+class AUnitBase;
+
+/**
+ * Owns every army on the campaign map as compact regiment stacks.
+ * Armies march along the territory graph each turn and only become AUnitBase actors for tactical battles.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API AArmyManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AArmyManager();
+
+	virtual void BeginPlay() override;
+
+	// Army lifecycle
+	UFUNCTION(BlueprintCallable, Category = "Army")
+	int32 CreateArmy(EFactionID OwnerFaction, ATerritoryRegion* Location, const TArray<FRegimentStack>& Regiments);
+
+	UFUNCTION(BlueprintCallable, Category = "Army")
+	void DisbandArmy(int32 ArmyID);
+
+	// Merges soldiers into a regiment of the same type and experience, or starts a new one
+	UFUNCTION(BlueprintCallable, Category = "Army")
+	bool AddSoldiers(int32 ArmyID, EUnitType UnitType, int32 Count, uint8 Experience = 0);
+
+	// Queries
+	UFUNCTION(BlueprintPure, Category = "Army")
+	bool GetArmy(int32 ArmyID, FArmyStack& OutArmy) const;
+
+	UFUNCTION(BlueprintPure, Category = "Army")
+	TArray<int32> GetArmiesInTerritory(ATerritoryRegion* Territory) const;
+
+	UFUNCTION(BlueprintPure, Category = "Army")
+	int32 GetFactionSoldierCount(EFactionID FactionID) const;
+
+	UFUNCTION(BlueprintPure, Category = "Army")
+	int32 GetArmyCount() const { return Armies.Num(); }
+
+	// Movement
+	UFUNCTION(BlueprintCallable, Category = "Army|Movement")
+	bool OrderArmyMove(int32 ArmyID, ATerritoryRegion* Destination);
+
+	// Advances every marching army; called once per campaign turn
+	UFUNCTION(BlueprintCallable, Category = "Army|Movement")
+	void ProcessArmyMovement();
+
+	// Tactical battles
+	UFUNCTION(BlueprintCallable, Category = "Army|Battle")
+	TArray<AUnitBase*> ExpandArmy(int32 ArmyID, const FVector& Origin, const FRotator& Facing);
+
+	// Folds surviving actors back into their regiments, grants experience and destroys the actors
+	UFUNCTION(BlueprintCallable, Category = "Army|Battle")
+	void CollapseArmy(int32 ArmyID);
+
+	UFUNCTION(BlueprintPure, Category = "Army|Battle")
+	bool IsArmyExpanded(int32 ArmyID) const { return ExpandedArmies.Contains(ArmyID); }
+
+protected:
+	// Actor class spawned for each unit type when an army is expanded
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Army|Battle")
+	TMap<EUnitType, TSubclassOf<AUnitBase>> UnitClasses;
+
+	// Territories an army can march through in one turn
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Army|Movement")
+	int32 MovesPerTurn;
+
+	// Longest path OrderArmyMove will search for, in territories
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Army|Movement")
+	int32 MaxPathLength;
+
+	// Spacing between soldiers when an army is laid out for battle
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Army|Battle")
+	float FormationSpacing;
+
+	// Soldiers per rank when an army is laid out for battle
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Army|Battle")
+	int32 FormationWidth;
+
+	UPROPERTY()
+	AWorldMapManager* WorldMapManager;
+
+	UPROPERTY()
+	AFactionManager* FactionManager;
+
+	// Events
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnArmiesEngaged, int32, AttackerArmyID, int32, DefenderArmyID, ATerritoryRegion*, Territory);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnArmyMoved, int32, ArmyID, ATerritoryRegion*, Territory);
+
+	UPROPERTY(BlueprintAssignable, Category = "Army|Events")
+	FOnArmiesEngaged OnArmiesEngaged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Army|Events")
+	FOnArmyMoved OnArmyMoved;
+
+private:
+	// Armies packed densely; ArmySlots maps an ID to its index
+	TArray<FArmyStack> Armies;
+	TMap<int32, int32> ArmySlots;
+	TMultiMap<int32, int32> ArmiesByTerritory;
+	int32 NextArmyID;
+
+	// Spawned actors of an army in battle, with the regiment each one came from
+	struct FExpandedArmy
+	{
+		TArray<TWeakObjectPtr<AUnitBase>> Units;
+		TArray<int32> RegimentIndices;
+	};
+	TMap<int32, FExpandedArmy> ExpandedArmies;
+
+	FArmyStack* FindArmy(int32 ArmyID);
+	const FArmyStack* FindArmy(int32 ArmyID) const;
+	void SetArmyLocation(FArmyStack& Army, int32 NewLocation);
+	int32 FindHostileArmyAt(const FArmyStack& Army, int32 TerritoryIndex) const;
+	bool FindPath(int32 From, int32 To, TArray<int32>& OutPath) const;
+};
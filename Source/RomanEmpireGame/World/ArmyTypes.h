@@ -0,0 +1,83 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RomanEmpireGame/Units/UnitTypes.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "ArmyTypes.generated.h"
+
+/**
+ * One block of identical soldiers inside an army; a soldier costs nothing beyond its share of Count
+ */
+USTRUCT(BlueprintType)
+struct FRegimentStack
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Army")
+	EUnitType UnitType;
+
+	// Veterancy rank, 0 (recruit) to MaxExperience
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Army")
+	uint8 Experience;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Army")
+	int32 Count;
+
+	static constexpr uint8 MaxExperience = 9;
+
+	FRegimentStack()
+		: UnitType(EUnitType::None)
+		, Experience(0)
+		, Count(0)
+	{}
+
+	FRegimentStack(EUnitType InUnitType, int32 InCount, uint8 InExperience = 0)
+		: UnitType(InUnitType)
+		, Experience(InExperience)
+		, Count(InCount)
+	{}
+};
+
+/**
+ * An army on the campaign map: who owns it, where it stands, what it is made of and where it marches
+ */
+USTRUCT(BlueprintType)
+struct FArmyStack
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Army")
+	int32 ArmyID;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Army")
+	EFactionID OwnerFaction;
+
+	// World map territory index the army stands in
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Army")
+	int32 LocationIndex;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Army")
+	TArray<FRegimentStack> Regiments;
+
+	// Remaining territory indices to march through, stored in reverse so the next step is last
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Army")
+	TArray<int32> MovePath;
+
+	FArmyStack()
+		: ArmyID(INDEX_NONE)
+		, OwnerFaction(EFactionID::None)
+		, LocationIndex(INDEX_NONE)
+	{}
+
+	int32 GetSoldierCount() const
+	{
+		int32 Total = 0;
+		for (const FRegimentStack& Regiment : Regiments)
+		{
+			Total += Regiment.Count;
+		}
+		return Total;
+	}
+};
@@ -5,6 +5,9 @@
 #include "RomanEmpireGame/Faction/FactionManager.h"
 #include "RomanEmpireGame/World/WorldMapManager.h"
 #include "RomanEmpireGame/World/TerritoryRegion.h"
+#include "RomanEmpireGame/World/TradeNetworkManager.h"
+#include "RomanEmpireGame/World/ArmyManager.h"
+#include "RomanEmpireGame/Core/RomanEmpireHUD.h"
 #include "Kismet/GameplayStatics.h"
 
 ACampaignManager::ACampaignManager()
@@ -19,6 +22,8 @@ ACampaignManager::ACampaignManager()
 
 	FactionManager = nullptr;
 	WorldMapManager = nullptr;
+	TradeNetworkManager = nullptr;
+	ArmyManager = nullptr;
 }
 
 void ACampaignManager::BeginPlay()
@@ -41,6 +46,20 @@ void ACampaignManager::BeginPlay()
 		WorldMapManager = Cast<AWorldMapManager>(FoundActors[0]);
 	}
 
+	FoundActors.Empty();
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ATradeNetworkManager::StaticClass(), FoundActors);
+	if (FoundActors.Num() > 0)
+	{
+		TradeNetworkManager = Cast<ATradeNetworkManager>(FoundActors[0]);
+	}
+
+	FoundActors.Empty();
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AArmyManager::StaticClass(), FoundActors);
+	if (FoundActors.Num() > 0)
+	{
+		ArmyManager = Cast<AArmyManager>(FoundActors[0]);
+	}
+
 	// Start campaign automatically for prototype
 	if (FactionManager)
 	{
@@ -71,16 +90,34 @@ void ACampaignManager::ProcessTurn()
 
 	UE_LOG(LogRomanEmpire, Log, TEXT("Processing turn %d"), CurrentTurn);
 
-	// 1. Process resource production for all territories
+	// 1. Rebuild trade routes around territories that changed since last turn
+	if (TradeNetworkManager)
+	{
+		TradeNetworkManager->ProcessTradeNetwork();
+	}
+
+	// 2. Process resource production for all territories
 	ProcessResourceProduction();
 
-	// 2. Process AI faction actions
+	// 3. Grow settlements
+	if (WorldMapManager)
+	{
+		WorldMapManager->ProcessSettlementGrowth();
+	}
+
+	// 4. Process AI faction actions
 	ProcessAIFactions();
 
-	// 3. Check victory/defeat conditions
+	// 5. March armies and raise engagements
+	if (ArmyManager)
+	{
+		ArmyManager->ProcessArmyMovement();
+	}
+
+	// 6. Check victory/defeat conditions
 	CheckAllVictoryConditions();
 
-	// 4. Advance turn
+	// 7. Advance turn
 	CurrentTurn++;
 	OnTurnProcessed.Broadcast(CurrentTurn);
 
@@ -94,27 +131,25 @@ void ACampaignManager::ProcessTurn()
 
 void ACampaignManager::ProcessResourceProduction()
 {
-	if (!WorldMapManager || !FactionManager)
+	if (!FactionManager)
 	{
 		return;
 	}
 
-	// For each territory, add resources to owning faction
-	for (ATerritoryRegion* Territory : WorldMapManager->GetAllTerritories())
-	{
-		if (!Territory)
-		{
-			continue;
-		}
+	// Territory contributions are cached in the faction manager's ledger and only
+	// refreshed when ownership, settlements or buildings change
+	FactionManager->ApplyTurnIncome();
 
-		EFactionID Owner = Territory->GetOwnerFaction();
-		if (Owner == EFactionID::None)
-		{
-			continue;
-		}
+	// Push the player's cached breakdown to the HUD
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	ARomanEmpireHUD* HUD = PlayerController ? PlayerController->GetHUD<ARomanEmpireHUD>() : nullptr;
+	if (HUD)
+	{
+		EFactionID PlayerFaction = FactionManager->GetPlayerFaction();
+		FFactionResources Resources = FactionManager->GetFactionResources(PlayerFaction);
 
-		FFactionResources Production = Territory->GetResourceProduction();
-		FactionManager->ModifyFactionResources(Owner, Production);
+		HUD->UpdateResources(Resources.Gold, Resources.Food, Resources.Iron, Resources.Wood, Resources.Stone, Resources.Population);
+		HUD->UpdateIncomeBreakdown(FactionManager->GetLastTurnIncome(PlayerFaction));
 	}
 }
 
@@ -9,6 +9,8 @@
 
 class AFactionManager;
 class AWorldMapManager;
+class ATradeNetworkManager;
+class AArmyManager;
 
 /**
  * Victory condition types
@@ -90,6 +92,12 @@ protected:
 	UPROPERTY()
 	AWorldMapManager* WorldMapManager;
 
+	UPROPERTY()
+	ATradeNetworkManager* TradeNetworkManager;
+
+	UPROPERTY()
+	AArmyManager* ArmyManager;
+
 	// Events
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTurnProcessed, int32, TurnNumber);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnVictory, EFactionID, WinningFaction, EVictoryCondition, Condition);
@@ -0,0 +1,151 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "SettlementGrowth.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("Settlement Growth"), STAT_SettlementGrowth, STATGROUP_RomanEmpire);
+
+int32 FSettlementTable::AddSettlement(ATerritoryRegion* Territory)
+{
+	const int32 Row = NumSettlements++;
+
+	// Grow the vector columns by a whole block of four padding rows
+	if (Row >= Population.Num())
+	{
+		const int32 NewSize = Population.Num() + 4;
+		Territories.SetNum(NewSize);
+		ReportedPopulation.SetNumZeroed(NewSize);
+		Population.SetNumZeroed(NewSize);
+		FoodProduction.SetNumZeroed(NewSize);
+		GrowthModifier.SetNumZeroed(NewSize);
+
+		// Padding rows need a non-zero capacity to keep the division safe
+		const int32 OldSize = Capacity.Num();
+		Capacity.SetNum(NewSize);
+		for (int32 Index = OldSize; Index < NewSize; ++Index)
+		{
+			Capacity[Index] = 1.0f;
+		}
+	}
+
+	Territories[Row] = Territory;
+	Population[Row] = Territory ? static_cast<float>(Territory->GetPopulation()) : 0.0f;
+	ReportedPopulation[Row] = FMath::RoundToInt(Population[Row]);
+
+	return Row;
+}
+
+void FSettlementTable::UpdateModifiers(int32 Row, const FSettlementGrowthSettings& Settings)
+{
+	if (Row < 0 || Row >= NumSettlements)
+	{
+		return;
+	}
+
+	const ATerritoryRegion* Territory = Territories[Row].Get();
+	if (!Territory)
+	{
+		return;
+	}
+
+	int32 AqueductCount = 0;
+	for (const ABuildingBase* Building : Territory->GetBuildings())
+	{
+		if (!Building || !Building->IsComplete())
+		{
+			continue;
+		}
+
+		if (Building->GetBuildingType() == EBuildingType::Aqueduct)
+		{
+			AqueductCount++;
+		}
+	}
+
+	const ETerrainType Terrain = Territory->GetTerrainType();
+
+	// Turn production already includes every completed farm's output
+	FoodProduction[Row] = Territory->CalculateTurnProduction().Food;
+	Capacity[Row] = FMath::Max(1.0f, (Settings.BaseCapacity + AqueductCount * Settings.CapacityPerAqueduct) * GetTerrainCapacityModifier(Terrain));
+	GrowthModifier[Row] = GetTerrainGrowthModifier(Terrain);
+}
+
+void FSettlementTable::Simulate(const FSettlementGrowthSettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SettlementGrowth);
+
+	const VectorRegister4Float Zero = VectorSetFloat1(0.0f);
+	const VectorRegister4Float One = VectorSetFloat1(1.0f);
+	const VectorRegister4Float MinusOne = VectorSetFloat1(-1.0f);
+	const VectorRegister4Float FoodPerCitizen = VectorSetFloat1(Settings.FoodPerCitizen);
+	const VectorRegister4Float GrowthRate = VectorSetFloat1(Settings.BaseGrowthRate);
+	const VectorRegister4Float StarvationRate = VectorSetFloat1(Settings.StarvationRate);
+	const VectorRegister4Float MinPopulation = VectorSetFloat1(Settings.MinPopulation);
+
+	float* PopulationData = Population.GetData();
+	const float* FoodData = FoodProduction.GetData();
+	const float* CapacityData = Capacity.GetData();
+	const float* ModifierData = GrowthModifier.GetData();
+
+	for (int32 Base = 0; Base < NumSettlements; Base += 4)
+	{
+		const VectorRegister4Float Pop = VectorLoad(PopulationData + Base);
+		const VectorRegister4Float Food = VectorLoad(FoodData + Base);
+		const VectorRegister4Float Cap = VectorLoad(CapacityData + Base);
+		const VectorRegister4Float Modifier = VectorLoad(ModifierData + Base);
+
+		// Food balance relative to demand, clamped to [-1, 1]
+		const VectorRegister4Float Demand = VectorMultiply(Pop, FoodPerCitizen);
+		const VectorRegister4Float Surplus = VectorSubtract(Food, Demand);
+		const VectorRegister4Float FoodRatio = VectorMin(VectorMax(VectorDivide(Surplus, VectorMax(Demand, One)), MinusOne), One);
+
+		// Fed settlements grow logistically towards capacity, starving ones shrink
+		const VectorRegister4Float Headroom = VectorMax(VectorSubtract(One, VectorDivide(Pop, Cap)), Zero);
+		const VectorRegister4Float Growth = VectorMultiply(VectorMultiply(GrowthRate, Modifier), VectorMultiply(Pop, VectorMultiply(Headroom, VectorMax(FoodRatio, Zero))));
+		const VectorRegister4Float Loss = VectorMultiply(StarvationRate, VectorMultiply(Pop, VectorMin(FoodRatio, Zero)));
+
+		const VectorRegister4Float NewPop = VectorAdd(Pop, VectorAdd(Growth, Loss));
+		VectorStore(VectorMin(VectorMax(NewPop, MinPopulation), Cap), PopulationData + Base);
+	}
+
+	// Only touch territories whose visible population actually changed
+	for (int32 Row = 0; Row < NumSettlements; ++Row)
+	{
+		const int32 NewPopulation = FMath::RoundToInt(Population[Row]);
+		if (NewPopulation != ReportedPopulation[Row])
+		{
+			ReportedPopulation[Row] = NewPopulation;
+			if (ATerritoryRegion* Territory = Territories[Row].Get())
+			{
+				Territory->SetPopulation(NewPopulation);
+			}
+		}
+	}
+}
+
+float FSettlementTable::GetTerrainGrowthModifier(ETerrainType Terrain)
+{
+	switch (Terrain)
+	{
+		case ETerrainType::Plains:		return 1.0f;
+		case ETerrainType::Coast:		return 1.1f;
+		case ETerrainType::Forest:		return 0.8f;
+		case ETerrainType::Desert:		return 0.6f;
+		case ETerrainType::Mountain:	return 0.5f;
+		default:						return 1.0f;
+	}
+}
+
+float FSettlementTable::GetTerrainCapacityModifier(ETerrainType Terrain)
+{
+	switch (Terrain)
+	{
+		case ETerrainType::Plains:		return 1.0f;
+		case ETerrainType::Coast:		return 1.2f;
+		case ETerrainType::Forest:		return 0.8f;
+		case ETerrainType::Desert:		return 0.5f;
+		case ETerrainType::Mountain:	return 0.6f;
+		default:						return 1.0f;
+	}
+}
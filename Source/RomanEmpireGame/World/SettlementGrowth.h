@@ -0,0 +1,82 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RomanEmpireGame/World/TerritoryRegion.h"
+#include "SettlementGrowth.generated.h"
+
+/**
+ * Tuning values for the settlement population model
+ */
+USTRUCT(BlueprintType)
+struct FSettlementGrowthSettings
+{
+	GENERATED_BODY()
+
+	// Fraction of population gained per turn when well fed and far below capacity
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settlement|Growth")
+	float BaseGrowthRate;
+
+	// Fraction of population lost per turn under full starvation
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settlement|Growth")
+	float StarvationRate;
+
+	// Food eaten by each citizen per turn
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settlement|Food")
+	float FoodPerCitizen;
+
+	// Population a settlement supports without aqueducts
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settlement|Capacity")
+	float BaseCapacity;
+
+	// Extra capacity per completed aqueduct
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settlement|Capacity")
+	float CapacityPerAqueduct;
+
+	// Settlements never shrink below this
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settlement|Capacity")
+	float MinPopulation;
+
+	FSettlementGrowthSettings()
+		: BaseGrowthRate(0.05f)
+		, StarvationRate(0.1f)
+		, FoodPerCitizen(0.5f)
+		, BaseCapacity(1000.0f)
+		, CapacityPerAqueduct(1500.0f)
+		, MinPopulation(10.0f)
+	{}
+};
+
+/**
+ * Structure-of-arrays table of every settlement on the map
+ * Rows are padded to a multiple of four so the growth pass runs four settlements per vector operation
+ */
+struct FSettlementTable
+{
+	// Adds a row for a newly founded settlement and returns its index
+	int32 AddSettlement(ATerritoryRegion* Territory);
+
+	// Re-reads food, buildings and terrain for one row; called only when the territory changes
+	void UpdateModifiers(int32 Row, const FSettlementGrowthSettings& Settings);
+
+	// Advances every settlement by one turn and writes changed populations back to territories
+	void Simulate(const FSettlementGrowthSettings& Settings);
+
+	int32 Num() const { return NumSettlements; }
+
+private:
+	int32 NumSettlements = 0;
+
+	TArray<TWeakObjectPtr<ATerritoryRegion>> Territories;
+	TArray<int32> ReportedPopulation;
+
+	// Vectorized columns
+	TArray<float> Population;
+	TArray<float> FoodProduction;
+	TArray<float> Capacity;
+	TArray<float> GrowthModifier;
+
+	static float GetTerrainGrowthModifier(ETerrainType Terrain);
+	static float GetTerrainCapacityModifier(ETerrainType Terrain);
+};
@@ -2,6 +2,10 @@
 
 #include "TerritoryRegion.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Core/RomanEmpireGameMode.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "RomanEmpireGame/World/WorldMapManager.h"
+#include "RomanEmpireGame/World/TradeNetworkManager.h"
 #include "RomanEmpireGame/Building/BuildingBase.h"
 #include "RomanEmpireGame/Units/UnitBase.h"
 #include "Components/BoxComponent.h"
@@ -30,6 +34,9 @@ ATerritoryRegion::ATerritoryRegion()
 	bHasSettlement = false;
 	Population = 0;
 	MaxSettlementSlots = 10;
+	OccupancyCellSize = 100.0f;
+	MapIndex = INDEX_NONE;
+	SettlementRow = INDEX_NONE;
 	BonusResource = EResourceType::Gold;
 
 	// Default resource production
@@ -42,6 +49,17 @@ void ATerritoryRegion::BeginPlay()
 	Super::BeginPlay();
 	
 	UpdateTerritoryColor();
+
+	// Cover the territory bounds; the bits themselves are allocated by the first building
+	const FVector Extent = TerritoryBounds->GetScaledBoxExtent();
+	const FVector Location = GetActorLocation();
+	OccupancyGrid.Initialize(FVector2D(Location.X - Extent.X, Location.Y - Extent.Y), FVector2D(Extent.X, Extent.Y) * 2.0f, OccupancyCellSize);
+}
+
+void ATerritoryRegion::InitializeTerritory(FName NewTerritoryID, const FText& NewDisplayName)
+{
+	TerritoryID = NewTerritoryID;
+	DisplayName = NewDisplayName;
 }
 
 void ATerritoryRegion::SetOwnerFaction(EFactionID NewOwner)
@@ -50,6 +68,7 @@ void ATerritoryRegion::SetOwnerFaction(EFactionID NewOwner)
 	{
 		OwnerFaction = NewOwner;
 		UpdateTerritoryColor();
+		NotifyProductionChanged();
 		OnTerritoryOwnerChanged.Broadcast(this, NewOwner);
 		
 		UE_LOG(LogRomanEmpire, Log, TEXT("Territory %s now owned by faction %d"), 
@@ -89,6 +108,7 @@ void ATerritoryRegion::FoundSettlement(const FText& Name)
 	// Boost resource production with settlement
 	ResourceProduction.Gold += 100;
 	ResourceProduction.Food += 50;
+	NotifyProductionChanged();
 
 	OnSettlementFounded.Broadcast(this);
 	
@@ -96,6 +116,22 @@ void ATerritoryRegion::FoundSettlement(const FText& Name)
 		*Name.ToString(), *TerritoryID.ToString());
 }
 
+void ATerritoryRegion::SetPopulation(int32 NewPopulation)
+{
+	if (Population == NewPopulation)
+	{
+		return;
+	}
+
+	Population = NewPopulation;
+
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	if (GameMode && GameMode->GetTradeNetworkManager())
+	{
+		GameMode->GetTradeNetworkManager()->MarkTerritoryRevalued(this);
+	}
+}
+
 void ATerritoryRegion::RegisterBuilding(ABuildingBase* Building)
 {
 	if (Building && !Buildings.Contains(Building))
@@ -103,6 +139,8 @@ void ATerritoryRegion::RegisterBuilding(ABuildingBase* Building)
 		if (Buildings.Num() < MaxSettlementSlots)
 		{
 			Buildings.Add(Building);
+			Building->SetOwningTerritory(this);
+			NotifyProductionChanged();
 		}
 		else
 		{
@@ -112,6 +150,107 @@ void ATerritoryRegion::RegisterBuilding(ABuildingBase* Building)
 	}
 }
 
+void ATerritoryRegion::UnregisterBuilding(ABuildingBase* Building)
+{
+	if (Buildings.Remove(Building) > 0)
+	{
+		NotifyProductionChanged();
+	}
+}
+
+bool ATerritoryRegion::CanPlaceFootprint(const FVector& Location, const FVector2D& FootprintSize, float Yaw, TArray<FIntPoint>* OutBlockedCells) const
+{
+	const FIntRect Cells = OccupancyGrid.GetFootprintCells(Location, FootprintSize, Yaw);
+	if (OccupancyGrid.IsAreaFree(Cells))
+	{
+		if (OutBlockedCells)
+		{
+			OutBlockedCells->Reset();
+		}
+		return true;
+	}
+
+	if (OutBlockedCells)
+	{
+		OccupancyGrid.GetBlockedCells(Cells, *OutBlockedCells);
+	}
+	return false;
+}
+
+void ATerritoryRegion::OccupyFootprint(const ABuildingBase* Building)
+{
+	if (Building)
+	{
+		const FIntRect Cells = OccupancyGrid.GetFootprintCells(Building->GetActorLocation(),
+			Building->GetBuildingDataRef().FootprintSize, Building->GetActorRotation().Yaw);
+		OccupancyGrid.SetArea(Cells, true);
+	}
+}
+
+void ATerritoryRegion::ReleaseFootprint(const ABuildingBase* Building)
+{
+	if (Building)
+	{
+		const FIntRect Cells = OccupancyGrid.GetFootprintCells(Building->GetActorLocation(),
+			Building->GetBuildingDataRef().FootprintSize, Building->GetActorRotation().Yaw);
+		OccupancyGrid.SetArea(Cells, false);
+	}
+}
+
+bool ATerritoryRegion::ContainsLocation(const FVector& Location) const
+{
+	const FVector Extent = TerritoryBounds->GetScaledBoxExtent();
+	const FVector Local = Location - GetActorLocation();
+	return FMath::Abs(Local.X) <= Extent.X && FMath::Abs(Local.Y) <= Extent.Y;
+}
+
+FFactionResources ATerritoryRegion::CalculateTurnProduction() const
+{
+	FFactionResources Production = ResourceProduction;
+
+	for (const ABuildingBase* Building : Buildings)
+	{
+		if (!Building)
+		{
+			continue;
+		}
+
+		// Damaged buildings keep producing; only completion and destruction change the ledger
+		EBuildingState State = Building->GetBuildingState();
+		if (State == EBuildingState::Complete || State == EBuildingState::Damaged)
+		{
+			const FBuildingData& Data = Building->GetBuildingDataRef();
+			Production.AddResource(Data.ProducedResource, Data.ProductionRate);
+		}
+	}
+
+	return Production;
+}
+
+void ATerritoryRegion::NotifyProductionChanged()
+{
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	if (!GameMode)
+	{
+		return;
+	}
+
+	if (GameMode->GetFactionManager())
+	{
+		GameMode->GetFactionManager()->RefreshTerritoryContribution(this);
+	}
+
+	if (bHasSettlement && GameMode->GetWorldMapManager())
+	{
+		GameMode->GetWorldMapManager()->RefreshSettlement(this);
+	}
+
+	if (GameMode->GetTradeNetworkManager())
+	{
+		GameMode->GetTradeNetworkManager()->MarkTerritoryDirty(this);
+	}
+}
+
 TArray<AUnitBase*> ATerritoryRegion::GetUnitsInTerritory() const
 {
 	TArray<AUnitBase*> Units;
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "RomanEmpireGame/Faction/FactionData.h"
+#include "RomanEmpireGame/Building/OccupancyGrid.h"
 #include "TerritoryRegion.generated.h"
 
 class ABuildingBase;
@@ -39,6 +40,9 @@ public:
 	virtual void BeginPlay() override;
 
 	// Info
+	UFUNCTION(BlueprintCallable, Category = "Territory")
+	void InitializeTerritory(FName NewTerritoryID, const FText& NewDisplayName);
+
 	UFUNCTION(BlueprintPure, Category = "Territory")
 	FName GetTerritoryID() const { return TerritoryID; }
 
@@ -62,6 +66,14 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Territory|Resources")
 	FFactionResources GetResourceProduction() const { return ResourceProduction; }
 
+	// Base production plus the output of completed buildings
+	UFUNCTION(BlueprintPure, Category = "Territory|Resources")
+	FFactionResources CalculateTurnProduction() const;
+
+	// Pushes this territory's changes to the production ledger, settlement table and trade network
+	UFUNCTION(BlueprintCallable, Category = "Territory|Resources")
+	void NotifyProductionChanged();
+
 	// Settlement
 	UFUNCTION(BlueprintPure, Category = "Territory|Settlement")
 	bool HasSettlement() const { return bHasSettlement; }
@@ -75,6 +87,17 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Territory|Settlement")
 	int32 GetPopulation() const { return Population; }
 
+	// Written by the settlement growth simulation; trade routes are revalued since they depend on population
+	void SetPopulation(int32 NewPopulation);
+
+	// Index in the world map manager's adjacency tables, INDEX_NONE until the map is built
+	int32 GetMapIndex() const { return MapIndex; }
+	void SetMapIndex(int32 Index) { MapIndex = Index; }
+
+	// Row in the world map manager's settlement table, INDEX_NONE until registered
+	int32 GetSettlementRow() const { return SettlementRow; }
+	void SetSettlementRow(int32 Row) { SettlementRow = Row; }
+
 	// Buildings in this territory
 	UFUNCTION(BlueprintPure, Category = "Territory|Buildings")
 	TArray<ABuildingBase*> GetBuildings() const { return Buildings; }
@@ -82,6 +105,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Territory|Buildings")
 	void RegisterBuilding(ABuildingBase* Building);
 
+	// Frees the building's slot, e.g. once it has been destroyed
+	UFUNCTION(BlueprintCallable, Category = "Territory|Buildings")
+	void UnregisterBuilding(ABuildingBase* Building);
+
+	// Buildings that can still be registered before MaxSettlementSlots is reached
+	UFUNCTION(BlueprintPure, Category = "Territory|Buildings")
+	int32 GetFreeBuildingSlots() const { return FMath::Max(0, MaxSettlementSlots - Buildings.Num()); }
+
+	// Placement occupancy; footprints are in grid units, blocked cells come back in grid coordinates
+	bool CanPlaceFootprint(const FVector& Location, const FVector2D& FootprintSize, float Yaw, TArray<FIntPoint>* OutBlockedCells = nullptr) const;
+	void OccupyFootprint(const ABuildingBase* Building);
+	void ReleaseFootprint(const ABuildingBase* Building);
+	const FOccupancyGrid& GetOccupancyGrid() const { return OccupancyGrid; }
+
+	UFUNCTION(BlueprintPure, Category = "Territory|Buildings")
+	bool ContainsLocation(const FVector& Location) const;
+
 	// Units in this territory
 	UFUNCTION(BlueprintPure, Category = "Territory|Units")
 	TArray<AUnitBase*> GetUnitsInTerritory() const;
@@ -129,6 +169,15 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Territory|Settlement")
 	int32 MaxSettlementSlots; // How many buildings can be placed
 
+	// Resolution of the placement occupancy grid, matching the placement snap size
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Territory|Buildings")
+	float OccupancyCellSize;
+
+	FOccupancyGrid OccupancyGrid;
+
+	int32 MapIndex;
+	int32 SettlementRow;
+
 	// Buildings
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Territory|Buildings")
 	TArray<ABuildingBase*> Buildings;
@@ -0,0 +1,374 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#include "TradeNetworkManager.h"
+#include "RomanEmpireGame/RomanEmpireGame.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
+#include "RomanEmpireGame/World/WorldMapManager.h"
+#include "RomanEmpireGame/World/TerritoryRegion.h"
+#include "RomanEmpireGame/Building/BuildingBase.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trade Network"), STAT_TradeNetwork, STATGROUP_RomanEmpire);
+
+ATradeNetworkManager::ATradeNetworkManager()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	MaxRouteHops = 6;
+	GoldPerHundredCitizens = 4.0f;
+	HopPenalty = 0.15f;
+	PortBonus = 1.5f;
+	MaxHubSearchesPerTurn = 256;
+
+	WorldMapManager = nullptr;
+	FactionManager = nullptr;
+	CurrentStamp = 0;
+}
+
+void ATradeNetworkManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Find managers
+	TArray<AActor*> FoundActors;
+
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AFactionManager::StaticClass(), FoundActors);
+	if (FoundActors.Num() > 0)
+	{
+		FactionManager = Cast<AFactionManager>(FoundActors[0]);
+	}
+
+	FoundActors.Empty();
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AWorldMapManager::StaticClass(), FoundActors);
+	if (FoundActors.Num() > 0)
+	{
+		WorldMapManager = Cast<AWorldMapManager>(FoundActors[0]);
+	}
+
+	if (!WorldMapManager)
+	{
+		return;
+	}
+
+	const int32 NumTerritories = WorldMapManager->GetNumTerritories();
+	HubMarkets.SetNumZeroed(NumTerritories);
+	VisitStamp.SetNumZeroed(NumTerritories);
+	Parent.SetNum(NumTerritories);
+	Depth.SetNum(NumTerritories);
+
+	// The map was built before we existed, so seed the first turn with every hub
+	for (int32 Index = 0; Index < NumTerritories; ++Index)
+	{
+		RefreshHub(Index);
+		if (HubMarkets[Index] > 0)
+		{
+			PendingHubs.Add(Index);
+		}
+	}
+}
+
+void ATradeNetworkManager::MarkTerritoryDirty(ATerritoryRegion* Territory)
+{
+	if (Territory && HubMarkets.IsValidIndex(Territory->GetMapIndex()))
+	{
+		DirtyTerritories.Add(Territory->GetMapIndex());
+	}
+}
+
+void ATradeNetworkManager::MarkTerritoryRevalued(ATerritoryRegion* Territory)
+{
+	if (Territory && HubMarkets.IsValidIndex(Territory->GetMapIndex()))
+	{
+		RevaluedTerritories.Add(Territory->GetMapIndex());
+	}
+}
+
+void ATradeNetworkManager::ProcessTradeNetwork()
+{
+	SCOPE_CYCLE_COUNTER(STAT_TradeNetwork);
+
+	if (!WorldMapManager)
+	{
+		return;
+	}
+
+	// Drop every route that crosses or ends at a changed territory and queue its ends for a new search
+	for (int32 TerritoryIndex : DirtyTerritories)
+	{
+		TArray<uint64> AffectedRoutes;
+		RoutesByTerritory.MultiFind(TerritoryIndex, AffectedRoutes);
+
+		for (uint64 Key : AffectedRoutes)
+		{
+			if (const FTradeRoute* Route = Routes.Find(Key))
+			{
+				PendingHubs.Add(Route->HubA);
+				PendingHubs.Add(Route->HubB);
+				RemoveRoute(Key);
+			}
+		}
+
+		RefreshHub(TerritoryIndex);
+
+		// A new hub or a newly passable territory can open routes between hubs that had none
+		QueueNearbyHubs(TerritoryIndex);
+	}
+	DirtyTerritories.Reset();
+
+	// Population only changes what a route is worth, not where it runs
+	for (int32 TerritoryIndex : RevaluedTerritories)
+	{
+		RevalueRoutesAt(TerritoryIndex);
+	}
+	RevaluedTerritories.Reset();
+
+	// Search a bounded number of hubs this turn; the rest stay queued
+	TArray<int32> HubsToSearch;
+	for (int32 HubIndex : PendingHubs)
+	{
+		if (HubsToSearch.Num() >= MaxHubSearchesPerTurn)
+		{
+			break;
+		}
+		HubsToSearch.Add(HubIndex);
+	}
+
+	for (int32 HubIndex : HubsToSearch)
+	{
+		PendingHubs.Remove(HubIndex);
+		SearchRoutesFrom(HubIndex);
+	}
+
+	if (FactionManager)
+	{
+		for (EFactionID FactionID : ChangedFactions)
+		{
+			FFactionResources Income = FFactionResources::MakeEmpty();
+			Income.Gold = GetFactionTradeIncome(FactionID);
+			FactionManager->SetTradeIncome(FactionID, Income);
+		}
+	}
+	ChangedFactions.Reset();
+
+	UE_LOG(LogRomanEmpire, Verbose, TEXT("Trade network: %d routes, %d hubs still queued"), Routes.Num(), PendingHubs.Num());
+}
+
+int32 ATradeNetworkManager::GetFactionTradeIncome(EFactionID FactionID) const
+{
+	const int32* Income = FactionTradeIncome.Find(FactionID);
+	return Income ? *Income : 0;
+}
+
+uint64 ATradeNetworkManager::MakeRouteKey(int32 HubA, int32 HubB)
+{
+	const uint32 Low = static_cast<uint32>(FMath::Min(HubA, HubB));
+	const uint32 High = static_cast<uint32>(FMath::Max(HubA, HubB));
+	return (static_cast<uint64>(High) << 32) | Low;
+}
+
+void ATradeNetworkManager::RefreshHub(int32 TerritoryIndex)
+{
+	ATerritoryRegion* Territory = WorldMapManager->GetTerritoryByIndex(TerritoryIndex);
+	int32 Markets = 0;
+
+	if (Territory && Territory->HasSettlement() && Territory->GetOwnerFaction() != EFactionID::None)
+	{
+		for (const ABuildingBase* Building : Territory->GetBuildings())
+		{
+			if (Building && Building->GetBuildingType() == EBuildingType::Market &&
+				(Building->GetBuildingState() == EBuildingState::Complete || Building->GetBuildingState() == EBuildingState::Damaged))
+			{
+				++Markets;
+			}
+		}
+	}
+
+	HubMarkets[TerritoryIndex] = static_cast<uint8>(FMath::Min(Markets, 255));
+}
+
+void ATradeNetworkManager::BeginSearch()
+{
+	// Bumping the stamp clears the visited set without touching every territory
+	++CurrentStamp;
+}
+
+void ATradeNetworkManager::QueueNearbyHubs(int32 TerritoryIndex)
+{
+	BeginSearch();
+
+	TArray<int32> Frontier;
+	Frontier.Add(TerritoryIndex);
+	VisitStamp[TerritoryIndex] = CurrentStamp;
+	Depth[TerritoryIndex] = 0;
+
+	for (int32 Cursor = 0; Cursor < Frontier.Num(); ++Cursor)
+	{
+		const int32 Current = Frontier[Cursor];
+		if (HubMarkets[Current] > 0)
+		{
+			PendingHubs.Add(Current);
+		}
+
+		if (Depth[Current] >= MaxRouteHops)
+		{
+			continue;
+		}
+
+		for (int32 Neighbour : WorldMapManager->GetAdjacentIndices(Current))
+		{
+			if (VisitStamp[Neighbour] != CurrentStamp)
+			{
+				VisitStamp[Neighbour] = CurrentStamp;
+				Depth[Neighbour] = Depth[Current] + 1;
+				Frontier.Add(Neighbour);
+			}
+		}
+	}
+}
+
+bool ATradeNetworkManager::IsPassable(int32 TerritoryIndex, EFactionID Owner) const
+{
+	// Caravans cross their own and unclaimed land, never another faction's
+	const ATerritoryRegion* Territory = WorldMapManager->GetTerritoryByIndex(TerritoryIndex);
+	if (!Territory)
+	{
+		return false;
+	}
+
+	const EFactionID TerritoryOwner = Territory->GetOwnerFaction();
+	return TerritoryOwner == Owner || TerritoryOwner == EFactionID::None;
+}
+
+void ATradeNetworkManager::SearchRoutesFrom(int32 HubIndex)
+{
+	if (HubMarkets[HubIndex] == 0)
+	{
+		return;
+	}
+
+	const EFactionID Owner = WorldMapManager->GetTerritoryByIndex(HubIndex)->GetOwnerFaction();
+
+	BeginSearch();
+
+	TArray<int32> Frontier;
+	Frontier.Add(HubIndex);
+	VisitStamp[HubIndex] = CurrentStamp;
+	Parent[HubIndex] = INDEX_NONE;
+	Depth[HubIndex] = 0;
+
+	for (int32 Cursor = 0; Cursor < Frontier.Num(); ++Cursor)
+	{
+		const int32 Current = Frontier[Cursor];
+
+		// Breadth-first order means the first time we reach a hub is along a shortest path
+		if (Current != HubIndex && HubMarkets[Current] > 0 &&
+			WorldMapManager->GetTerritoryByIndex(Current)->GetOwnerFaction() == Owner &&
+			!Routes.Contains(MakeRouteKey(HubIndex, Current)))
+		{
+			TArray<int32> Path;
+			for (int32 Step = Current; Step != INDEX_NONE; Step = Parent[Step])
+			{
+				Path.Add(Step);
+			}
+			AddRoute(HubIndex, Current, Owner, MoveTemp(Path));
+		}
+
+		if (Depth[Current] >= MaxRouteHops)
+		{
+			continue;
+		}
+
+		for (int32 Neighbour : WorldMapManager->GetAdjacentIndices(Current))
+		{
+			if (VisitStamp[Neighbour] != CurrentStamp && IsPassable(Neighbour, Owner))
+			{
+				VisitStamp[Neighbour] = CurrentStamp;
+				Parent[Neighbour] = Current;
+				Depth[Neighbour] = Depth[Current] + 1;
+				Frontier.Add(Neighbour);
+			}
+		}
+	}
+}
+
+int32 ATradeNetworkManager::CalculateRouteValue(int32 HubA, int32 HubB, int32 Hops) const
+{
+	const ATerritoryRegion* TerritoryA = WorldMapManager->GetTerritoryByIndex(HubA);
+	const ATerritoryRegion* TerritoryB = WorldMapManager->GetTerritoryByIndex(HubB);
+
+	float Value = GoldPerHundredCitizens * (TerritoryA->GetPopulation() + TerritoryB->GetPopulation()) / 100.0f;
+
+	// Extra markets at either end draw more trade
+	Value *= 0.5f * (HubMarkets[HubA] + HubMarkets[HubB]);
+
+	if (TerritoryA->GetTerrainType() == ETerrainType::Coast)
+	{
+		Value *= PortBonus;
+	}
+	if (TerritoryB->GetTerrainType() == ETerrainType::Coast)
+	{
+		Value *= PortBonus;
+	}
+
+	return FMath::Max(0, FMath::RoundToInt(Value / (1.0f + HopPenalty * Hops)));
+}
+
+void ATradeNetworkManager::AddRoute(int32 HubA, int32 HubB, EFactionID Owner, TArray<int32>&& Path)
+{
+	const uint64 Key = MakeRouteKey(HubA, HubB);
+
+	FTradeRoute& Route = Routes.Add(Key);
+	Route.HubA = HubA;
+	Route.HubB = HubB;
+	Route.Owner = Owner;
+	Route.Value = CalculateRouteValue(HubA, HubB, Path.Num() - 1);
+	Route.Path = MoveTemp(Path);
+
+	for (int32 TerritoryIndex : Route.Path)
+	{
+		RoutesByTerritory.Add(TerritoryIndex, Key);
+	}
+
+	FactionTradeIncome.FindOrAdd(Owner) += Route.Value;
+	ChangedFactions.Add(Owner);
+}
+
+void ATradeNetworkManager::RemoveRoute(uint64 Key)
+{
+	FTradeRoute Route;
+	if (!Routes.RemoveAndCopyValue(Key, Route))
+	{
+		return;
+	}
+
+	for (int32 TerritoryIndex : Route.Path)
+	{
+		RoutesByTerritory.RemoveSingle(TerritoryIndex, Key);
+	}
+
+	FactionTradeIncome.FindOrAdd(Route.Owner) -= Route.Value;
+	ChangedFactions.Add(Route.Owner);
+}
+
+void ATradeNetworkManager::RevalueRoutesAt(int32 HubIndex)
+{
+	TArray<uint64> TouchingRoutes;
+	RoutesByTerritory.MultiFind(HubIndex, TouchingRoutes);
+
+	for (uint64 Key : TouchingRoutes)
+	{
+		FTradeRoute* Route = Routes.Find(Key);
+		if (!Route || (Route->HubA != HubIndex && Route->HubB != HubIndex))
+		{
+			continue;
+		}
+
+		const int32 NewValue = CalculateRouteValue(Route->HubA, Route->HubB, Route->Path.Num() - 1);
+		if (NewValue != Route->Value)
+		{
+			FactionTradeIncome.FindOrAdd(Route->Owner) += NewValue - Route->Value;
+			Route->Value = NewValue;
+			ChangedFactions.Add(Route->Owner);
+		}
+	}
+}
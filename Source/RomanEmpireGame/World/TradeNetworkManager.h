@@ -0,0 +1,113 @@
+// Copyright Roman Empire Game. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RomanEmpireGame/Faction/FactionData.h"
+#include "TradeNetworkManager.generated.h"
+
+class ATerritoryRegion;
+class AWorldMapManager;
+class AFactionManager;
+
+/**
+ * Maintains trade routes between a faction's market settlements over the territory graph.
+ * Routes are cached and only those touching changed territories are rebuilt each turn.
+ */
+UCLASS()
+class ROMANEMPIREGAME_API ATradeNetworkManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATradeNetworkManager();
+
+	virtual void BeginPlay() override;
+
+	// Flags a territory whose owner or buildings changed; its routes are rebuilt next turn
+	UFUNCTION(BlueprintCallable, Category = "Trade")
+	void MarkTerritoryDirty(ATerritoryRegion* Territory);
+
+	// Flags a hub whose population changed; its routes keep their paths and are only revalued next turn
+	void MarkTerritoryRevalued(ATerritoryRegion* Territory);
+
+	// Rebuilds routes around dirty territories and pushes trade income to the faction manager
+	UFUNCTION(BlueprintCallable, Category = "Trade")
+	void ProcessTradeNetwork();
+
+	UFUNCTION(BlueprintPure, Category = "Trade")
+	int32 GetFactionTradeIncome(EFactionID FactionID) const;
+
+	UFUNCTION(BlueprintPure, Category = "Trade")
+	int32 GetRouteCount() const { return Routes.Num(); }
+
+protected:
+	// Longest route, in territories crossed
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Trade")
+	int32 MaxRouteHops;
+
+	// Gold per turn for every hundred citizens living at the two ends of a route
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Trade")
+	float GoldPerHundredCitizens;
+
+	// Value lost per territory crossed
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Trade")
+	float HopPenalty;
+
+	// Multiplier for each coastal end of a route
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Trade")
+	float PortBonus;
+
+	// Hub searches run per turn; the remainder carries over to the next turn
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Trade")
+	int32 MaxHubSearchesPerTurn;
+
+	UPROPERTY()
+	AWorldMapManager* WorldMapManager;
+
+	UPROPERTY()
+	AFactionManager* FactionManager;
+
+private:
+	struct FTradeRoute
+	{
+		int32 HubA;
+		int32 HubB;
+		EFactionID Owner;
+		int32 Value;
+		TArray<int32> Path;
+	};
+
+	TMap<uint64, FTradeRoute> Routes;
+
+	// Every territory a route crosses, endpoints included, so a change finds its routes directly
+	TMultiMap<int32, uint64> RoutesByTerritory;
+
+	// Number of completed markets per territory index; zero means not a trade hub
+	TArray<uint8> HubMarkets;
+
+	TSet<int32> DirtyTerritories;
+	TSet<int32> RevaluedTerritories;
+	TSet<int32> PendingHubs;
+	TMap<EFactionID, int32> FactionTradeIncome;
+	TSet<EFactionID> ChangedFactions;
+
+	// Breadth-first search scratch, reused between searches
+	TArray<int32> VisitStamp;
+	TArray<int32> Parent;
+	TArray<int32> Depth;
+	int32 CurrentStamp;
+
+	static uint64 MakeRouteKey(int32 HubA, int32 HubB);
+
+	void RefreshHub(int32 TerritoryIndex);
+	void QueueNearbyHubs(int32 TerritoryIndex);
+	void SearchRoutesFrom(int32 HubIndex);
+	void AddRoute(int32 HubA, int32 HubB, EFactionID Owner, TArray<int32>&& Path);
+	void RemoveRoute(uint64 Key);
+	void RevalueRoutesAt(int32 HubIndex);
+	int32 CalculateRouteValue(int32 HubA, int32 HubB, int32 Hops) const;
+	bool IsPassable(int32 TerritoryIndex, EFactionID Owner) const;
+	void BeginSearch();
+};
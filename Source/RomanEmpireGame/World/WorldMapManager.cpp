@@ -3,6 +3,8 @@
 #include "WorldMapManager.h"
 #include "RomanEmpireGame/RomanEmpireGame.h"
 #include "RomanEmpireGame/World/TerritoryRegion.h"
+#include "RomanEmpireGame/Core/RomanEmpireGameMode.h"
+#include "RomanEmpireGame/Faction/FactionManager.h"
 #include "Kismet/GameplayStatics.h"
 
 AWorldMapManager::AWorldMapManager()
@@ -28,15 +30,49 @@ void AWorldMapManager::BeginPlay()
 	}
 	else
 	{
+		TSet<FName> UsedIDs;
 		for (AActor* Actor : FoundTerritories)
 		{
 			if (ATerritoryRegion* Territory = Cast<ATerritoryRegion>(Actor))
 			{
+				// Ownership is tracked by ID, so placed territories must have unique ones
+				FName TerritoryID = Territory->GetTerritoryID();
+				if (TerritoryID.IsNone() || UsedIDs.Contains(TerritoryID))
+				{
+					TerritoryID = Territory->GetFName();
+					UE_LOG(LogRomanEmpire, Warning, TEXT("Territory %s has a missing or duplicate ID; using %s"),
+						*Territory->GetTerritoryID().ToString(), *TerritoryID.ToString());
+					Territory->InitializeTerritory(TerritoryID, Territory->GetDisplayName());
+				}
+				UsedIDs.Add(TerritoryID);
+
 				Territories.Add(Territory);
 			}
 		}
 	}
 	
+	BuildAdjacency();
+
+	// Seed the income ledger; placed territories never announced their production.
+	// Refreshing is idempotent, so generated territories counted on creation are unaffected.
+	ARomanEmpireGameMode* GameMode = Cast<ARomanEmpireGameMode>(UGameplayStatics::GetGameMode(this));
+	if (AFactionManager* FactionManager = GameMode ? GameMode->GetFactionManager() : nullptr)
+	{
+		for (ATerritoryRegion* Territory : Territories)
+		{
+			FactionManager->RefreshTerritoryContribution(Territory);
+		}
+	}
+
+	// Settlements founded during map generation ran before the game mode knew about us
+	for (ATerritoryRegion* Territory : Territories)
+	{
+		if (Territory && Territory->HasSettlement())
+		{
+			RefreshSettlement(Territory);
+		}
+	}
+	
 	UE_LOG(LogRomanEmpire, Log, TEXT("World Map Manager initialized with %d territories"), Territories.Num());
 }
 
@@ -135,8 +171,8 @@ void AWorldMapManager::CreateTerritory(FName ID, const FText& Name, const FVecto
 
 	if (NewTerritory)
 	{
-		// Can't set directly as UPROPERTY is EditAnywhere, not code-settable
-		// In a real implementation, add setter functions
+		// ID must be set before ownership so the production ledger keys it correctly
+		NewTerritory->InitializeTerritory(ID, Name);
 		NewTerritory->SetOwnerFaction(StartingOwner);
 		Territories.Add(NewTerritory);
 	}
@@ -185,17 +221,76 @@ TArray<ATerritoryRegion*> AWorldMapManager::GetAdjacentTerritories(ATerritoryReg
 		return Adjacent;
 	}
 
-	FVector Location = Territory->GetActorLocation();
+	for (int32 NeighbourIndex : GetAdjacentIndices(Territory->GetMapIndex()))
+	{
+		Adjacent.Add(Territories[NeighbourIndex]);
+	}
 	
-	for (ATerritoryRegion* Other : Territories)
+	return Adjacent;
+}
+
+const TArray<int32>& AWorldMapManager::GetAdjacentIndices(int32 Index) const
+{
+	static const TArray<int32> NoNeighbours;
+	return Adjacency.IsValidIndex(Index) ? Adjacency[Index] : NoNeighbours;
+}
+
+void AWorldMapManager::BuildAdjacency()
+{
+	// Bucket territories into cells the size of the adjacency range so each
+	// territory only tests the 3x3 cells around it instead of the whole map
+	const float Range = TerritorySize * 1.5f;
+	const float RangeSquared = Range * Range;
+
+	TMap<FIntPoint, TArray<int32>> Buckets;
+	TArray<FIntPoint> Cells;
+	Cells.SetNum(Territories.Num());
+
+	for (int32 Index = 0; Index < Territories.Num(); ++Index)
 	{
-		if (Other && Other != Territory && AreTerritoriesAdjacent(Territory, Other))
+		if (!Territories[Index])
 		{
-			Adjacent.Add(Other);
+			continue;
+		}
+
+		const FVector Location = Territories[Index]->GetActorLocation();
+		Cells[Index] = FIntPoint(FMath::FloorToInt(Location.X / Range), FMath::FloorToInt(Location.Y / Range));
+		Buckets.FindOrAdd(Cells[Index]).Add(Index);
+		Territories[Index]->SetMapIndex(Index);
+	}
+
+	Adjacency.Reset();
+	Adjacency.SetNum(Territories.Num());
+
+	for (int32 Index = 0; Index < Territories.Num(); ++Index)
+	{
+		if (!Territories[Index])
+		{
+			continue;
+		}
+
+		const FVector Location = Territories[Index]->GetActorLocation();
+
+		for (int32 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+		{
+			for (int32 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+			{
+				const TArray<int32>* Bucket = Buckets.Find(Cells[Index] + FIntPoint(OffsetX, OffsetY));
+				if (!Bucket)
+				{
+					continue;
+				}
+
+				for (int32 Other : *Bucket)
+				{
+					if (Other != Index && FVector::DistSquared(Location, Territories[Other]->GetActorLocation()) <= RangeSquared)
+					{
+						Adjacency[Index].Add(Other);
+					}
+				}
+			}
 		}
 	}
-	
-	return Adjacent;
 }
 
 bool AWorldMapManager::AreTerritoriesAdjacent(ATerritoryRegion* Territory1, ATerritoryRegion* Territory2) const
@@ -210,3 +305,23 @@ bool AWorldMapManager::AreTerritoriesAdjacent(ATerritoryRegion* Territory1, ATer
 	// Adjacent if within 1.5 territory sizes (allows for diagonal)
 	return Distance <= TerritorySize * 1.5f;
 }
+
+void AWorldMapManager::RefreshSettlement(ATerritoryRegion* Territory)
+{
+	if (!Territory || !Territory->HasSettlement())
+	{
+		return;
+	}
+
+	if (Territory->GetSettlementRow() == INDEX_NONE)
+	{
+		Territory->SetSettlementRow(SettlementTable.AddSettlement(Territory));
+	}
+
+	SettlementTable.UpdateModifiers(Territory->GetSettlementRow(), SettlementGrowthSettings);
+}
+
+void AWorldMapManager::ProcessSettlementGrowth()
+{
+	SettlementTable.Simulate(SettlementGrowthSettings);
+}
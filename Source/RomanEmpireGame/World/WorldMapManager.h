@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "RomanEmpireGame/World/SettlementGrowth.h"
 #include "WorldMapManager.generated.h"
 
 class ATerritoryRegion;
@@ -42,6 +43,18 @@ public:
 	UFUNCTION(BlueprintPure, Category = "World")
 	bool AreTerritoriesAdjacent(ATerritoryRegion* Territory1, ATerritoryRegion* Territory2) const;
 
+	// Index-based access for graph searches (trade, army movement)
+	int32 GetNumTerritories() const { return Territories.Num(); }
+	ATerritoryRegion* GetTerritoryByIndex(int32 Index) const { return Territories.IsValidIndex(Index) ? Territories[Index] : nullptr; }
+	const TArray<int32>& GetAdjacentIndices(int32 Index) const;
+
+	// Settlements
+	UFUNCTION(BlueprintCallable, Category = "World|Settlement")
+	void RefreshSettlement(ATerritoryRegion* Territory);
+
+	UFUNCTION(BlueprintCallable, Category = "World|Settlement")
+	void ProcessSettlementGrowth();
+
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "World")
 	TArray<ATerritoryRegion*> Territories;
@@ -56,6 +69,16 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "World|Size")
 	float TerritorySize;
 
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "World|Settlement")
+	FSettlementGrowthSettings SettlementGrowthSettings;
+
 private:
+	FSettlementTable SettlementTable;
+
+	// Neighbour indices per territory, built once after the map is loaded
+	TArray<TArray<int32>> Adjacency;
+
+	void BuildAdjacency();
+
 	void CreateTerritory(FName ID, const FText& Name, const FVector& Location, EFactionID StartingOwner);
 };